@@ -53,6 +53,7 @@ int main(
   write_atm(argv[4], &ctl, atm, 0);
 
   /* Free... */
+  free_atm(atm);
   free(atm);
 
   return EXIT_SUCCESS;
@@ -30,61 +30,26 @@ int main(
 
   ctl_t ctl;
 
-  atm_t *atm1, *atm2;
+  atm_t *atm[2];
 
   FILE *out;
 
-  char tstr[LEN];
-
-  double *ahtd, *aqtd, *avtd, ahtdm, aqtdm[NQ], avtdm, lat0, lat1,
-    *lat1_old, *lat2_old, *lh1, *lh2, lon0, lon1, *lon1_old, *lon2_old,
-    *lv1, *lv2, p0, p1, *rhtd, *rqtd, *rvtd, rhtdm, rqtdm[NQ], rvtdm,
-    t, t0 = 0, x0[3], x1[3], x2[3], z1, *z1_old, z2, *z2_old, *work;
-
-  int ens, f, init = 0, ip, iq, np, year, mon, day, hour, min;
-
-  /* Allocate... */
-  ALLOC(atm1, atm_t, 1);
-  ALLOC(atm2, atm_t, 1);
-  ALLOC(lon1_old, double,
-	NP);
-  ALLOC(lat1_old, double,
-	NP);
-  ALLOC(z1_old, double,
-	NP);
-  ALLOC(lh1, double,
-	NP);
-  ALLOC(lv1, double,
-	NP);
-  ALLOC(lon2_old, double,
-	NP);
-  ALLOC(lat2_old, double,
-	NP);
-  ALLOC(z2_old, double,
-	NP);
-  ALLOC(lh2, double,
-	NP);
-  ALLOC(lv2, double,
-	NP);
-  ALLOC(ahtd, double,
-	NP);
-  ALLOC(avtd, double,
-	NP);
-  ALLOC(aqtd, double,
-	NP * NQ);
-  ALLOC(rhtd, double,
-	NP);
-  ALLOC(rvtd, double,
-	NP);
-  ALLOC(rqtd, double,
-	NP * NQ);
-  ALLOC(work, double,
-	NP);
+  char tstr[LEN], **files;
+
+  double *ahtd = NULL, *aqtd = NULL, *avtd = NULL, ahtdm, aqtdm[NQ], avtdm,
+    lat0, lat1, *lat1_old = NULL, *lat2_old = NULL, *lh1 = NULL, *lh2 = NULL,
+    lon0, lon1, *lon1_old = NULL, *lon2_old = NULL, *lv1 = NULL, *lv2 = NULL,
+    p0, p1, *rhtd = NULL, *rqtd = NULL, *rvtd = NULL, rhtdm, rqtdm[NQ], rvtdm,
+    t, t0 = 0, *z1_old = NULL, *z2_old = NULL, *work = NULL;
+
+  int ens, ifile, init = 0, ip, iq, np, npmax = 0, *sel = NULL, year, mon,
+    day, hour, min;
 
   /* Check arguments... */
   if (argc < 6)
     ERRMSG("Give parameters: <ctl> <dist.tab> <param> <atm1a> <atm1b>"
 	   " [<atm2a> <atm2b> ...]");
+  files = &argv[4];
 
   /* Read control parameters... */
   read_ctl(argv[1], argc, argv, &ctl);
@@ -120,27 +85,49 @@ int main(
 	    8 + 2 * iq, ctl.qnt_name[iq], argv[3]);
   fprintf(out, "# $%d = number of particles\n\n", 7 + 2 * ctl.nq);
 
-  /* Loop over file pairs... */
-  for (f = 4; f < argc; f += 2) {
-
-    /* Read atmopheric data... */
-    if (!read_atm(argv[f], &ctl, atm1) || !read_atm(argv[f + 1], &ctl, atm2))
-      continue;
+  /* Loop over file pairs (next pair is read in the background)... */
+  for (ifile = -1; read_atm_list(&ctl, argc - 4, files, 2, &ifile, atm);) {
 
     /* Check if structs match... */
-    if (atm1->np != atm2->np)
+    if (atm[0]->np != atm[1]->np)
       ERRMSG("Different numbers of particles!");
 
+    /* Allocate... */
+    if (atm[0]->np > npmax) {
+      REALLOC(lon1_old, double, atm[0]->np);
+      REALLOC(lat1_old, double, atm[0]->np);
+      REALLOC(z1_old, double, atm[0]->np);
+      REALLOC(lh1, double, atm[0]->np);
+      REALLOC(lv1, double, atm[0]->np);
+      REALLOC(lon2_old, double, atm[0]->np);
+      REALLOC(lat2_old, double, atm[0]->np);
+      REALLOC(z2_old, double, atm[0]->np);
+      REALLOC(lh2, double, atm[0]->np);
+      REALLOC(lv2, double, atm[0]->np);
+      REALLOC(ahtd, double, atm[0]->np);
+      REALLOC(avtd, double, atm[0]->np);
+      REALLOC(aqtd, double, NQ * atm[0]->np);
+      REALLOC(rhtd, double, atm[0]->np);
+      REALLOC(rvtd, double, atm[0]->np);
+      REALLOC(rqtd, double, NQ * atm[0]->np);
+      REALLOC(work, double, atm[0]->np);
+      REALLOC(sel, int, atm[0]->np);
+      for (ip = npmax; ip < atm[0]->np; ip++)
+	lon1_old[ip] = lat1_old[ip] = z1_old[ip] = lh1[ip] = lv1[ip]
+	  = lon2_old[ip] = lat2_old[ip] = z2_old[ip] = lh2[ip] = lv2[ip] = 0;
+      npmax = atm[0]->np;
+    }
+
     /* Get time from filename... */
-    sprintf(tstr, "%.4s", &argv[f][strlen(argv[f]) - 20]);
+    sprintf(tstr, "%.4s", &files[ifile][strlen(files[ifile]) - 20]);
     year = atoi(tstr);
-    sprintf(tstr, "%.2s", &argv[f][strlen(argv[f]) - 15]);
+    sprintf(tstr, "%.2s", &files[ifile][strlen(files[ifile]) - 15]);
     mon = atoi(tstr);
-    sprintf(tstr, "%.2s", &argv[f][strlen(argv[f]) - 12]);
+    sprintf(tstr, "%.2s", &files[ifile][strlen(files[ifile]) - 12]);
     day = atoi(tstr);
-    sprintf(tstr, "%.2s", &argv[f][strlen(argv[f]) - 9]);
+    sprintf(tstr, "%.2s", &files[ifile][strlen(files[ifile]) - 9]);
     hour = atoi(tstr);
-    sprintf(tstr, "%.2s", &argv[f][strlen(argv[f]) - 6]);
+    sprintf(tstr, "%.2s", &files[ifile][strlen(files[ifile]) - 6]);
     min = atoi(tstr);
     time2jsec(year, mon, day, hour, min, 0, 0, &t);
 
@@ -150,51 +137,52 @@ int main(
       t0 = t;
     }
 
-    /* Init... */
-    np = 0;
-    for (ip = 0; ip < atm1->np; ip++) {
+    /* Loop over air parcels... */
+#pragma omp parallel for default(shared) private(iq)
+    for (ip = 0; ip < atm[0]->np; ip++) {
+
+      double x0[3], x1[3], x2[3], z1, z2;
+
+      /* Init... */
+      sel[ip] = 0;
       ahtd[ip] = avtd[ip] = rhtd[ip] = rvtd[ip] = 0;
       for (iq = 0; iq < ctl.nq; iq++)
-	aqtd[iq * NP + ip] = rqtd[iq * NP + ip] = 0;
-    }
-
-    /* Loop over air parcels... */
-    for (ip = 0; ip < atm1->np; ip++) {
+	aqtd[iq * npmax + ip] = rqtd[iq * npmax + ip] = 0;
 
       /* Check data... */
-      if (!gsl_finite(atm1->time[ip]) || !gsl_finite(atm2->time[ip]))
+      if (!gsl_finite(atm[0]->time[ip]) || !gsl_finite(atm[1]->time[ip]))
 	continue;
 
       /* Check ensemble index... */
       if (ctl.qnt_ens > 0
-	  && (atm1->q[ctl.qnt_ens][ip] != ens
-	      || atm2->q[ctl.qnt_ens][ip] != ens))
+	  && (atm[0]->q[ctl.qnt_ens][ip] != ens
+	      || atm[1]->q[ctl.qnt_ens][ip] != ens))
 	continue;
 
       /* Check spatial range... */
-      if (atm1->p[ip] > p0 || atm1->p[ip] < p1
-	  || atm1->lon[ip] < lon0 || atm1->lon[ip] > lon1
-	  || atm1->lat[ip] < lat0 || atm1->lat[ip] > lat1)
+      if (atm[0]->p[ip] > p0 || atm[0]->p[ip] < p1
+	  || atm[0]->lon[ip] < lon0 || atm[0]->lon[ip] > lon1
+	  || atm[0]->lat[ip] < lat0 || atm[0]->lat[ip] > lat1)
 	continue;
-      if (atm2->p[ip] > p0 || atm2->p[ip] < p1
-	  || atm2->lon[ip] < lon0 || atm2->lon[ip] > lon1
-	  || atm2->lat[ip] < lat0 || atm2->lat[ip] > lat1)
+      if (atm[1]->p[ip] > p0 || atm[1]->p[ip] < p1
+	  || atm[1]->lon[ip] < lon0 || atm[1]->lon[ip] > lon1
+	  || atm[1]->lat[ip] < lat0 || atm[1]->lat[ip] > lat1)
 	continue;
 
       /* Convert coordinates... */
-      geo2cart(0, atm1->lon[ip], atm1->lat[ip], x1);
-      geo2cart(0, atm2->lon[ip], atm2->lat[ip], x2);
-      z1 = Z(atm1->p[ip]);
-      z2 = Z(atm2->p[ip]);
+      geo2cart(0, atm[0]->lon[ip], atm[0]->lat[ip], x1);
+      geo2cart(0, atm[1]->lon[ip], atm[1]->lat[ip], x2);
+      z1 = Z(atm[0]->p[ip]);
+      z2 = Z(atm[1]->p[ip]);
 
       /* Calculate absolute transport deviations... */
-      ahtd[np] = DIST(x1, x2);
-      avtd[np] = z1 - z2;
+      ahtd[ip] = DIST(x1, x2);
+      avtd[ip] = z1 - z2;
       for (iq = 0; iq < ctl.nq; iq++)
-	aqtd[iq * NP + np] = atm1->q[iq][ip] - atm2->q[iq][ip];
+	aqtd[iq * npmax + ip] = atm[0]->q[iq][ip] - atm[1]->q[iq][ip];
 
       /* Calculate relative transport deviations... */
-      if (f > 4) {
+      if (ifile > 0) {
 
 	/* Get trajectory lengths... */
 	geo2cart(0, lon1_old[ip], lat1_old[ip], x0);
@@ -207,113 +195,53 @@ int main(
 
 	/* Get relative transport deviations... */
 	if (lh1[ip] + lh2[ip] > 0)
-	  rhtd[np] = 200. * DIST(x1, x2) / (lh1[ip] + lh2[ip]);
+	  rhtd[ip] = 200. * DIST(x1, x2) / (lh1[ip] + lh2[ip]);
 	if (lv1[ip] + lv2[ip] > 0)
-	  rvtd[np] = 200. * (z1 - z2) / (lv1[ip] + lv2[ip]);
+	  rvtd[ip] = 200. * (z1 - z2) / (lv1[ip] + lv2[ip]);
       }
 
       /* Get relative transport deviations... */
       for (iq = 0; iq < ctl.nq; iq++)
-	rqtd[iq * NP + np] = 200. * (atm1->q[iq][ip] - atm2->q[iq][ip])
-	  / (fabs(atm1->q[iq][ip]) + fabs(atm2->q[iq][ip]));
+	rqtd[iq * npmax + ip] = 200. * (atm[0]->q[iq][ip] - atm[1]->q[iq][ip])
+	  / (fabs(atm[0]->q[iq][ip]) + fabs(atm[1]->q[iq][ip]));
 
       /* Save positions of air parcels... */
-      lon1_old[ip] = atm1->lon[ip];
-      lat1_old[ip] = atm1->lat[ip];
+      lon1_old[ip] = atm[0]->lon[ip];
+      lat1_old[ip] = atm[0]->lat[ip];
       z1_old[ip] = z1;
 
-      lon2_old[ip] = atm2->lon[ip];
-      lat2_old[ip] = atm2->lat[ip];
+      lon2_old[ip] = atm[1]->lon[ip];
+      lat2_old[ip] = atm[1]->lat[ip];
       z2_old[ip] = z2;
 
-      /* Increment air parcel counter... */
-      np++;
+      /* Mark air parcel as selected... */
+      sel[ip] = 1;
     }
 
-    /* Get statistics... */
-    if (strcasecmp(argv[3], "mean") == 0) {
-      ahtdm = gsl_stats_mean(ahtd, 1, (size_t) np);
-      rhtdm = gsl_stats_mean(rhtd, 1, (size_t) np);
-      avtdm = gsl_stats_mean(avtd, 1, (size_t) np);
-      rvtdm = gsl_stats_mean(rvtd, 1, (size_t) np);
-      for (iq = 0; iq < ctl.nq; iq++) {
-	aqtdm[iq] = gsl_stats_mean(&aqtd[iq * NP], 1, (size_t) np);
-	rqtdm[iq] = gsl_stats_mean(&rqtd[iq * NP], 1, (size_t) np);
-      }
-    } else if (strcasecmp(argv[3], "stddev") == 0) {
-      ahtdm = gsl_stats_sd(ahtd, 1, (size_t) np);
-      rhtdm = gsl_stats_sd(rhtd, 1, (size_t) np);
-      avtdm = gsl_stats_sd(avtd, 1, (size_t) np);
-      rvtdm = gsl_stats_sd(rvtd, 1, (size_t) np);
-      for (iq = 0; iq < ctl.nq; iq++) {
-	aqtdm[iq] = gsl_stats_sd(&aqtd[iq * NP], 1, (size_t) np);
-	rqtdm[iq] = gsl_stats_sd(&rqtd[iq * NP], 1, (size_t) np);
-      }
-    } else if (strcasecmp(argv[3], "min") == 0) {
-      ahtdm = gsl_stats_min(ahtd, 1, (size_t) np);
-      rhtdm = gsl_stats_min(rhtd, 1, (size_t) np);
-      avtdm = gsl_stats_min(avtd, 1, (size_t) np);
-      rvtdm = gsl_stats_min(rvtd, 1, (size_t) np);
-      for (iq = 0; iq < ctl.nq; iq++) {
-	aqtdm[iq] = gsl_stats_min(&aqtd[iq * NP], 1, (size_t) np);
-	rqtdm[iq] = gsl_stats_min(&rqtd[iq * NP], 1, (size_t) np);
-      }
-    } else if (strcasecmp(argv[3], "max") == 0) {
-      ahtdm = gsl_stats_max(ahtd, 1, (size_t) np);
-      rhtdm = gsl_stats_max(rhtd, 1, (size_t) np);
-      avtdm = gsl_stats_max(avtd, 1, (size_t) np);
-      rvtdm = gsl_stats_max(rvtd, 1, (size_t) np);
-      for (iq = 0; iq < ctl.nq; iq++) {
-	aqtdm[iq] = gsl_stats_max(&aqtd[iq * NP], 1, (size_t) np);
-	rqtdm[iq] = gsl_stats_max(&rqtd[iq * NP], 1, (size_t) np);
-      }
-    } else if (strcasecmp(argv[3], "skew") == 0) {
-      ahtdm = gsl_stats_skew(ahtd, 1, (size_t) np);
-      rhtdm = gsl_stats_skew(rhtd, 1, (size_t) np);
-      avtdm = gsl_stats_skew(avtd, 1, (size_t) np);
-      rvtdm = gsl_stats_skew(rvtd, 1, (size_t) np);
-      for (iq = 0; iq < ctl.nq; iq++) {
-	aqtdm[iq] = gsl_stats_skew(&aqtd[iq * NP], 1, (size_t) np);
-	rqtdm[iq] = gsl_stats_skew(&rqtd[iq * NP], 1, (size_t) np);
-      }
-    } else if (strcasecmp(argv[3], "kurt") == 0) {
-      ahtdm = gsl_stats_kurtosis(ahtd, 1, (size_t) np);
-      rhtdm = gsl_stats_kurtosis(rhtd, 1, (size_t) np);
-      avtdm = gsl_stats_kurtosis(avtd, 1, (size_t) np);
-      rvtdm = gsl_stats_kurtosis(rvtd, 1, (size_t) np);
-      for (iq = 0; iq < ctl.nq; iq++) {
-	aqtdm[iq] = gsl_stats_kurtosis(&aqtd[iq * NP], 1, (size_t) np);
-	rqtdm[iq] = gsl_stats_kurtosis(&rqtd[iq * NP], 1, (size_t) np);
-      }
-    } else if (strcasecmp(argv[3], "median") == 0) {
-      ahtdm = gsl_stats_median(ahtd, 1, (size_t) np);
-      rhtdm = gsl_stats_median(rhtd, 1, (size_t) np);
-      avtdm = gsl_stats_median(avtd, 1, (size_t) np);
-      rvtdm = gsl_stats_median(rvtd, 1, (size_t) np);
-      for (iq = 0; iq < ctl.nq; iq++) {
-	aqtdm[iq] = gsl_stats_median(&aqtd[iq * NP], 1, (size_t) np);
-	rqtdm[iq] = gsl_stats_median(&rqtd[iq * NP], 1, (size_t) np);
-      }
-    } else if (strcasecmp(argv[3], "absdev") == 0) {
-      ahtdm = gsl_stats_absdev(ahtd, 1, (size_t) np);
-      rhtdm = gsl_stats_absdev(rhtd, 1, (size_t) np);
-      avtdm = gsl_stats_absdev(avtd, 1, (size_t) np);
-      rvtdm = gsl_stats_absdev(rvtd, 1, (size_t) np);
-      for (iq = 0; iq < ctl.nq; iq++) {
-	aqtdm[iq] = gsl_stats_absdev(&aqtd[iq * NP], 1, (size_t) np);
-	rqtdm[iq] = gsl_stats_absdev(&rqtd[iq * NP], 1, (size_t) np);
-      }
-    } else if (strcasecmp(argv[3], "mad") == 0) {
-      ahtdm = gsl_stats_mad0(ahtd, 1, (size_t) np, work);
-      rhtdm = gsl_stats_mad0(rhtd, 1, (size_t) np, work);
-      avtdm = gsl_stats_mad0(avtd, 1, (size_t) np, work);
-      rvtdm = gsl_stats_mad0(rvtd, 1, (size_t) np, work);
-      for (iq = 0; iq < ctl.nq; iq++) {
-	aqtdm[iq] = gsl_stats_mad0(&aqtd[iq * NP], 1, (size_t) np, work);
-	rqtdm[iq] = gsl_stats_mad0(&rqtd[iq * NP], 1, (size_t) np, work);
+    /* Pack deviations of selected air parcels... */
+    np = 0;
+    for (ip = 0; ip < atm[0]->np; ip++)
+      if (sel[ip]) {
+	ahtd[np] = ahtd[ip];
+	avtd[np] = avtd[ip];
+	rhtd[np] = rhtd[ip];
+	rvtd[np] = rvtd[ip];
+	for (iq = 0; iq < ctl.nq; iq++) {
+	  aqtd[iq * npmax + np] = aqtd[iq * npmax + ip];
+	  rqtd[iq * npmax + np] = rqtd[iq * npmax + ip];
+	}
+	np++;
       }
-    } else
-      ERRMSG("Unknown parameter!");
+
+    /* Get statistics... */
+    ahtdm = stats(argv[3], ahtd, np, work);
+    rhtdm = stats(argv[3], rhtd, np, work);
+    avtdm = stats(argv[3], avtd, np, work);
+    rvtdm = stats(argv[3], rvtd, np, work);
+    for (iq = 0; iq < ctl.nq; iq++) {
+      aqtdm[iq] = stats(argv[3], &aqtd[iq * npmax], np, work);
+      rqtdm[iq] = stats(argv[3], &rqtd[iq * npmax], np, work);
+    }
 
     /* Write output... */
     fprintf(out, "%.2f %.2f %g %g %g %g", t, t - t0,
@@ -331,8 +259,6 @@ int main(
   fclose(out);
 
   /* Free... */
-  free(atm1);
-  free(atm2);
   free(lon1_old);
   free(lat1_old);
   free(z1_old);
@@ -350,6 +276,7 @@ int main(
   free(rvtd);
   free(rqtd);
   free(work);
+  free(sel);
 
   return EXIT_SUCCESS;
 }
@@ -84,6 +84,9 @@ int main(
 	for (lat = lat0; lat <= lat1; lat += dlat)
 	  for (irep = 0; irep < rep; irep++) {
 
+	    /* Allocate... */
+	    alloc_atm(&ctl, atm, atm->np + 1);
+
 	    /* Set position... */
 	    atm->time[atm->np]
 	      = (t + gsl_ran_gaussian_ziggurat(rng, st / 2.3548)
@@ -104,8 +107,7 @@ int main(
 		     fabs(cos(atm->lat[atm->np] * M_PI / 180.)));
 
 	    /* Set particle counter... */
-	    if ((++atm->np) > NP)
-	      ERRMSG("Too many particles!");
+	    atm->np++;
 	  }
 
   /* Check number of air parcels... */
@@ -122,6 +124,7 @@ int main(
 
   /* Free... */
   gsl_rng_free(rng);
+  free_atm(atm);
   free(atm);
 
   return EXIT_SUCCESS;
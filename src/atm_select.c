@@ -117,14 +117,14 @@ int main(
       }
 
       /* Copy data... */
+      alloc_atm(&ctl, atm2, atm2->np + 1);
       atm2->time[atm2->np] = atm->time[ip];
       atm2->p[atm2->np] = atm->p[ip];
       atm2->lon[atm2->np] = atm->lon[ip];
       atm2->lat[atm2->np] = atm->lat[ip];
       for (iq = 0; iq < ctl.nq; iq++)
 	atm2->q[iq][atm2->np] = atm->q[iq][ip];
-      if ((++atm2->np) > NP)
-	ERRMSG("Too many air parcels!");
+      atm2->np++;
     }
   }
 
@@ -132,6 +132,8 @@ int main(
   write_atm(argv[2], &ctl, atm2, 0);
 
   /* Free... */
+  free_atm(atm);
+  free_atm(atm2);
   free(atm);
   free(atm2);
 
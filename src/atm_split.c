@@ -113,6 +113,9 @@ int main(
   if (m > 0)
     mtot = m;
 
+  /* Allocate... */
+  alloc_atm(&ctl, atm2, n);
+
   /* Loop over air parcels... */
   for (i = 0; i < n; i++) {
 
@@ -165,14 +168,15 @@ int main(
       atm2->q[ctl.qnt_m][atm2->np] = mtot / n;
 
     /* Increment particle counter... */
-    if ((++atm2->np) > NP)
-      ERRMSG("Too many air parcels!");
+    atm2->np++;
   }
 
   /* Save data and close file... */
   write_atm(argv[3], &ctl, atm2, 0);
 
   /* Free... */
+  free_atm(atm);
+  free_atm(atm2);
   free(atm);
   free(atm2);
 
@@ -34,24 +34,21 @@ int main(
 
   FILE *out;
 
-  char tstr[LEN];
+  char tstr[LEN], **files;
 
   double lat0, lat1, latm, lon0, lon1, lonm, p0, p1,
-    t, t0, qm[NQ], *work, zm, *zs;
+    t, t0, qm[NQ], *work = NULL, zm, *zs = NULL;
 
-  int ens, f, init = 0, ip, iq, year, mon, day, hour, min;
+  int ens, ifile, init = 0, ip, iq, npmax = 0, *sel = NULL, year, mon, day,
+    hour, min;
 
   /* Allocate... */
-  ALLOC(atm, atm_t, 1);
   ALLOC(atm_filt, atm_t, 1);
-  ALLOC(work, double,
-	NP);
-  ALLOC(zs, double,
-	NP);
 
   /* Check arguments... */
   if (argc < 4)
     ERRMSG("Give parameters: <ctl> <stat.tab> <param> <atm1> [<atm2> ...]");
+  files = &argv[4];
 
   /* Read control parameters... */
   read_ctl(argv[1], argc, argv, &ctl);
@@ -82,23 +79,28 @@ int main(
 	    ctl.qnt_name[iq], argv[3], ctl.qnt_unit[iq]);
   fprintf(out, "# $%d = number of particles\n\n", ctl.nq + 6);
 
-  /* Loop over files... */
-  for (f = 4; f < argc; f++) {
+  /* Loop over files (next file is read in the background)... */
+  for (ifile = -1; read_atm_list(&ctl, argc - 4, files, 1, &ifile, &atm);) {
 
-    /* Read atmopheric data... */
-    if (!read_atm(argv[f], &ctl, atm))
-      continue;
+    /* Allocate... */
+    alloc_atm(&ctl, atm_filt, atm->np);
+    if (atm->np > npmax) {
+      npmax = atm->np;
+      REALLOC(work, double, npmax);
+      REALLOC(zs, double, npmax);
+      REALLOC(sel, int, npmax);
+    }
 
     /* Get time from filename... */
-    sprintf(tstr, "%.4s", &argv[f][strlen(argv[f]) - 20]);
+    sprintf(tstr, "%.4s", &files[ifile][strlen(files[ifile]) - 20]);
     year = atoi(tstr);
-    sprintf(tstr, "%.2s", &argv[f][strlen(argv[f]) - 15]);
+    sprintf(tstr, "%.2s", &files[ifile][strlen(files[ifile]) - 15]);
     mon = atoi(tstr);
-    sprintf(tstr, "%.2s", &argv[f][strlen(argv[f]) - 12]);
+    sprintf(tstr, "%.2s", &files[ifile][strlen(files[ifile]) - 12]);
     day = atoi(tstr);
-    sprintf(tstr, "%.2s", &argv[f][strlen(argv[f]) - 9]);
+    sprintf(tstr, "%.2s", &files[ifile][strlen(files[ifile]) - 9]);
     hour = atoi(tstr);
-    sprintf(tstr, "%.2s", &argv[f][strlen(argv[f]) - 6]);
+    sprintf(tstr, "%.2s", &files[ifile][strlen(files[ifile]) - 6]);
     min = atoi(tstr);
     time2jsec(year, mon, day, hour, min, 0, 0, &t);
 
@@ -108,97 +110,39 @@ int main(
       t0 = t;
     }
 
+    /* Select data... */
+#pragma omp parallel for default(shared)
+    for (ip = 0; ip < atm->np; ip++)
+      sel[ip] = (gsl_finite(atm->time[ip])
+		 && (ctl.qnt_ens <= 0 || atm->q[ctl.qnt_ens][ip] == ens)
+		 && !(atm->p[ip] > p0 || atm->p[ip] < p1
+		      || atm->lon[ip] < lon0 || atm->lon[ip] > lon1
+		      || atm->lat[ip] < lat0 || atm->lat[ip] > lat1));
+
     /* Filter data... */
     atm_filt->np = 0;
-    for (ip = 0; ip < atm->np; ip++) {
-
-      /* Check time... */
-      if (!gsl_finite(atm->time[ip]))
-	continue;
-
-      /* Check ensemble index... */
-      if (ctl.qnt_ens > 0 && atm->q[ctl.qnt_ens][ip] != ens)
-	continue;
-
-      /* Check spatial range... */
-      if (atm->p[ip] > p0 || atm->p[ip] < p1
-	  || atm->lon[ip] < lon0 || atm->lon[ip] > lon1
-	  || atm->lat[ip] < lat0 || atm->lat[ip] > lat1)
-	continue;
-
-      /* Save data... */
-      atm_filt->time[atm_filt->np] = atm->time[ip];
-      atm_filt->p[atm_filt->np] = atm->p[ip];
-      atm_filt->lon[atm_filt->np] = atm->lon[ip];
-      atm_filt->lat[atm_filt->np] = atm->lat[ip];
-      for (iq = 0; iq < ctl.nq; iq++)
-	atm_filt->q[iq][atm_filt->np] = atm->q[iq][ip];
-      atm_filt->np++;
-    }
+    for (ip = 0; ip < atm->np; ip++)
+      if (sel[ip]) {
+	atm_filt->time[atm_filt->np] = atm->time[ip];
+	atm_filt->p[atm_filt->np] = atm->p[ip];
+	atm_filt->lon[atm_filt->np] = atm->lon[ip];
+	atm_filt->lat[atm_filt->np] = atm->lat[ip];
+	for (iq = 0; iq < ctl.nq; iq++)
+	  atm_filt->q[iq][atm_filt->np] = atm->q[iq][ip];
+	atm_filt->np++;
+      }
 
     /* Get heights... */
+#pragma omp parallel for default(shared)
     for (ip = 0; ip < atm_filt->np; ip++)
       zs[ip] = Z(atm_filt->p[ip]);
 
     /* Get statistics... */
-    if (strcasecmp(argv[3], "mean") == 0) {
-      zm = gsl_stats_mean(zs, 1, (size_t) atm_filt->np);
-      lonm = gsl_stats_mean(atm_filt->lon, 1, (size_t) atm_filt->np);
-      latm = gsl_stats_mean(atm_filt->lat, 1, (size_t) atm_filt->np);
-      for (iq = 0; iq < ctl.nq; iq++)
-	qm[iq] = gsl_stats_mean(atm_filt->q[iq], 1, (size_t) atm_filt->np);
-    } else if (strcasecmp(argv[3], "stddev") == 0) {
-      zm = gsl_stats_sd(zs, 1, (size_t) atm_filt->np);
-      lonm = gsl_stats_sd(atm_filt->lon, 1, (size_t) atm_filt->np);
-      latm = gsl_stats_sd(atm_filt->lat, 1, (size_t) atm_filt->np);
-      for (iq = 0; iq < ctl.nq; iq++)
-	qm[iq] = gsl_stats_sd(atm_filt->q[iq], 1, (size_t) atm_filt->np);
-    } else if (strcasecmp(argv[3], "min") == 0) {
-      zm = gsl_stats_min(zs, 1, (size_t) atm_filt->np);
-      lonm = gsl_stats_min(atm_filt->lon, 1, (size_t) atm_filt->np);
-      latm = gsl_stats_min(atm_filt->lat, 1, (size_t) atm_filt->np);
-      for (iq = 0; iq < ctl.nq; iq++)
-	qm[iq] = gsl_stats_min(atm_filt->q[iq], 1, (size_t) atm_filt->np);
-    } else if (strcasecmp(argv[3], "max") == 0) {
-      zm = gsl_stats_max(zs, 1, (size_t) atm_filt->np);
-      lonm = gsl_stats_max(atm_filt->lon, 1, (size_t) atm_filt->np);
-      latm = gsl_stats_max(atm_filt->lat, 1, (size_t) atm_filt->np);
-      for (iq = 0; iq < ctl.nq; iq++)
-	qm[iq] = gsl_stats_max(atm_filt->q[iq], 1, (size_t) atm_filt->np);
-    } else if (strcasecmp(argv[3], "skew") == 0) {
-      zm = gsl_stats_skew(zs, 1, (size_t) atm_filt->np);
-      lonm = gsl_stats_skew(atm_filt->lon, 1, (size_t) atm_filt->np);
-      latm = gsl_stats_skew(atm_filt->lat, 1, (size_t) atm_filt->np);
-      for (iq = 0; iq < ctl.nq; iq++)
-	qm[iq] = gsl_stats_skew(atm_filt->q[iq], 1, (size_t) atm_filt->np);
-    } else if (strcasecmp(argv[3], "kurt") == 0) {
-      zm = gsl_stats_kurtosis(zs, 1, (size_t) atm_filt->np);
-      lonm = gsl_stats_kurtosis(atm_filt->lon, 1, (size_t) atm_filt->np);
-      latm = gsl_stats_kurtosis(atm_filt->lat, 1, (size_t) atm_filt->np);
-      for (iq = 0; iq < ctl.nq; iq++)
-	qm[iq] =
-	  gsl_stats_kurtosis(atm_filt->q[iq], 1, (size_t) atm_filt->np);
-    } else if (strcasecmp(argv[3], "median") == 0) {
-      zm = gsl_stats_median(zs, 1, (size_t) atm_filt->np);
-      lonm = gsl_stats_median(atm_filt->lon, 1, (size_t) atm_filt->np);
-      latm = gsl_stats_median(atm_filt->lat, 1, (size_t) atm_filt->np);
-      for (iq = 0; iq < ctl.nq; iq++)
-	qm[iq] = gsl_stats_median(atm_filt->q[iq], 1, (size_t) atm_filt->np);
-    } else if (strcasecmp(argv[3], "absdev") == 0) {
-      zm = gsl_stats_absdev(zs, 1, (size_t) atm_filt->np);
-      lonm = gsl_stats_absdev(atm_filt->lon, 1, (size_t) atm_filt->np);
-      latm = gsl_stats_absdev(atm_filt->lat, 1, (size_t) atm_filt->np);
-      for (iq = 0; iq < ctl.nq; iq++)
-	qm[iq] = gsl_stats_absdev(atm_filt->q[iq], 1, (size_t) atm_filt->np);
-    } else if (strcasecmp(argv[3], "mad") == 0) {
-      zm = gsl_stats_mad0(zs, 1, (size_t) atm_filt->np, work);
-      lonm = gsl_stats_mad0(atm_filt->lon, 1, (size_t) atm_filt->np, work);
-      latm = gsl_stats_mad0(atm_filt->lat, 1, (size_t) atm_filt->np, work);
-      for (iq = 0; iq < ctl.nq; iq++)
-	qm[iq] =
-	  gsl_stats_mad0(atm_filt->q[iq], 1, (size_t) atm_filt->np, work);
-    } else
-      ERRMSG("Unknown parameter!");
+    zm = stats(argv[3], zs, atm_filt->np, work);
+    lonm = stats(argv[3], atm_filt->lon, atm_filt->np, work);
+    latm = stats(argv[3], atm_filt->lat, atm_filt->np, work);
+    for (iq = 0; iq < ctl.nq; iq++)
+      qm[iq] = stats(argv[3], atm_filt->q[iq], atm_filt->np, work);
 
     /* Write data... */
     fprintf(out, "%.2f %.2f %g %g %g", t, t - t0, zm, lonm, latm);
@@ -213,10 +157,11 @@ int main(
   fclose(out);
 
   /* Free... */
-  free(atm);
+  free_atm(atm_filt);
   free(atm_filt);
   free(work);
   free(zs);
+  free(sel);
 
   return EXIT_SUCCESS;
 }
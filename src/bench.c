@@ -0,0 +1,459 @@
+/*
+  This file is part of MPTRAC.
+
+  MPTRAC is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  MPTRAC is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with MPTRAC. If not, see <http://www.gnu.org/licenses/>.
+
+  Copyright (C) 2013-2019 Forschungszentrum Juelich GmbH
+*/
+
+/*!
+  \file
+  Benchmark library kernels on synthetic meteorological data.
+*/
+
+#include "libtrac.h"
+
+/* ------------------------------------------------------------
+   Dimensions...
+   ------------------------------------------------------------ */
+
+/*! Number of kernels. */
+#define NKERNEL 18
+
+/*! Maximum number of thread counts. */
+#define NTHREADS 32
+
+/* ------------------------------------------------------------
+   Functions...
+   ------------------------------------------------------------ */
+
+/*! Create synthetic meteorological data with analytic fields. */
+void bench_met(
+  met_t * met,
+  int nx,
+  int ny,
+  int np,
+  double time);
+
+/*! Create air parcels at random positions. */
+void bench_atm(
+  ctl_t * ctl,
+  met_t * met0,
+  met_t * met1,
+  atm_t * atm,
+  int np);
+
+/*! Run a kernel once and return its runtime [s]. */
+double bench_kernel(
+  int kernel,
+  ctl_t * ctl,
+  met_t * met0,
+  met_t * met1,
+  met_t * met2,
+  atm_t * atm,
+  cache_t * cache,
+  double *dt);
+
+/* ------------------------------------------------------------
+   Main...
+   ------------------------------------------------------------ */
+
+int main(
+  int argc,
+  char *argv[]) {
+
+  static const char *name[NKERNEL] = { "locate_irr", "locate_reg",
+    "locate_met_p", "intpol_met_space_3d", "intpol_met_time_3d",
+    "intpol_met_time_uvw", "intpol_met_cache", "read_met_geopot",
+    "read_met_pv", "read_met_tropo", "read_met_cloud", "read_met_sample",
+    "write_grid", "module_advection", "module_diffusion_turb",
+    "module_diffusion_meso", "module_sort", "module_step"
+  };
+
+  ctl_t ctl;
+
+  atm_t *atm;
+
+  cache_t *cache;
+
+  met_t *met0, *met1, *met2;
+
+  FILE *out;
+
+  double *dt = NULL, rate0[NKERNEL];
+
+  int nt[NTHREADS], nnt = 0;
+
+  /* Allocate... */
+  ALLOC(atm, atm_t, 1);
+  ALLOC(cache, cache_t, 1);
+  ALLOC(met0, met_t, 1);
+  ALLOC(met1, met_t, 1);
+  ALLOC(met2, met_t, 1);
+
+  /* Check arguments... */
+  if (argc < 3)
+    ERRMSG("Give parameters: <ctl> <bench.tab>");
+
+  /* Read control parameters... */
+  read_ctl(argv[1], argc, argv, &ctl);
+  int nx = (int) scan_ctl(argv[1], argc, argv, "BENCH_NX", -1, "360", NULL);
+  int ny = (int) scan_ctl(argv[1], argc, argv, "BENCH_NY", -1, "181", NULL);
+  int nz = (int) scan_ctl(argv[1], argc, argv, "BENCH_NZ", -1, "60", NULL);
+  int npart =
+    (int) scan_ctl(argv[1], argc, argv, "BENCH_NP", -1, "100000", NULL);
+  int nrep = (int) scan_ctl(argv[1], argc, argv, "BENCH_REP", -1, "3", NULL);
+  int weak = (int) scan_ctl(argv[1], argc, argv, "BENCH_WEAK", -1, "0", NULL);
+  int tmax = (int) scan_ctl(argv[1], argc, argv, "BENCH_THREADS", -1,
+			    "0", NULL);
+
+  /* Check dimensions... */
+  if (nx < 2 || nx > EX || ny < 2 || ny > EY || nz < 2 || nz > EP)
+    ERRMSG("Grid dimensions out of range!");
+  if (npart < 1 || nrep < 1)
+    ERRMSG("Set BENCH_NP and BENCH_REP to positive values!");
+
+  /* Set thread counts (powers of two up to the maximum)... */
+  if (tmax <= 0)
+    tmax = omp_get_max_threads();
+  for (int n = 1; n < tmax && nnt < NTHREADS - 1; n *= 2)
+    nt[nnt++] = n;
+  nt[nnt++] = tmax;
+
+  /* Create synthetic meteorological data... */
+  printf("Create synthetic meteo data: %d x %d x %d\n", nx, ny, nz);
+  bench_met(met0, nx, ny, nz, 0);
+  bench_met(met1, nx, ny, nz, ctl.dt_met);
+
+  /* Create output file... */
+  printf("Write benchmark data: %s\n", argv[2]);
+  if (!(out = fopen(argv[2], "w")))
+    ERRMSG("Cannot create file!");
+
+  /* Write header... */
+  fprintf(out,
+	  "# $1 = kernel\n"
+	  "# $2 = number of threads\n"
+	  "# $3 = number of air parcels or grid points\n"
+	  "# $4 = runtime (minimum of repetitions) [s]\n"
+	  "# $5 = throughput [1/s]\n"
+	  "# $6 = speedup relative to one thread\n"
+	  "# $7 = parallel efficiency (%s scaling) [%%]\n",
+	  weak ? "weak" : "strong");
+
+  /* Loop over thread counts... */
+  for (int it = 0; it < nnt; it++) {
+    omp_set_num_threads(nt[it]);
+
+    /* Create air parcels... */
+    int n = weak ? npart * nt[it] : npart;
+    bench_atm(&ctl, met0, met1, atm, n);
+    alloc_cache(&ctl, cache, n, met0);
+
+    /* Set time steps... */
+    REALLOC(dt, double, n);
+    for (int ip = 0; ip < n; ip++) {
+      cache->id[ip] = ip;
+      dt[ip] = ctl.dt_mod;
+    }
+
+    /* Loop over kernels... */
+    fprintf(out, "\n");
+    for (int k = 0; k < NKERNEL; k++) {
+
+      /* Skip sampling if it is switched off... */
+      if (k == 11 && ctl.met_dx <= 1 && ctl.met_dy <= 1 && ctl.met_dp <= 1
+	  && ctl.met_sx <= 1 && ctl.met_sy <= 1 && ctl.met_sp <= 1)
+	continue;
+
+      /* Skip mesoscale diffusion if it is switched off... */
+      if (k == 15 && !cache->usig)
+	continue;
+
+      /* Get minimum runtime... */
+      double rt = 1e100;
+      for (int irep = 0; irep < nrep; irep++)
+	rt = GSL_MIN(rt, bench_kernel(k, &ctl, met0, met1, met2, atm, cache,
+				      dt));
+
+      /* Get throughput... */
+      double work = (k >= 7 && k <= 11 ? 1. * nx * ny * nz : 1. * n);
+      double rate = work / rt;
+      if (it == 0)
+	rate0[k] = rate;
+      double speedup = rate / rate0[k];
+
+      /* Write output... */
+      fprintf(out, "%s %d %g %g %g %g %g\n", name[k], nt[it], work, rt,
+	      rate, speedup, 100. * speedup / nt[it]);
+      printf("BENCH_%s = %d %g %g s %g 1/s\n", name[k], nt[it], work, rt,
+	     rate);
+    }
+  }
+
+  /* Close file... */
+  fclose(out);
+
+  /* Free... */
+  free_atm(atm);
+  free_cache(cache);
+  free_met(met0);
+  free_met(met1);
+  free_met(met2);
+  free(dt);
+  free(atm);
+  free(cache);
+  free(met0);
+  free(met1);
+  free(met2);
+
+  return EXIT_SUCCESS;
+}
+
+/*****************************************************************************/
+
+void bench_met(
+  met_t * met,
+  int nx,
+  int ny,
+  int np,
+  double time) {
+
+  /* Set grid... */
+  alloc_met(met, nx, ny, np);
+  met->time = time;
+  met->nx = nx;
+  met->ny = ny;
+  met->np = np;
+  for (int ix = 0; ix < nx; ix++)
+    met->lon[ix] = -180. + 360. * ix / nx;
+  for (int iy = 0; iy < ny; iy++)
+    met->lat[iy] = -90. + 180. * iy / (ny - 1);
+  for (int ip = 0; ip < np; ip++)
+    met->p[ip] = 1000. * exp(-ip * log(1000. / 0.1) / (np - 1));
+
+  /* Set analytic fields (zonal jet, planetary waves, standard
+     atmosphere)... */
+  double dt = sin(2. * M_PI * time / 86400.);
+#pragma omp parallel for default(shared)
+  for (int ix = 0; ix < nx; ix++)
+    for (int iy = 0; iy < ny; iy++) {
+      double lon = met->lon[ix] * M_PI / 180.;
+      double lat = met->lat[iy] * M_PI / 180.;
+      met->ps[ARRAY_2D(ix, iy, met->ey)] =
+	(float) (1013.25 - 20. * SQR(sin(lat)) * cos(2. * lon));
+      met->zs[ARRAY_2D(ix, iy, met->ey)] =
+	(float) GSL_MAX(0., 2. * cos(lat) * sin(3. * lon));
+      for (int ip = 0; ip < np; ip++) {
+	double z = Z(met->p[ip]);
+	int i = ARRAY_3D(ix, iy, met->ey, ip, met->ep);
+	met->t[i] = (float) GSL_MAX(288.15 - 6.5 * z, 216.65 + (z - 20.));
+	met->uvw[3 * i] =
+	  (float) (40. * cos(lat) * exp(-SQR((z - 12.) / 8.))
+		   + 10. * sin(2. * lat) * cos(4. * lon + dt));
+	met->uvw[3 * i + 1] = (float) (10. * cos(lat) * sin(4. * lon + dt));
+	met->uvw[3 * i + 2] = (float) (1e-3 * cos(lat) * sin(2. * lon - dt));
+	met->h2o[i] = (float) (1e-2 * exp(-z / 2.) + 4e-6);
+	met->o3[i] = (float) (8e-6 * exp(-SQR((z - 30.) / 10.)));
+	met->lwc[i] = met->iwc[i] = 0;
+      }
+    }
+
+  /* Derive remaining fields... */
+  read_met_geopot(met);
+  read_met_plut(met);
+}
+
+/*****************************************************************************/
+
+void bench_atm(
+  ctl_t * ctl,
+  met_t * met0,
+  met_t * met1,
+  atm_t * atm,
+  int np) {
+
+  gsl_rng *rng;
+
+  /* Allocate... */
+  alloc_atm(ctl, atm, np);
+  rng = gsl_rng_alloc(gsl_rng_default);
+
+  /* Set random positions... */
+  atm->np = np;
+  for (int ip = 0; ip < np; ip++) {
+    atm->time[ip] = met0->time + gsl_rng_uniform(rng)
+      * (met1->time - met0->time);
+    atm->p[ip] = P(gsl_rng_uniform(rng) * 40.);
+    atm->lon[ip] = -180. + 360. * gsl_rng_uniform(rng);
+    atm->lat[ip] = -90. + 180. * gsl_rng_uniform(rng);
+    for (int iq = 0; iq < ctl->nq; iq++)
+      atm->q[iq][ip] = 1.;
+  }
+
+  /* Free... */
+  gsl_rng_free(rng);
+}
+
+/*****************************************************************************/
+
+double bench_kernel(
+  int kernel,
+  ctl_t * ctl,
+  met_t * met0,
+  met_t * met1,
+  met_t * met2,
+  atm_t * atm,
+  cache_t * cache,
+  double *dt) {
+
+  double sum = 0, t0;
+
+  /* Prepare scratch data for sampling... */
+  if (kernel == 11)
+    bench_met(met2, met0->nx, met0->ny, met0->np, met0->time);
+
+  /* Invalidate cached interpolation weights (measure cache misses)... */
+  if (kernel == 6 && cache->cx)
+    for (int i = 0; i < 3 * cache->np; i++)
+      cache->cx[i] = GSL_NAN;
+
+  /* Reset air parcels and wind standard deviations for the modules... */
+  if (kernel >= 13) {
+    bench_atm(ctl, met0, met1, atm, atm->np);
+    module_active(atm, cache, dt);
+    cache->tsig = GSL_NAN;
+  }
+
+  /* Run kernel... */
+  t0 = omp_get_wtime();
+  switch (kernel) {
+
+  case 0:
+#pragma omp parallel for default(shared) reduction(+:sum)
+    for (int ip = 0; ip < atm->np; ip++)
+      sum += locate_irr(met0->p, met0->np, atm->p[ip]);
+    break;
+
+  case 1:
+#pragma omp parallel for default(shared) reduction(+:sum)
+    for (int ip = 0; ip < atm->np; ip++)
+      sum += locate_reg(met0->lon, met0->nx, atm->lon[ip]);
+    break;
+
+  case 2:
+#pragma omp parallel for default(shared) reduction(+:sum)
+    for (int ip = 0; ip < atm->np; ip++)
+      sum += locate_met_p(met0, atm->p[ip]);
+    break;
+
+  case 3:
+#pragma omp parallel for default(shared) reduction(+:sum)
+    for (int ip = 0; ip < atm->np; ip++) {
+      double var, cw[3];
+      int ci[3];
+      intpol_met_space_3d(met0, met0->t, atm->p[ip], atm->lon[ip],
+			  atm->lat[ip], &var, ci, cw, 1);
+      sum += var;
+    }
+    break;
+
+  case 4:
+#pragma omp parallel for default(shared) reduction(+:sum)
+    for (int ip = 0; ip < atm->np; ip++) {
+      double var, cw[3];
+      int ci[3];
+      intpol_met_time_3d(met0, met0->t, met1, met1->t, atm->time[ip],
+			 atm->p[ip], atm->lon[ip], atm->lat[ip], &var, ci,
+			 cw, 1);
+      sum += var;
+    }
+    break;
+
+  case 5:
+#pragma omp parallel for default(shared) reduction(+:sum)
+    for (int ip = 0; ip < atm->np; ip++) {
+      double u, v, w;
+      intpol_met_time_uvw(met0, met1, atm->time[ip], atm->p[ip],
+			  atm->lon[ip], atm->lat[ip], &u, &v, &w);
+      sum += u + v + w;
+    }
+    break;
+
+  case 6:
+#pragma omp parallel for default(shared) reduction(+:sum)
+    for (int ip = 0; ip < atm->np; ip++) {
+      double var, cw[3];
+      int ci[3];
+      intpol_met_cache(cache, met0, ip, atm->p[ip], atm->lon[ip],
+		       atm->lat[ip], ci, cw);
+      intpol_met_space_3d(met0, met0->t, atm->p[ip], atm->lon[ip],
+			  atm->lat[ip], &var, ci, cw, 0);
+      sum += var;
+    }
+    break;
+
+  case 7:
+    read_met_geopot(met0);
+    break;
+
+  case 8:
+    read_met_pv(met0);
+    break;
+
+  case 9:
+    read_met_tropo(ctl, met0);
+    break;
+
+  case 10:
+    read_met_cloud(met0);
+    break;
+
+  case 11:
+    read_met_sample(ctl, met2);
+    break;
+
+  case 12:
+    write_grid("/dev/null", ctl, met0, met1, atm, met0->time);
+    write_async_wait();
+    break;
+
+  case 13:
+    module_advection(ctl, met0, met1, atm, cache, dt);
+    break;
+
+  case 14:
+    module_diffusion_turb(ctl, atm, cache, dt);
+    break;
+
+  case 15:
+    module_diffusion_meso(ctl, met0, met1, atm, cache, dt);
+    break;
+
+  case 16:
+    module_sort(ctl, met0, atm, cache);
+    break;
+
+  case 17:
+    module_step(ctl, met0, met1, atm, cache, dt);
+    break;
+  }
+  t0 = omp_get_wtime() - t0;
+
+  /* Check result to keep the compiler from removing the loops... */
+  if (!gsl_finite(sum))
+    WARN("Benchmark result is not finite!");
+
+  return t0;
+}
@@ -24,6 +24,145 @@
 
 #include "libtrac.h"
 
+/*! Lock for netCDF library calls (netCDF-C is not thread safe). */
+static pthread_mutex_t nc_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/*****************************************************************************/
+
+void alloc_atm(
+  ctl_t * ctl,
+  atm_t * atm,
+  int np) {
+
+  size_t n;
+
+  int iq;
+
+  /* Check size... */
+  if (np <= atm->npmax)
+    return;
+
+  /* Copy memory-mapped data before growing the arrays... */
+  if (atm->map) {
+    double **arr[NQ + 4] = { &atm->time, &atm->p, &atm->lon, &atm->lat };
+    for (iq = 0; iq < ctl->nq; iq++)
+      arr[iq + 4] = &atm->q[iq];
+    for (iq = 0; iq < ctl->nq + 4; iq++) {
+      double *help;
+      ALLOC(help, double, atm->npmax);
+      memcpy(help, *arr[iq], (size_t) atm->npmax * sizeof(double));
+      *arr[iq] = help;
+    }
+    munmap(atm->map, atm->mapsize);
+    atm->map = NULL;
+    atm->mapsize = 0;
+  }
+
+  /* Grow at least by a factor of two to keep appending cheap... */
+  np = GSL_MAX(np, 2 * atm->npmax);
+
+  /* Reallocate... */
+  REALLOC(atm->time, double, np);
+  REALLOC(atm->p, double, np);
+  REALLOC(atm->lon, double, np);
+  REALLOC(atm->lat, double, np);
+  for (iq = 0; iq < ctl->nq; iq++)
+    REALLOC(atm->q[iq], double, np);
+
+  /* Initialize new data... */
+  n = (size_t) (np - atm->npmax) * sizeof(double);
+  memset(atm->time + atm->npmax, 0, n);
+  memset(atm->p + atm->npmax, 0, n);
+  memset(atm->lon + atm->npmax, 0, n);
+  memset(atm->lat + atm->npmax, 0, n);
+  for (iq = 0; iq < ctl->nq; iq++)
+    memset(atm->q[iq] + atm->npmax, 0, n);
+  atm->npmax = np;
+}
+
+/*****************************************************************************/
+
+void alloc_cache(
+  ctl_t * ctl,
+  cache_t * cache,
+  int np,
+  met_t * met) {
+
+  /* Free old data... */
+  free_cache(cache);
+
+  /* Allocate air parcel data... */
+  cache->np = np;
+  ALLOC(cache->id, int, np);
+  ALLOC(cache->iact, int, np);
+  ALLOC(cache->up, float, np);
+  ALLOC(cache->vp, float, np);
+  ALLOC(cache->wp, float, np);
+  ALLOC(cache->iso_var, double, np);
+
+  /* Allocate cache of interpolation indices and weights... */
+  if (ctl->intpol_cache) {
+    ALLOC(cache->ci, int, 3 * np);
+    ALLOC(cache->cw, double, 3 * np);
+    ALLOC(cache->cx, double, 3 * np);
+    for (int i = 0; i < 3 * np; i++)
+      cache->cx[i] = GSL_NAN;
+  }
+
+  /* Allocate wind standard deviations on the meteo grid... */
+  cache->tsig = GSL_NAN;
+  if (ctl->turb_mesox > 0 || ctl->turb_mesoz > 0) {
+    cache->ex = met->nx;
+    cache->ey = met->ny;
+    cache->ep = met->np;
+    ALLOC(cache->usig, float, met->nx * met->ny * met->np);
+    ALLOC(cache->vsig, float, met->nx * met->ny * met->np);
+    ALLOC(cache->wsig, float, met->nx * met->ny * met->np);
+  }
+}
+
+/*****************************************************************************/
+
+void alloc_met(
+  met_t * met,
+  int nx,
+  int ny,
+  int np) {
+
+  /* Check size (float winds are released by read_met_uvw16)... */
+  if (!met->map && nx == met->ex && ny == met->ey && np == met->ep) {
+    if (!met->uvw)
+      ALLOC(met->uvw, float, 3 * nx * ny * np);
+    return;
+  }
+
+  /* Free old data... */
+  free_met(met);
+
+  /* Set array dimensions... */
+  met->ex = nx;
+  met->ey = ny;
+  met->ep = np;
+
+  /* Allocate surface data... */
+  ALLOC(met->ps, float, nx * ny);
+  ALLOC(met->zs, float, nx * ny);
+  ALLOC(met->pt, float, nx * ny);
+  ALLOC(met->pc, float, nx * ny);
+  ALLOC(met->cl, float, nx * ny);
+
+  /* Allocate level data... */
+  ALLOC(met->z, float, nx * ny * np);
+  ALLOC(met->t, float, nx * ny * np);
+  ALLOC(met->pv, float, nx * ny * np);
+  ALLOC(met->h2o, float, nx * ny * np);
+  ALLOC(met->o3, float, nx * ny * np);
+  ALLOC(met->lwc, float, nx * ny * np);
+  ALLOC(met->iwc, float, nx * ny * np);
+  ALLOC(met->pl, float, nx * ny * np);
+  ALLOC(met->uvw, float, 3 * nx * ny * np);
+}
+
 /*****************************************************************************/
 
 void cart2geo(
@@ -1530,6 +1669,30 @@ double clim_tropo(
 
 /*****************************************************************************/
 
+double counter(
+  int id,
+  double inc) {
+
+  static double count[NCOUNTER];
+
+  static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+
+  double total;
+
+  /* Check id... */
+  if (id < 0 || id >= NCOUNTER)
+    ERRMSG("Too many counters!");
+
+  /* Update counter (also called by reader and writer threads)... */
+  pthread_mutex_lock(&mutex);
+  total = count[id] += inc;
+  pthread_mutex_unlock(&mutex);
+
+  return total;
+}
+
+/*****************************************************************************/
+
 void day2doy(
   int year,
   int mon,
@@ -1576,6 +1739,104 @@ void doy2day(
 
 /*****************************************************************************/
 
+void free_atm(
+  atm_t * atm) {
+
+  int iq;
+
+  /* Unmap binary file... */
+  if (atm->map) {
+    munmap(atm->map, atm->mapsize);
+    atm->map = NULL;
+    atm->mapsize = 0;
+  }
+
+  /* Free allocated data... */
+  else {
+    free(atm->time);
+    free(atm->p);
+    free(atm->lon);
+    free(atm->lat);
+    for (iq = 0; iq < NQ; iq++)
+      free(atm->q[iq]);
+  }
+
+  atm->time = atm->p = atm->lon = atm->lat = NULL;
+  for (iq = 0; iq < NQ; iq++)
+    atm->q[iq] = NULL;
+  atm->np = atm->npmax = 0;
+}
+
+/*****************************************************************************/
+
+void free_cache(
+  cache_t * cache) {
+
+  free(cache->id);
+  free(cache->iact);
+  free(cache->up);
+  free(cache->vp);
+  free(cache->wp);
+  free(cache->iso_var);
+  free(cache->iso_ps);
+  free(cache->iso_ts);
+  free(cache->usig);
+  free(cache->vsig);
+  free(cache->wsig);
+  free(cache->ci);
+  free(cache->cw);
+  free(cache->cx);
+  cache->id = cache->iact = cache->ci = NULL;
+  cache->cw = cache->cx = NULL;
+  cache->up = cache->vp = cache->wp = NULL;
+  cache->usig = cache->vsig = cache->wsig = NULL;
+  cache->iso_var = cache->iso_ps = cache->iso_ts = NULL;
+  cache->ex = cache->ey = cache->ep = 0;
+}
+
+/*****************************************************************************/
+
+void free_met(
+  met_t * met) {
+
+  /* Free packed winds... */
+  free(met->uvwh);
+  met->uvwh = NULL;
+
+  /* Unmap cache file... */
+  if (met->map) {
+    munmap(met->map, met->mapsize);
+    met->map = NULL;
+    met->mapsize = 0;
+  }
+
+  /* Free allocated data... */
+  else {
+    free(met->ps);
+    free(met->zs);
+    free(met->pt);
+    free(met->pc);
+    free(met->cl);
+    free(met->z);
+    free(met->t);
+    free(met->pv);
+    free(met->h2o);
+    free(met->o3);
+    free(met->lwc);
+    free(met->iwc);
+    free(met->pl);
+    free(met->uvw);
+  }
+
+  /* Reset pointers... */
+  met->ps = met->zs = met->pt = met->pc = met->cl = NULL;
+  met->z = met->t = met->pv = NULL;
+  met->h2o = met->o3 = met->lwc = met->iwc = met->pl = met->uvw = NULL;
+  met->ex = met->ey = met->ep = 0;
+}
+
+/*****************************************************************************/
+
 void geo2cart(
   double z,
   double lon,
@@ -1590,6 +1851,11 @@ void geo2cart(
 
 /*****************************************************************************/
 
+/*! Flag to read the initial meteo data at the next call of get_met. */
+static int met_init = 1;
+
+/*****************************************************************************/
+
 void get_met(
   ctl_t * ctl,
   char *metbase,
@@ -1597,15 +1863,18 @@ void get_met(
   met_t ** met0,
   met_t ** met1) {
 
-  static int init, ip, ix, iy;
+  static int ip, ix, iy;
 
   met_t *mets;
 
   char filename[LEN];
 
   /* Init... */
-  if (t == ctl->t_start || !init) {
-    init = 1;
+  if (t == ctl->t_start || met_init) {
+    met_init = 0;
+
+    /* Discard pending prefetch... */
+    get_met_prefetch_swap(NULL, NULL);
 
     get_met_help(t, -1, metbase, ctl->dt_met, filename);
     if (!read_met(ctl, filename, *met0))
@@ -1617,8 +1886,17 @@ void get_met(
 #ifdef _OPENACC
     met_t *met0up = *met0;
     met_t *met1up = *met1;
+    double tacc = omp_get_wtime();
 #pragma acc update device(met0up[:1],met1up[:1])
+    counter(COUNTER_H2D_BYTES, 2. * sizeof(met_t));
+    counter(COUNTER_H2D_TIME, omp_get_wtime() - tacc);
 #endif
+
+    /* Prefetch next file... */
+    if (ctl->direction == 1)
+      get_met_prefetch(ctl, metbase, (*met1)->time + ctl->dt_met, 1);
+    else
+      get_met_prefetch(ctl, metbase, (*met0)->time - ctl->dt_met, -1);
   }
 
   /* Read new data for forward trajectories... */
@@ -1627,12 +1905,18 @@ void get_met(
     *met1 = *met0;
     *met0 = mets;
     get_met_help(t, 1, metbase, ctl->dt_met, filename);
-    if (!read_met(ctl, filename, *met1))
-      ERRMSG("Cannot open file!");
+    if (!get_met_prefetch_swap(filename, met1)) {
+      if (!read_met(ctl, filename, *met1))
+	ERRMSG("Cannot open file!");
 #ifdef _OPENACC
-    met_t *met1up = *met1;
+      met_t *met1up = *met1;
+      double tacc = omp_get_wtime();
 #pragma acc update device(met1up[:1])
+      counter(COUNTER_H2D_BYTES, (double) sizeof(met_t));
+      counter(COUNTER_H2D_TIME, omp_get_wtime() - tacc);
 #endif
+    }
+    get_met_prefetch(ctl, metbase, (*met1)->time + ctl->dt_met, 1);
   }
 
   /* Read new data for backward trajectories... */
@@ -1641,12 +1925,18 @@ void get_met(
     *met1 = *met0;
     *met0 = mets;
     get_met_help(t, -1, metbase, ctl->dt_met, filename);
-    if (!read_met(ctl, filename, *met0))
-      ERRMSG("Cannot open file!");
+    if (!get_met_prefetch_swap(filename, met0)) {
+      if (!read_met(ctl, filename, *met0))
+	ERRMSG("Cannot open file!");
 #ifdef _OPENACC
-    met_t *met0up = *met0;
+      met_t *met0up = *met0;
+      double tacc = omp_get_wtime();
 #pragma acc update device(met0up[:1])
+      counter(COUNTER_H2D_BYTES, (double) sizeof(met_t));
+      counter(COUNTER_H2D_TIME, omp_get_wtime() - tacc);
 #endif
+    }
+    get_met_prefetch(ctl, metbase, (*met0)->time - ctl->dt_met, -1);
   }
 
   /* Check that grids are consistent... */
@@ -1662,6 +1952,12 @@ void get_met(
   for (ip = 0; ip < (*met0)->np; ip++)
     if ((*met0)->p[ip] != (*met1)->p[ip])
       ERRMSG("Meteo grid pressure levels do not match!");
+
+#ifdef _OPENACC
+  /* Update prefetched met_t on the GPU while the modules are running
+     (the fields are in managed memory and migrate on first access)... */
+  get_met_prefetch_swap("", NULL);
+#endif
 }
 
 /*****************************************************************************/
@@ -1702,6 +1998,123 @@ void get_met_help(
 
 /*****************************************************************************/
 
+/*! State of the meteo prefetch thread. */
+static struct {
+  pthread_t thread;
+  ctl_t ctl;
+  met_t *met;
+  char filename[LEN];
+  int active, done, device, status;
+} met_prefetch;
+
+static void *get_met_prefetch_read(
+  void *arg) {
+
+  /* Read and preprocess data... */
+  met_prefetch.status =
+    read_met(&met_prefetch.ctl, met_prefetch.filename, met_prefetch.met);
+
+  /* Signal completion... */
+#pragma omp atomic write
+  met_prefetch.done = 1;
+
+  return arg;
+}
+
+/*****************************************************************************/
+
+void get_met_prefetch(
+  ctl_t * ctl,
+  char *metbase,
+  double t,
+  int direct) {
+
+  /* Check if prefetching is enabled... */
+  if (!ctl->met_prefetch || met_prefetch.active)
+    return;
+
+  /* Allocate buffer... */
+  if (!met_prefetch.met) {
+    ALLOC(met_prefetch.met, met_t, 1);
+#ifdef _OPENACC
+    met_t *metp = met_prefetch.met;
+#pragma acc enter data create(metp[:1])
+#endif
+  }
+
+  /* Start reader thread... */
+  get_met_help(t, direct, metbase, ctl->dt_met, met_prefetch.filename);
+  memcpy(&met_prefetch.ctl, ctl, sizeof(ctl_t));
+  met_prefetch.done = 0;
+  met_prefetch.device = 0;
+  met_prefetch.active = 1;
+  if (pthread_create(&met_prefetch.thread, NULL, get_met_prefetch_read, NULL)
+      != 0)
+    ERRMSG("Cannot create prefetch thread!");
+}
+
+/*****************************************************************************/
+
+int get_met_prefetch_swap(
+  char *filename,
+  met_t ** met) {
+
+  met_t *mets;
+
+  int done;
+
+  /* Check for active prefetch... */
+  if (!met_prefetch.active)
+    return 0;
+
+  /* Only update finished data on the GPU (met_t only)... */
+  if (met == NULL && filename != NULL) {
+#pragma omp atomic read
+    done = met_prefetch.done;
+    if (done && !met_prefetch.device) {
+#ifdef _OPENACC
+      met_t *metp = met_prefetch.met;
+#pragma acc update device(metp[:1]) async(1)
+      counter(COUNTER_H2D_BYTES, (double) sizeof(met_t));
+#endif
+      met_prefetch.device = 1;
+    }
+    return 0;
+  }
+
+  /* Wait for reader thread... */
+  if (pthread_join(met_prefetch.thread, NULL) != 0)
+    ERRMSG("Cannot join prefetch thread!");
+  met_prefetch.active = 0;
+
+  /* Check data... */
+  if (met == NULL || !met_prefetch.status
+      || strcmp(filename, met_prefetch.filename) != 0)
+    return 0;
+
+  /* Update met_t on the GPU (fields migrate on first access)... */
+#ifdef _OPENACC
+  met_t *metp = met_prefetch.met;
+  double tacc = omp_get_wtime();
+  if (met_prefetch.device) {
+#pragma acc wait(1)
+  } else {
+#pragma acc update device(metp[:1])
+    counter(COUNTER_H2D_BYTES, (double) sizeof(met_t));
+  }
+  counter(COUNTER_H2D_TIME, omp_get_wtime() - tacc);
+#endif
+
+  /* Swap buffers... */
+  mets = *met;
+  *met = met_prefetch.met;
+  met_prefetch.met = mets;
+
+  return 1;
+}
+
+/*****************************************************************************/
+
 void get_met_replace(
   char *orig,
   char *search,
@@ -1725,9 +2138,69 @@ void get_met_replace(
 
 /*****************************************************************************/
 
+void get_met_reset(
+  void) {
+
+  met_init = 1;
+}
+
+/*****************************************************************************/
+
+void intpol_met_cache(
+  cache_t * cache,
+  met_t * met,
+  int ip,
+  double p,
+  double lon,
+  double lat,
+  int *ci,
+  double *cw) {
+
+  /* Use cached indices and weights if the parcel has not moved... */
+  if (cache->ci && cache->cx[3 * ip] == p && cache->cx[3 * ip + 1] == lon
+      && cache->cx[3 * ip + 2] == lat) {
+    for (int i = 0; i < 3; i++) {
+      ci[i] = cache->ci[3 * ip + i];
+      cw[i] = cache->cw[3 * ip + i];
+    }
+    return;
+  }
+
+  /* Save position... */
+  if (cache->ci) {
+    cache->cx[3 * ip] = p;
+    cache->cx[3 * ip + 1] = lon;
+    cache->cx[3 * ip + 2] = lat;
+  }
+
+  /* Check longitude... */
+  if (met->lon[met->nx - 1] > 180 && lon < 0)
+    lon += 360;
+
+  /* Get interpolation indices and weights... */
+  ci[0] = locate_met_p(met, p);
+  ci[1] = locate_reg(met->lon, met->nx, lon);
+  ci[2] = locate_reg(met->lat, met->ny, lat);
+  cw[0] = (met->p[ci[0] + 1] - p)
+    / (met->p[ci[0] + 1] - met->p[ci[0]]);
+  cw[1] = (met->lon[ci[1] + 1] - lon)
+    / (met->lon[ci[1] + 1] - met->lon[ci[1]]);
+  cw[2] = (met->lat[ci[2] + 1] - lat)
+    / (met->lat[ci[2] + 1] - met->lat[ci[2]]);
+
+  /* Save indices and weights... */
+  if (cache->ci)
+    for (int i = 0; i < 3; i++) {
+      cache->ci[3 * ip + i] = ci[i];
+      cache->cw[3 * ip + i] = cw[i];
+    }
+}
+
+/*****************************************************************************/
+
 void intpol_met_space_3d(
   met_t * met,
-  float array[EX][EY][EP],
+  float *array,
   double p,
   double lon,
   double lat,
@@ -1742,7 +2215,7 @@ void intpol_met_space_3d(
 
   /* Get interpolation indices and weights... */
   if (init) {
-    ci[0] = locate_irr(met->p, met->np, p);
+    ci[0] = locate_met_p(met, p);
     ci[1] = locate_reg(met->lon, met->nx, lon);
     ci[2] = locate_reg(met->lat, met->ny, lat);
     cw[0] = (met->p[ci[0] + 1] - p)
@@ -1755,20 +2228,22 @@ void intpol_met_space_3d(
 
   /* Interpolate vertically... */
   double aux00 =
-    cw[0] * (array[ci[1]][ci[2]][ci[0]] - array[ci[1]][ci[2]][ci[0] + 1])
-    + array[ci[1]][ci[2]][ci[0] + 1];
+    cw[0] * (array[ARRAY_3D(ci[1], ci[2], met->ey, ci[0], met->ep)]
+	     - array[ARRAY_3D(ci[1], ci[2], met->ey, ci[0] + 1, met->ep)])
+    + array[ARRAY_3D(ci[1], ci[2], met->ey, ci[0] + 1, met->ep)];
   double aux01 =
-    cw[0] * (array[ci[1]][ci[2] + 1][ci[0]] -
-	     array[ci[1]][ci[2] + 1][ci[0] + 1])
-    + array[ci[1]][ci[2] + 1][ci[0] + 1];
+    cw[0] * (array[ARRAY_3D(ci[1], ci[2] + 1, met->ey, ci[0], met->ep)] -
+	     array[ARRAY_3D(ci[1], ci[2] + 1, met->ey, ci[0] + 1, met->ep)])
+    + array[ARRAY_3D(ci[1], ci[2] + 1, met->ey, ci[0] + 1, met->ep)];
   double aux10 =
-    cw[0] * (array[ci[1] + 1][ci[2]][ci[0]] -
-	     array[ci[1] + 1][ci[2]][ci[0] + 1])
-    + array[ci[1] + 1][ci[2]][ci[0] + 1];
+    cw[0] * (array[ARRAY_3D(ci[1] + 1, ci[2], met->ey, ci[0], met->ep)] -
+	     array[ARRAY_3D(ci[1] + 1, ci[2], met->ey, ci[0] + 1, met->ep)])
+    + array[ARRAY_3D(ci[1] + 1, ci[2], met->ey, ci[0] + 1, met->ep)];
   double aux11 =
-    cw[0] * (array[ci[1] + 1][ci[2] + 1][ci[0]] -
-	     array[ci[1] + 1][ci[2] + 1][ci[0] + 1])
-    + array[ci[1] + 1][ci[2] + 1][ci[0] + 1];
+    cw[0] * (array[ARRAY_3D(ci[1] + 1, ci[2] + 1, met->ey, ci[0], met->ep)] -
+	     array[ARRAY_3D(ci[1] + 1, ci[2] + 1, met->ey, ci[0] + 1,
+			    met->ep)])
+    + array[ARRAY_3D(ci[1] + 1, ci[2] + 1, met->ey, ci[0] + 1, met->ep)];
 
   /* Interpolate horizontally... */
   aux00 = cw[2] * (aux00 - aux01) + aux01;
@@ -1781,7 +2256,7 @@ void intpol_met_space_3d(
 
 void intpol_met_space_2d(
   met_t * met,
-  float array[EX][EY],
+  float *array,
   double lon,
   double lat,
   double *var,
@@ -1804,10 +2279,10 @@ void intpol_met_space_2d(
   }
 
   /* Set variables... */
-  double aux00 = array[ci[1]][ci[2]];
-  double aux01 = array[ci[1]][ci[2] + 1];
-  double aux10 = array[ci[1] + 1][ci[2]];
-  double aux11 = array[ci[1] + 1][ci[2] + 1];
+  double aux00 = array[ARRAY_2D(ci[1], ci[2], met->ey)];
+  double aux01 = array[ARRAY_2D(ci[1], ci[2] + 1, met->ey)];
+  double aux10 = array[ARRAY_2D(ci[1] + 1, ci[2], met->ey)];
+  double aux11 = array[ARRAY_2D(ci[1] + 1, ci[2] + 1, met->ey)];
 
   /* Interpolate horizontally... */
   if (check_finite(aux00) && check_finite(aux01))
@@ -1832,9 +2307,9 @@ void intpol_met_space_2d(
 
 void intpol_met_time_3d(
   met_t * met0,
-  float array0[EX][EY][EP],
+  float *array0,
   met_t * met1,
-  float array1[EX][EY][EP],
+  float *array1,
   double ts,
   double p,
   double lon,
@@ -1846,9 +2321,9 @@ void intpol_met_time_3d(
 
   double var0, var1, wt;
 
-  /* Spatial interpolation... */
+  /* Spatial interpolation (grids of met0 and met1 are the same)... */
   intpol_met_space_3d(met0, array0, p, lon, lat, &var0, ci, cw, init);
-  intpol_met_space_3d(met1, array1, p, lon, lat, &var1, ci, cw, init);
+  intpol_met_space_3d(met1, array1, p, lon, lat, &var1, ci, cw, 0);
 
   /* Get weighting factor... */
   wt = (met1->time - ts) / (met1->time - met0->time);
@@ -1861,9 +2336,9 @@ void intpol_met_time_3d(
 
 void intpol_met_time_2d(
   met_t * met0,
-  float array0[EX][EY],
+  float *array0,
   met_t * met1,
-  float array1[EX][EY],
+  float *array1,
   double ts,
   double lon,
   double lat,
@@ -1874,9 +2349,9 @@ void intpol_met_time_2d(
 
   double var0, var1, wt;
 
-  /* Spatial interpolation... */
+  /* Spatial interpolation (grids of met0 and met1 are the same)... */
   intpol_met_space_2d(met0, array0, lon, lat, &var0, ci, cw, init);
-  intpol_met_space_2d(met1, array1, lon, lat, &var1, ci, cw, init);
+  intpol_met_space_2d(met1, array1, lon, lat, &var1, ci, cw, 0);
 
   /* Get weighting factor... */
   wt = (met1->time - ts) / (met1->time - met0->time);
@@ -1887,6 +2362,122 @@ void intpol_met_time_2d(
 
 /*****************************************************************************/
 
+void intpol_met_space_uvw(
+  met_t * met,
+  double p,
+  double lon,
+  double lat,
+  double *u,
+  double *v,
+  double *w,
+  int *ci,
+  double *cw,
+  int init) {
+
+  double var[3];
+
+  /* Check longitude... */
+  if (met->lon[met->nx - 1] > 180 && lon < 0)
+    lon += 360;
+
+  /* Get interpolation indices and weights... */
+  if (init) {
+    ci[0] = locate_met_p(met, p);
+    ci[1] = locate_reg(met->lon, met->nx, lon);
+    ci[2] = locate_reg(met->lat, met->ny, lat);
+    cw[0] = (met->p[ci[0] + 1] - p)
+      / (met->p[ci[0] + 1] - met->p[ci[0]]);
+    cw[1] = (met->lon[ci[1] + 1] - lon)
+      / (met->lon[ci[1] + 1] - met->lon[ci[1]]);
+    cw[2] = (met->lat[ci[2] + 1] - lat)
+      / (met->lat[ci[2] + 1] - met->lat[ci[2]]);
+  }
+
+  /* Get offsets of grid columns... */
+  int i00 = 3 * ARRAY_3D(ci[1], ci[2], met->ey, ci[0], met->ep);
+  int i01 = 3 * ARRAY_3D(ci[1], ci[2] + 1, met->ey, ci[0], met->ep);
+  int i10 = 3 * ARRAY_3D(ci[1] + 1, ci[2], met->ey, ci[0], met->ep);
+  int i11 = 3 * ARRAY_3D(ci[1] + 1, ci[2] + 1, met->ey, ci[0], met->ep);
+
+  /* Loop over wind components... */
+  for (int ic = 0; ic < 3; ic++) {
+
+    /* Get data of grid box corners (lower and upper level)... */
+    float c[8];
+    if (met->uvwh) {
+      short *a = met->uvwh;
+      float o0 = met->uvwo[ci[0]][ic], s0 = met->uvws[ci[0]][ic];
+      float o1 = met->uvwo[ci[0] + 1][ic], s1 = met->uvws[ci[0] + 1][ic];
+      c[0] = o0 + s0 * a[i00 + ic];
+      c[1] = o1 + s1 * a[i00 + 3 + ic];
+      c[2] = o0 + s0 * a[i01 + ic];
+      c[3] = o1 + s1 * a[i01 + 3 + ic];
+      c[4] = o0 + s0 * a[i10 + ic];
+      c[5] = o1 + s1 * a[i10 + 3 + ic];
+      c[6] = o0 + s0 * a[i11 + ic];
+      c[7] = o1 + s1 * a[i11 + 3 + ic];
+    } else {
+      float *a = met->uvw;
+      c[0] = a[i00 + ic];
+      c[1] = a[i00 + 3 + ic];
+      c[2] = a[i01 + ic];
+      c[3] = a[i01 + 3 + ic];
+      c[4] = a[i10 + ic];
+      c[5] = a[i10 + 3 + ic];
+      c[6] = a[i11 + ic];
+      c[7] = a[i11 + 3 + ic];
+    }
+
+    /* Interpolate vertically... */
+    double aux00 = cw[0] * (c[0] - c[1]) + c[1];
+    double aux01 = cw[0] * (c[2] - c[3]) + c[3];
+    double aux10 = cw[0] * (c[4] - c[5]) + c[5];
+    double aux11 = cw[0] * (c[6] - c[7]) + c[7];
+
+    /* Interpolate horizontally... */
+    aux00 = cw[2] * (aux00 - aux01) + aux01;
+    aux11 = cw[2] * (aux10 - aux11) + aux11;
+    var[ic] = cw[1] * (aux00 - aux11) + aux11;
+  }
+
+  /* Set wind components... */
+  *u = var[0];
+  *v = var[1];
+  *w = var[2];
+}
+
+/*****************************************************************************/
+
+void intpol_met_time_uvw(
+  met_t * met0,
+  met_t * met1,
+  double ts,
+  double p,
+  double lon,
+  double lat,
+  double *u,
+  double *v,
+  double *w) {
+
+  double cw[3], u0, u1, v0, v1, w0, w1, wt;
+
+  int ci[3];
+
+  /* Spatial interpolation (grids of met0 and met1 are the same)... */
+  intpol_met_space_uvw(met0, p, lon, lat, &u0, &v0, &w0, ci, cw, 1);
+  intpol_met_space_uvw(met1, p, lon, lat, &u1, &v1, &w1, ci, cw, 0);
+
+  /* Get weighting factor... */
+  wt = (met1->time - ts) / (met1->time - met0->time);
+
+  /* Interpolate... */
+  *u = wt * (u0 - u1) + u1;
+  *v = wt * (v0 - v1) + v1;
+  *w = wt * (w0 - w1) + w1;
+}
+
+/*****************************************************************************/
+
 void jsec2time(
   double jsec,
   int *year,
@@ -1950,6 +2541,25 @@ int locate_irr(
 
 /*****************************************************************************/
 
+int locate_met_p(
+  met_t * met,
+  double p) {
+
+  /* Get start index from lookup table... */
+  double f = (log(p) - met->plut0) * met->plutd;
+  int i = met->plut[f >= 0 ? (f < NPLUT ? (int) f : NPLUT - 1) : 0];
+
+  /* Correct index (same result as locate_irr for descending levels)... */
+  while (i < met->np - 2 && met->p[i + 1] > p)
+    i++;
+  while (i > 0 && met->p[i] <= p)
+    i--;
+
+  return i;
+}
+
+/*****************************************************************************/
+
 int locate_reg(
   double *xx,
   int n,
@@ -1969,102 +2579,1492 @@ int locate_reg(
 
 /*****************************************************************************/
 
-int read_atm(
-  const char *filename,
-  ctl_t * ctl,
-  atm_t * atm) {
+void module_active(
+  atm_t * atm,
+  cache_t * cache,
+  double *dt) {
 
-  FILE *in;
+#ifdef _OPENACC
+  int nact = 0;
+#pragma acc data present(atm,cache,dt) copy(nact)
+#pragma acc parallel loop independent gang vector
+  for (int ip = 0; ip < atm->np; ip++)
+    if (dt[ip] != 0) {
+      int ia;
+#pragma acc atomic capture
+      ia = nact++;
+      cache->iact[ia] = ip;
+    }
+  cache->nact = nact;
+#pragma acc update device(cache[:1])
+#else
+  cache->nact = 0;
+  for (int ip = 0; ip < atm->np; ip++)
+    if (dt[ip] != 0)
+      cache->iact[cache->nact++] = ip;
+#endif
+}
 
-  char line[LEN], *tok;
+/*****************************************************************************/
 
-  double t0;
+void module_advection(
+  ctl_t * ctl,
+  met_t * met0,
+  met_t * met1,
+  atm_t * atm,
+  cache_t * cache,
+  double *dt) {
 
-  int dimid, ip, iq, ncid, varid;
+#ifdef _OPENACC
+#pragma acc data present(ctl,met0,met1,atm,cache,dt)
+#pragma acc parallel loop independent gang vector
+#else
+#pragma omp parallel for default(shared)
+#endif
+  for (int ia = 0; ia < cache->nact; ia++)
+    module_advection_parcel(ctl, met0, met1, atm, dt, cache->iact[ia]);
+}
 
-  size_t nparts;
+/*****************************************************************************/
+
+void module_advection_parcel(
+  ctl_t * ctl,
+  met_t * met0,
+  met_t * met1,
+  atm_t * atm,
+  double *dt,
+  int ip) {
+
+  if (dt[ip] != 0) {
+
+    double dtm, h, t1 = atm->time[ip] + dt[ip], v[3], xm[3];
+
+    int nsub = 1;
+
+    /* Interpolate meteorological data... */
+    intpol_met_time_uvw(met0, met1, atm->time[ip], atm->p[ip],
+			atm->lon[ip], atm->lat[ip], &v[0], &v[1], &v[2]);
+
+    /* Get number of sub-steps from Courant number on the meteo grid... */
+    if (ctl->advect_cfl > 0) {
+      double c = GSL_MAX(fabs(DX2DEG(dt[ip] * v[0] / 1000., atm->lat[ip])
+			      / (met0->lon[1] - met0->lon[0])),
+			 fabs(DY2DEG(dt[ip] * v[1] / 1000.)
+			      / (met0->lat[1] - met0->lat[0])));
+      if (c > ctl->advect_cfl)
+	nsub = (int) GSL_MIN(ceil(c / ctl->advect_cfl), NSUB);
+    }
+    h = dt[ip] / nsub;
+
+    /* Loop over sub-steps... */
+    for (int isub = 0; isub < nsub; isub++) {
+
+      /* Interpolate meteorological data... */
+      if (isub > 0)
+	intpol_met_time_uvw(met0, met1, atm->time[ip], atm->p[ip],
+			    atm->lon[ip], atm->lat[ip], &v[0], &v[1], &v[2]);
+
+      /* Get position of the mid point... */
+      dtm = atm->time[ip] + 0.5 * h;
+      xm[0] = atm->lon[ip] + DX2DEG(0.5 * h * v[0] / 1000., atm->lat[ip]);
+      xm[1] = atm->lat[ip] + DY2DEG(0.5 * h * v[1] / 1000.);
+      xm[2] = atm->p[ip] + 0.5 * h * v[2];
+
+      /* Interpolate meteorological data for mid point... */
+      intpol_met_time_uvw(met0, met1, dtm, xm[2], xm[0], xm[1],
+			  &v[0], &v[1], &v[2]);
+
+      /* Save new position... */
+      atm->time[ip] += h;
+      atm->lon[ip] += DX2DEG(h * v[0] / 1000., xm[1]);
+      atm->lat[ip] += DY2DEG(h * v[1] / 1000.);
+      atm->p[ip] += h * v[2];
+    }
+    atm->time[ip] = t1;
+  }
+}
+
+/*****************************************************************************/
+
+void module_decay(
+  ctl_t * ctl,
+  atm_t * atm,
+  cache_t * cache,
+  double *dt) {
+
+  /* Check quantity flags... */
+  if (ctl->qnt_m < 0)
+    ERRMSG("Module needs quantity mass!");
+
+#ifdef _OPENACC
+#pragma acc data present(ctl,atm,cache,dt)
+#pragma acc parallel loop independent gang vector
+#else
+#pragma omp parallel for default(shared)
+#endif
+  for (int ia = 0; ia < cache->nact; ia++)
+    module_decay_parcel(ctl, atm, dt, cache->iact[ia]);
+}
+
+/*****************************************************************************/
+
+void module_decay_parcel(
+  ctl_t * ctl,
+  atm_t * atm,
+  double *dt,
+  int ip) {
+
+  if (dt[ip] != 0) {
+
+    double p0, p1, pt, tdec, w;
+
+    /* Get tropopause pressure... */
+    pt = clim_tropo(atm->time[ip], atm->lat[ip]);
+
+    /* Get weighting factor... */
+    p1 = pt * 0.866877899;
+    p0 = pt / 0.866877899;
+    if (atm->p[ip] > p0)
+      w = 1;
+    else if (atm->p[ip] < p1)
+      w = 0;
+    else
+      w = LIN(p0, 1.0, p1, 0.0, atm->p[ip]);
+
+    /* Set lifetime... */
+    tdec = w * ctl->tdec_trop + (1 - w) * ctl->tdec_strat;
+
+    /* Calculate exponential decay... */
+    atm->q[ctl->qnt_m][ip] *= exp(-dt[ip] / tdec);
+  }
+}
+
+/*****************************************************************************/
+
+void module_diffusion_meso(
+  ctl_t * ctl,
+  met_t * met0,
+  met_t * met1,
+  atm_t * atm,
+  cache_t * cache,
+  double *dt) {
+
+  /* Update wind standard deviations... */
+  module_diffusion_meso_sig(met0, met1, cache);
+
+#ifdef _OPENACC
+#pragma acc data present(ctl,met0,met1,atm,cache,dt)
+#pragma acc parallel loop independent gang vector
+#else
+#pragma omp parallel for default(shared)
+#endif
+  for (int ia = 0; ia < cache->nact; ia++)
+    module_diffusion_meso_parcel(ctl, met0, atm, cache, dt,
+				 cache->iact[ia]);
+}
+
+/*****************************************************************************/
+
+void module_diffusion_meso_parcel(
+  ctl_t * ctl,
+  met_t * met0,
+  atm_t * atm,
+  cache_t * cache,
+  double *dt,
+  int ip) {
+
+  if (dt[ip] != 0) {
+
+    double rs[4];
+
+    /* Get indices... */
+    int ix = locate_reg(met0->lon, met0->nx, atm->lon[ip]);
+    int iy = locate_reg(met0->lat, met0->ny, atm->lat[ip]);
+    int iz = locate_met_p(met0, atm->p[ip]);
+
+    /* Get random numbers... */
+    random_normal((unsigned int) cache->id[ip],
+		  (unsigned int) ctl->turb_seed, atm->time[ip], 1, rs);
+
+    /* Set temporal correlations for mesoscale fluctuations... */
+    double r = 1 - 2 * fabs(dt[ip]) / ctl->dt_met;
+    double r2 = sqrt(1 - r * r);
+
+    /* Calculate horizontal mesoscale wind fluctuations... */
+    if (ctl->turb_mesox > 0) {
+      cache->up[ip] = (float)
+	(r * cache->up[ip]
+	 + r2 * rs[0] * ctl->turb_mesox
+	 * cache->usig[ARRAY_3D(ix, iy, met0->ny, iz, met0->np)]);
+      atm->lon[ip] += DX2DEG(cache->up[ip] * dt[ip] / 1000., atm->lat[ip]);
+
+      cache->vp[ip] = (float)
+	(r * cache->vp[ip]
+	 + r2 * rs[1] * ctl->turb_mesox
+	 * cache->vsig[ARRAY_3D(ix, iy, met0->ny, iz, met0->np)]);
+      atm->lat[ip] += DY2DEG(cache->vp[ip] * dt[ip] / 1000.);
+    }
+
+    /* Calculate vertical mesoscale wind fluctuations... */
+    if (ctl->turb_mesoz > 0) {
+      cache->wp[ip] = (float)
+	(r * cache->wp[ip]
+	 + r2 * rs[2] * ctl->turb_mesoz
+	 * cache->wsig[ARRAY_3D(ix, iy, met0->ny, iz, met0->np)]);
+      atm->p[ip] += cache->wp[ip] * dt[ip];
+    }
+  }
+}
+
+/*****************************************************************************/
+
+void module_diffusion_meso_sig(
+  met_t * met0,
+  met_t * met1,
+  cache_t * cache) {
+
+  /* Check grid size (cache is allocated for the first meteo data)... */
+  if (met0->nx != cache->ex || met0->ny != cache->ey
+      || met0->np != cache->ep || met1->nx != met0->nx
+      || met1->ny != met0->ny || met1->np != met0->np)
+    ERRMSG("Meteo grid does not match wind standard deviations!");
+
+  /* Check whether data are up to date... */
+  if (cache->tsig == met0->time)
+    return;
+
+  /* Loop over grid boxes... */
+#ifdef _OPENACC
+#pragma acc data present(met0,met1,cache)
+#pragma acc parallel loop independent gang vector collapse(3)
+#else
+#pragma omp parallel for default(shared) collapse(2)
+#endif
+  for (int ix = 0; ix < met0->nx - 1; ix++)
+    for (int iy = 0; iy < met0->ny - 1; iy++)
+      for (int iz = 0; iz < met0->np - 1; iz++) {
+
+	double u[16], v[16], w[16];
+
+	/* Collect local wind data... */
+	for (int i = 0; i < 8; i++) {
+	  int jx = ix + (i & 1), jy = iy + ((i >> 1) & 1), jz = iz + (i >> 2);
+	  u[i] = MET_UVW(met0, jx, jy, jz, 0);
+	  v[i] = MET_UVW(met0, jx, jy, jz, 1);
+	  w[i] = MET_UVW(met0, jx, jy, jz, 2);
+	  u[i + 8] = MET_UVW(met1, jx, jy, jz, 0);
+	  v[i + 8] = MET_UVW(met1, jx, jy, jz, 1);
+	  w[i + 8] = MET_UVW(met1, jx, jy, jz, 2);
+	}
+
+	/* Get standard deviations of local wind data... */
+	cache->usig[ARRAY_3D(ix, iy, met0->ny, iz, met0->np)]
+	  = (float) stddev(u, 16);
+	cache->vsig[ARRAY_3D(ix, iy, met0->ny, iz, met0->np)]
+	  = (float) stddev(v, 16);
+	cache->wsig[ARRAY_3D(ix, iy, met0->ny, iz, met0->np)]
+	  = (float) stddev(w, 16);
+      }
+
+  /* Save time of meteo data... */
+  cache->tsig = met0->time;
+#ifdef _OPENACC
+#pragma acc update device(cache[:1])
+#endif
+}
+
+/*****************************************************************************/
+
+void module_diffusion_turb(
+  ctl_t * ctl,
+  atm_t * atm,
+  cache_t * cache,
+  double *dt) {
+
+#ifdef _OPENACC
+#pragma acc data present(ctl,atm,cache,dt)
+#pragma acc parallel loop independent gang vector
+#else
+#pragma omp parallel for default(shared)
+#endif
+  for (int ia = 0; ia < cache->nact; ia++)
+    module_diffusion_turb_parcel(ctl, atm, cache, dt, cache->iact[ia]);
+}
+
+/*****************************************************************************/
+
+void module_diffusion_turb_parcel(
+  ctl_t * ctl,
+  atm_t * atm,
+  cache_t * cache,
+  double *dt,
+  int ip) {
+
+  if (dt[ip] != 0) {
+
+    double rs[4], w;
+
+    /* Get random numbers... */
+    random_normal((unsigned int) cache->id[ip],
+		  (unsigned int) ctl->turb_seed, atm->time[ip], 0, rs);
+
+    /* Get tropopause pressure... */
+    double pt = clim_tropo(atm->time[ip], atm->lat[ip]);
+
+    /* Get weighting factor... */
+    double p1 = pt * 0.866877899;
+    double p0 = pt / 0.866877899;
+    if (atm->p[ip] > p0)
+      w = 1;
+    else if (atm->p[ip] < p1)
+      w = 0;
+    else
+      w = LIN(p0, 1.0, p1, 0.0, atm->p[ip]);
+
+    /* Set diffusivity... */
+    double dx = w * ctl->turb_dx_trop + (1 - w) * ctl->turb_dx_strat;
+    double dz = w * ctl->turb_dz_trop + (1 - w) * ctl->turb_dz_strat;
+
+    /* Horizontal turbulent diffusion... */
+    if (dx > 0) {
+      double sigma = sqrt(2.0 * dx * fabs(dt[ip]));
+      atm->lon[ip] += DX2DEG(rs[0] * sigma / 1000., atm->lat[ip]);
+      atm->lat[ip] += DY2DEG(rs[1] * sigma / 1000.);
+    }
+
+    /* Vertical turbulent diffusion... */
+    if (dz > 0) {
+      double sigma = sqrt(2.0 * dz * fabs(dt[ip]));
+      atm->p[ip]
+	+= DZ2DP(rs[2] * sigma / 1000., atm->p[ip]);
+    }
+  }
+}
+
+/*****************************************************************************/
+
+void module_isosurf_init(
+  ctl_t * ctl,
+  met_t * met0,
+  met_t * met1,
+  atm_t * atm,
+  cache_t * cache) {
+
+  FILE *in;
+
+  char line[LEN];
+
+  double ps, t, ts, cw[3];
+
+  int ci[3];
+
+  /* Save pressure... */
+  if (ctl->isosurf == 1)
+    for (int ip = 0; ip < atm->np; ip++)
+      cache->iso_var[ip] = atm->p[ip];
+
+  /* Save density... */
+  else if (ctl->isosurf == 2)
+    for (int ip = 0; ip < atm->np; ip++) {
+      intpol_met_time_3d(met0, met0->t, met1, met1->t, atm->time[ip],
+			 atm->p[ip], atm->lon[ip], atm->lat[ip], &t, ci, cw,
+			 1);
+      cache->iso_var[ip] = atm->p[ip] / t;
+    }
+
+  /* Save potential temperature... */
+  else if (ctl->isosurf == 3)
+    for (int ip = 0; ip < atm->np; ip++) {
+      intpol_met_time_3d(met0, met0->t, met1, met1->t, atm->time[ip],
+			 atm->p[ip], atm->lon[ip], atm->lat[ip], &t, ci, cw,
+			 1);
+      cache->iso_var[ip] = THETA(atm->p[ip], t);
+    }
+
+  /* Read balloon pressure data... */
+  else if (ctl->isosurf == 4) {
+
+    /* Write info... */
+    printf("Read balloon pressure data: %s\n", ctl->balloon);
+
+    /* Open file... */
+    if (!(in = fopen(ctl->balloon, "r")))
+      ERRMSG("Cannot open file!");
+
+    /* Read pressure time series... */
+    while (fgets(line, LEN, in))
+      if (sscanf(line, "%lg %lg", &ts, &ps) == 2) {
+	REALLOC(cache->iso_ts, double, cache->iso_n + 1);
+	REALLOC(cache->iso_ps, double, cache->iso_n + 1);
+	cache->iso_ts[cache->iso_n] = ts;
+	cache->iso_ps[cache->iso_n] = ps;
+	cache->iso_n++;
+      }
+
+    /* Check number of points... */
+    if (cache->iso_n < 1)
+      ERRMSG("Could not read any data!");
+
+    /* Close file... */
+    fclose(in);
+  }
+}
+
+/*****************************************************************************/
+
+void module_isosurf(
+  ctl_t * ctl,
+  met_t * met0,
+  met_t * met1,
+  atm_t * atm,
+  cache_t * cache) {
+
+#ifdef _OPENACC
+#pragma acc data present(ctl,met0,met1,atm,cache)
+#pragma acc parallel loop independent gang vector
+#else
+#pragma omp parallel for default(shared)
+#endif
+  for (int ia = 0; ia < cache->nact; ia++)
+    module_isosurf_parcel(ctl, met0, met1, atm, cache, cache->iact[ia]);
+}
+
+/*****************************************************************************/
+
+void module_isosurf_parcel(
+  ctl_t * ctl,
+  met_t * met0,
+  met_t * met1,
+  atm_t * atm,
+  cache_t * cache,
+  int ip) {
+
+
+  double t, cw[3];
+
+  int ci[3];
+
+  /* Restore pressure... */
+  if (ctl->isosurf == 1)
+    atm->p[ip] = cache->iso_var[ip];
+
+  /* Restore density... */
+  else if (ctl->isosurf == 2) {
+    intpol_met_cache(cache, met0, ip, atm->p[ip], atm->lon[ip], atm->lat[ip],
+		     ci, cw);
+    intpol_met_time_3d(met0, met0->t, met1, met1->t, atm->time[ip],
+		       atm->p[ip], atm->lon[ip], atm->lat[ip], &t, ci, cw,
+		       0);
+    atm->p[ip] = cache->iso_var[ip] * t;
+  }
+
+  /* Restore potential temperature... */
+  else if (ctl->isosurf == 3) {
+    intpol_met_cache(cache, met0, ip, atm->p[ip], atm->lon[ip], atm->lat[ip],
+		     ci, cw);
+    intpol_met_time_3d(met0, met0->t, met1, met1->t, atm->time[ip],
+		       atm->p[ip], atm->lon[ip], atm->lat[ip], &t, ci, cw,
+		       0);
+    atm->p[ip] = 1000. * pow(cache->iso_var[ip] / t, -1. / 0.286);
+  }
+
+  /* Interpolate pressure... */
+  else if (ctl->isosurf == 4) {
+    if (atm->time[ip] <= cache->iso_ts[0])
+      atm->p[ip] = cache->iso_ps[0];
+    else if (atm->time[ip] >= cache->iso_ts[cache->iso_n - 1])
+      atm->p[ip] = cache->iso_ps[cache->iso_n - 1];
+    else {
+      int idx = locate_irr(cache->iso_ts, cache->iso_n, atm->time[ip]);
+      atm->p[ip] = LIN(cache->iso_ts[idx], cache->iso_ps[idx],
+		       cache->iso_ts[idx + 1], cache->iso_ps[idx + 1],
+		       atm->time[ip]);
+    }
+  }
+}
+
+/*****************************************************************************/
+
+void module_meteo(
+  ctl_t * ctl,
+  met_t * met0,
+  met_t * met1,
+  atm_t * atm,
+  cache_t * cache) {
+
+  /* Check quantity flags... */
+  if (ctl->qnt_tsts >= 0)
+    if (ctl->qnt_tice < 0 || ctl->qnt_tnat < 0)
+      ERRMSG("Need T_ice and T_NAT to calculate T_STS!");
+
+#ifdef _OPENACC
+#pragma acc data present(ctl,met0,met1,atm,cache)
+#pragma acc parallel loop independent gang vector
+#else
+#pragma omp parallel for default(shared)
+#endif
+  for (int ip = 0; ip < atm->np; ip++) {
+
+    double ps, pt, pc, pv, t, u, v, w, h2o, o3, lwc, iwc, z, cw[3];
+
+    int ci[3];
+
+    /* Interpolate meteorological data... */
+    intpol_met_cache(cache, met0, ip, atm->p[ip], atm->lon[ip], atm->lat[ip],
+		     ci, cw);
+    intpol_met_time_3d(met0, met0->z, met1, met1->z, atm->time[ip],
+		       atm->p[ip], atm->lon[ip], atm->lat[ip], &z, ci, cw, 0);
+    intpol_met_time_3d(met0, met0->t, met1, met1->t, atm->time[ip],
+		       atm->p[ip], atm->lon[ip], atm->lat[ip], &t, ci, cw, 0);
+    intpol_met_time_uvw(met0, met1, atm->time[ip], atm->p[ip],
+			atm->lon[ip], atm->lat[ip], &u, &v, &w);
+    intpol_met_time_3d(met0, met0->pv, met1, met1->pv, atm->time[ip],
+		       atm->p[ip], atm->lon[ip], atm->lat[ip], &pv, ci, cw,
+		       0);
+    intpol_met_time_3d(met0, met0->h2o, met1, met1->h2o, atm->time[ip],
+		       atm->p[ip], atm->lon[ip], atm->lat[ip], &h2o, ci, cw,
+		       0);
+    intpol_met_time_3d(met0, met0->o3, met1, met1->o3, atm->time[ip],
+		       atm->p[ip], atm->lon[ip], atm->lat[ip], &o3, ci, cw,
+		       0);
+    intpol_met_time_3d(met0, met0->lwc, met1, met1->lwc, atm->time[ip],
+		       atm->p[ip], atm->lon[ip], atm->lat[ip], &lwc, ci, cw,
+		       0);
+    intpol_met_time_3d(met0, met0->iwc, met1, met1->iwc, atm->time[ip],
+		       atm->p[ip], atm->lon[ip], atm->lat[ip], &iwc, ci, cw,
+		       0);
+    intpol_met_time_2d(met0, met0->ps, met1, met1->ps, atm->time[ip],
+		       atm->lon[ip], atm->lat[ip], &ps, ci, cw, 0);
+    intpol_met_time_2d(met0, met0->pt, met1, met1->pt, atm->time[ip],
+		       atm->lon[ip], atm->lat[ip], &pt, ci, cw, 0);
+    intpol_met_time_2d(met0, met0->pc, met1, met1->pc, atm->time[ip],
+		       atm->lon[ip], atm->lat[ip], &pc, ci, cw, 0);
+
+    /* Set surface pressure... */
+    if (ctl->qnt_ps >= 0)
+      atm->q[ctl->qnt_ps][ip] = ps;
+
+    /* Set tropopause pressure... */
+    if (ctl->qnt_pt >= 0)
+      atm->q[ctl->qnt_pt][ip] = pt;
+
+    /* Set pressure... */
+    if (ctl->qnt_p >= 0)
+      atm->q[ctl->qnt_p][ip] = atm->p[ip];
+
+    /* Set geopotential height... */
+    if (ctl->qnt_z >= 0)
+      atm->q[ctl->qnt_z][ip] = z;
+
+    /* Set temperature... */
+    if (ctl->qnt_t >= 0)
+      atm->q[ctl->qnt_t][ip] = t;
+
+    /* Set zonal wind... */
+    if (ctl->qnt_u >= 0)
+      atm->q[ctl->qnt_u][ip] = u;
+
+    /* Set meridional wind... */
+    if (ctl->qnt_v >= 0)
+      atm->q[ctl->qnt_v][ip] = v;
+
+    /* Set vertical velocity... */
+    if (ctl->qnt_w >= 0)
+      atm->q[ctl->qnt_w][ip] = w;
+
+    /* Set water vapor vmr... */
+    if (ctl->qnt_h2o >= 0)
+      atm->q[ctl->qnt_h2o][ip] = h2o;
+
+    /* Set ozone vmr... */
+    if (ctl->qnt_o3 >= 0)
+      atm->q[ctl->qnt_o3][ip] = o3;
+
+    /* Set cloud liquid water content... */
+    if (ctl->qnt_lwc >= 0)
+      atm->q[ctl->qnt_lwc][ip] = lwc;
+
+    /* Set cloud ice water content... */
+    if (ctl->qnt_iwc >= 0)
+      atm->q[ctl->qnt_iwc][ip] = iwc;
+
+    /* Set cloud top pressure... */
+    if (ctl->qnt_pc >= 0)
+      atm->q[ctl->qnt_pc][ip] = pc;
+
+    /* Set nitric acid vmr... */
+    if (ctl->qnt_hno3 >= 0)
+      atm->q[ctl->qnt_hno3][ip] =
+	clim_hno3(atm->time[ip], atm->lat[ip], atm->p[ip]);
+
+    /* Set hydroxyl number concentration... */
+    if (ctl->qnt_oh >= 0)
+      atm->q[ctl->qnt_oh][ip] =
+	clim_oh(atm->time[ip], atm->lat[ip], atm->p[ip]);
+
+    /* Calculate horizontal wind... */
+    if (ctl->qnt_vh >= 0)
+      atm->q[ctl->qnt_vh][ip] = sqrt(u * u + v * v);
+
+    /* Calculate vertical velocity... */
+    if (ctl->qnt_vz >= 0)
+      atm->q[ctl->qnt_vz][ip] = -1e3 * H0 / atm->p[ip] * w;
+
+    /* Calculate relative humidty... */
+    if (ctl->qnt_rh >= 0)
+      atm->q[ctl->qnt_rh][ip] = RH(atm->p[ip], t, h2o);
+
+    /* Calculate potential temperature... */
+    if (ctl->qnt_theta >= 0)
+      atm->q[ctl->qnt_theta][ip] = THETA(atm->p[ip], t);
+
+    /* Set potential vorticity... */
+    if (ctl->qnt_pv >= 0)
+      atm->q[ctl->qnt_pv][ip] = pv;
+
+    /* Calculate T_ice (Marti and Mauersberger, 1993)... */
+    if (ctl->qnt_tice >= 0)
+      atm->q[ctl->qnt_tice][ip] =
+	-2663.5 /
+	(log10((ctl->psc_h2o > 0 ? ctl->psc_h2o : h2o) * atm->p[ip] * 100.) -
+	 12.537);
+
+    /* Calculate T_NAT (Hanson and Mauersberger, 1988)... */
+    if (ctl->qnt_tnat >= 0) {
+      double p_hno3;
+      if (ctl->psc_hno3 > 0)
+	p_hno3 = ctl->psc_hno3 * atm->p[ip] / 1.333224;
+      else
+	p_hno3 = clim_hno3(atm->time[ip], atm->lat[ip], atm->p[ip])
+	  * 1e-9 * atm->p[ip] / 1.333224;
+      double p_h2o =
+	(ctl->psc_h2o > 0 ? ctl->psc_h2o : h2o) * atm->p[ip] / 1.333224;
+      double a = 0.009179 - 0.00088 * log10(p_h2o);
+      double b = (38.9855 - log10(p_hno3) - 2.7836 * log10(p_h2o)) / a;
+      double c = -11397.0 / a;
+      double x1 = (-b + sqrt(b * b - 4. * c)) / 2.;
+      double x2 = (-b - sqrt(b * b - 4. * c)) / 2.;
+      if (x1 > 0)
+	atm->q[ctl->qnt_tnat][ip] = x1;
+      if (x2 > 0)
+	atm->q[ctl->qnt_tnat][ip] = x2;
+    }
+
+    /* Calculate T_STS (mean of T_ice and T_NAT)... */
+    if (ctl->qnt_tsts >= 0)
+      atm->q[ctl->qnt_tsts][ip] = 0.5 * (atm->q[ctl->qnt_tice][ip]
+					 + atm->q[ctl->qnt_tnat][ip]);
+  }
+}
+
+/*****************************************************************************/
+
+void module_meteo_fields(
+  ctl_t * ctl) {
+
+  /* Check wet deposition... */
+  int wet_depo = (ctl->wet_depo[0] > 0 && ctl->wet_depo[1] > 0
+		  && ctl->wet_depo[2] > 0 && ctl->wet_depo[3] > 0);
+
+  /* Check tropopause... */
+  if (ctl->qnt_pt < 0)
+    ctl->met_tropo = 0;
+
+  /* Check derived fields... */
+  ctl->met_z = (ctl->qnt_z >= 0);
+  ctl->met_pv = (ctl->qnt_pv >= 0 || ctl->met_tropo == 5);
+  ctl->met_cloud = (ctl->qnt_lwc >= 0 || ctl->qnt_iwc >= 0
+		    || ctl->qnt_pc >= 0 || wet_depo);
+
+  /* Check input fields... */
+  ctl->met_h2o = (ctl->qnt_h2o >= 0 || ctl->qnt_rh >= 0
+		  || ctl->qnt_tice >= 0 || ctl->qnt_tnat >= 0
+		  || ctl->qnt_tsts >= 0 || ctl->prof_basename[0] != '-'
+		  || ctl->met_z);
+  ctl->met_o3 = (ctl->qnt_o3 >= 0 || ctl->prof_basename[0] != '-');
+}
+
+/*****************************************************************************/
+
+void module_position(
+  met_t * met0,
+  met_t * met1,
+  atm_t * atm,
+  cache_t * cache,
+  double *dt) {
+
+#ifdef _OPENACC
+#pragma acc data present(met0,met1,atm,cache,dt)
+#pragma acc parallel loop independent gang vector
+#else
+#pragma omp parallel for default(shared)
+#endif
+  for (int ia = 0; ia < cache->nact; ia++)
+    module_position_parcel(met0, met1, atm, cache, dt, cache->iact[ia]);
+}
+
+/*****************************************************************************/
+
+void module_position_parcel(
+  met_t * met0,
+  met_t * met1,
+  atm_t * atm,
+  cache_t * cache,
+  double *dt,
+  int ip) {
+
+  if (dt[ip] != 0) {
+
+    double ps, cw[3];
+
+    int ci[3];
+
+    /* Calculate modulo... */
+    atm->lon[ip] = FMOD(atm->lon[ip], 360.);
+    atm->lat[ip] = FMOD(atm->lat[ip], 360.);
+
+    /* Check latitude... */
+    while (atm->lat[ip] < -90 || atm->lat[ip] > 90) {
+      if (atm->lat[ip] > 90) {
+	atm->lat[ip] = 180 - atm->lat[ip];
+	atm->lon[ip] += 180;
+      }
+      if (atm->lat[ip] < -90) {
+	atm->lat[ip] = -180 - atm->lat[ip];
+	atm->lon[ip] += 180;
+      }
+    }
+
+    /* Check longitude... */
+    while (atm->lon[ip] < -180)
+      atm->lon[ip] += 360;
+    while (atm->lon[ip] >= 180)
+      atm->lon[ip] -= 360;
+
+    /* Check pressure... */
+    if (atm->p[ip] < met0->p[met0->np - 1])
+      atm->p[ip] = met0->p[met0->np - 1];
+    else if (atm->p[ip] > 300.) {
+      intpol_met_cache(cache, met0, ip, atm->p[ip], atm->lon[ip],
+		       atm->lat[ip], ci, cw);
+      intpol_met_time_2d(met0, met0->ps, met1, met1->ps, atm->time[ip],
+			 atm->lon[ip], atm->lat[ip], &ps, ci, cw, 0);
+      if (atm->p[ip] > ps)
+	atm->p[ip] = ps;
+    }
+  }
+}
+
+/*****************************************************************************/
+
+void module_sedi(
+  ctl_t * ctl,
+  met_t * met0,
+  met_t * met1,
+  atm_t * atm,
+  cache_t * cache,
+  double *dt) {
+
+#ifdef _OPENACC
+#pragma acc data present(ctl,met0,met1,atm,cache,dt)
+#pragma acc parallel loop independent gang vector
+#else
+#pragma omp parallel for default(shared)
+#endif
+  for (int ia = 0; ia < cache->nact; ia++)
+    module_sedi_parcel(ctl, met0, met1, atm, cache, dt, cache->iact[ia]);
+}
 
-  /* Init... */
-  atm->np = 0;
+/*****************************************************************************/
 
-  /* Write info... */
-  printf("Read atmospheric data: %s\n", filename);
+void module_sedi_parcel(
+  ctl_t * ctl,
+  met_t * met0,
+  met_t * met1,
+  atm_t * atm,
+  cache_t * cache,
+  double *dt,
+  int ip) {
 
-  /* Read ASCII data... */
-  if (ctl->atm_type == 0) {
+  if (dt[ip] != 0) {
 
-    /* Open file... */
-    if (!(in = fopen(filename, "r"))) {
-      WARN("File not found!");
+    double G, K, eta, lambda, p, r_p, rho, rho_p, T, v, v_p, cw[3];
+
+    int ci[3];
+
+    /* Convert units... */
+    p = 100. * atm->p[ip];
+    r_p = 1e-6 * atm->q[ctl->qnt_r][ip];
+    rho_p = atm->q[ctl->qnt_rho][ip];
+
+    /* Get temperature... */
+    intpol_met_cache(cache, met0, ip, atm->p[ip], atm->lon[ip], atm->lat[ip],
+		     ci, cw);
+    intpol_met_time_3d(met0, met0->t, met1, met1->t, atm->time[ip],
+		       atm->p[ip], atm->lon[ip], atm->lat[ip], &T, ci, cw,
+		       0);
+
+    /* Density of dry air... */
+    rho = p / (RA * T);
+
+    /* Dynamic viscosity of air... */
+    eta = 1.8325e-5 * (416.16 / (T + 120.)) * pow(T / 296.16, 1.5);
+
+    /* Thermal velocity of an air molecule... */
+    v = sqrt(8. * KB * T / (M_PI * 4.8096e-26));
+
+    /* Mean free path of an air molecule... */
+    lambda = 2. * eta / (rho * v);
+
+    /* Knudsen number for air... */
+    K = lambda / r_p;
+
+    /* Cunningham slip-flow correction... */
+    G = 1. + K * (1.249 + 0.42 * exp(-0.87 / K));
+
+    /* Sedimentation (fall) velocity... */
+    v_p = 2. * SQR(r_p) * (rho_p - rho) * G0 / (9. * eta) * G;
+
+    /* Calculate pressure change... */
+    atm->p[ip] += DZ2DP(v_p * dt[ip] / 1000., atm->p[ip]);
+  }
+}
+
+/*****************************************************************************/
+
+void module_sort(
+  ctl_t * ctl,
+  met_t * met0,
+  atm_t * atm,
+  cache_t * cache) {
+
+  double *help;
+
+  size_t *perm;
+
+  unsigned long *key;
+
+  /* Allocate... */
+  ALLOC(help, double,
+	atm->np);
+  ALLOC(perm, size_t,
+	atm->np);
+  ALLOC(key, unsigned long,
+	atm->np);
+
+  /* Get Morton keys of grid boxes... */
+#ifdef _OPENACC
+  int dev = acc_is_present(atm, sizeof(atm_t));
+#pragma acc parallel loop independent gang vector present(met0,atm) copyout(key[0:atm->np]) if(dev)
+#else
+#pragma omp parallel for default(shared)
+#endif
+  for (int ip = 0; ip < atm->np; ip++) {
+    unsigned long ix = (unsigned long)
+      locate_reg(met0->lon, met0->nx, atm->lon[ip]);
+    unsigned long iy = (unsigned long)
+      locate_reg(met0->lat, met0->ny, atm->lat[ip]);
+    unsigned long iz = (unsigned long)
+      locate_irr(met0->p, met0->np, atm->p[ip]);
+    key[ip] = 0;
+    for (int ib = 0; ib < 21; ib++)
+      key[ip] |= (((ix >> ib) & 1UL) << (3 * ib))
+	| (((iy >> ib) & 1UL) << (3 * ib + 1))
+	| (((iz >> ib) & 1UL) << (3 * ib + 2));
+  }
+
+  /* Get permutation (on the host, only keys and indices are
+     transferred)... */
+  gsl_sort_ulong_index(perm, key, 1, (size_t) atm->np);
+
+  /* Reorder air parcel data... */
+#ifdef _OPENACC
+#define SORT_LOOP \
+  _Pragma("acc parallel loop independent gang vector present(atm,cache,help,perm) if(dev)")
+#else
+#define SORT_LOOP _Pragma("omp parallel for default(shared)")
+#endif
+#define SORT_ARRAY(x, type) {				\
+    SORT_LOOP						\
+    for (int ip = 0; ip < atm->np; ip++)		\
+      help[ip] = (x)[perm[ip]];				\
+    SORT_LOOP						\
+    for (int ip = 0; ip < atm->np; ip++)		\
+      (x)[ip] = (type) help[ip];			\
+  }
+#ifdef _OPENACC
+#pragma acc data create(help[0:atm->np]) copyin(perm[0:atm->np]) if(dev)
+#endif
+  {
+    SORT_ARRAY(atm->time, double);
+    SORT_ARRAY(atm->p, double);
+    SORT_ARRAY(atm->lon, double);
+    SORT_ARRAY(atm->lat, double);
+    for (int iq = 0; iq < ctl->nq; iq++)
+      SORT_ARRAY(atm->q[iq], double);
+    SORT_ARRAY(cache->id, int);
+    SORT_ARRAY(cache->up, float);
+    SORT_ARRAY(cache->vp, float);
+    SORT_ARRAY(cache->wp, float);
+    SORT_ARRAY(cache->iso_var, double);
+  }
+#undef SORT_ARRAY
+#undef SORT_LOOP
+
+  /* Free... */
+  free(help);
+  free(perm);
+  free(key);
+}
+
+/*****************************************************************************/
+
+void module_step(
+  ctl_t * ctl,
+  met_t * met0,
+  met_t * met1,
+  atm_t * atm,
+  cache_t * cache,
+  double *dt) {
+
+  /* Check enabled modules... */
+  int turb = (ctl->turb_dx_trop > 0 || ctl->turb_dz_trop > 0
+	      || ctl->turb_dx_strat > 0 || ctl->turb_dz_strat > 0);
+  int meso = (ctl->turb_mesox > 0 || ctl->turb_mesoz > 0);
+  int sedi = (ctl->qnt_r >= 0 && ctl->qnt_rho >= 0);
+  int isosurf = (ctl->isosurf >= 1 && ctl->isosurf <= 4);
+
+  /* Update wind standard deviations... */
+  if (meso)
+    module_diffusion_meso_sig(met0, met1, cache);
+
+  /* Apply modules to each air parcel... */
+#ifdef _OPENACC
+#pragma acc data present(ctl,met0,met1,atm,cache,dt)
+#pragma acc parallel loop independent gang vector
+#else
+#pragma omp parallel for default(shared)
+#endif
+  for (int ia = 0; ia < cache->nact; ia++) {
+    int ip = cache->iact[ia];
+    module_position_parcel(met0, met1, atm, cache, dt, ip);
+    module_advection_parcel(ctl, met0, met1, atm, dt, ip);
+    if (turb)
+      module_diffusion_turb_parcel(ctl, atm, cache, dt, ip);
+    if (meso)
+      module_diffusion_meso_parcel(ctl, met0, atm, cache, dt, ip);
+    if (sedi)
+      module_sedi_parcel(ctl, met0, met1, atm, cache, dt, ip);
+    if (isosurf)
+      module_isosurf_parcel(ctl, met0, met1, atm, cache, ip);
+    module_position_parcel(met0, met1, atm, cache, dt, ip);
+  }
+}
+
+/*****************************************************************************/
+
+void module_oh_chem(
+  ctl_t * ctl,
+  met_t * met0,
+  met_t * met1,
+  atm_t * atm,
+  cache_t * cache,
+  double *dt) {
+
+  /* Check quantity flags... */
+  if (ctl->qnt_m < 0)
+    ERRMSG("Module needs quantity mass!");
+
+#ifdef _OPENACC
+#pragma acc data present(ctl,atm,cache,dt)
+#pragma acc parallel loop independent gang vector
+#else
+#pragma omp parallel for default(shared)
+#endif
+  for (int ia = 0; ia < cache->nact; ia++)
+    module_oh_chem_parcel(ctl, met0, met1, atm, cache, dt,
+			  cache->iact[ia]);
+}
+
+/*****************************************************************************/
+
+void module_oh_chem_parcel(
+  ctl_t * ctl,
+  met_t * met0,
+  met_t * met1,
+  atm_t * atm,
+  cache_t * cache,
+  double *dt,
+  int ip) {
+
+  if (dt[ip] != 0) {
+
+    double c, k, k0, ki, M, T, cw[3];
+
+    int ci[3];
+
+    /* Get temperature... */
+    intpol_met_cache(cache, met0, ip, atm->p[ip], atm->lon[ip], atm->lat[ip],
+		     ci, cw);
+    intpol_met_time_3d(met0, met0->t, met1, met1->t, atm->time[ip],
+		       atm->p[ip], atm->lon[ip], atm->lat[ip], &T, ci, cw,
+		       0);
+
+    /* Calculate molecular density... */
+    M = 7.243e21 * (atm->p[ip] / P0) / T;
+
+    /* Calculate rate coefficient for X + OH + M -> XOH + M
+       (JPL Publication 15-10) ... */
+    k0 = ctl->oh_chem[0] *
+      (ctl->oh_chem[1] > 0 ? pow(T / 300., -ctl->oh_chem[1]) : 1.);
+    ki = ctl->oh_chem[2] *
+      (ctl->oh_chem[3] > 0 ? pow(T / 300., -ctl->oh_chem[3]) : 1.);
+    c = log10(k0 * M / ki);
+    k = k0 * M / (1. + k0 * M / ki) * pow(0.6, 1. / (1. + c * c));
+
+    /* Calculate exponential decay... */
+    atm->q[ctl->qnt_m][ip] *=
+      exp(-dt[ip] * k * clim_oh(atm->time[ip], atm->lat[ip], atm->p[ip]));
+  }
+}
+
+/*****************************************************************************/
+
+void module_wet_deposition(
+  ctl_t * ctl,
+  met_t * met0,
+  met_t * met1,
+  atm_t * atm,
+  cache_t * cache,
+  double *dt) {
+
+  /* Check quantity flags... */
+  if (ctl->qnt_m < 0)
+    ERRMSG("Module needs quantity mass!");
+
+#ifdef _OPENACC
+#pragma acc data present(ctl,atm,cache,dt)
+#pragma acc parallel loop independent gang vector
+#else
+#pragma omp parallel for default(shared)
+#endif
+  for (int ia = 0; ia < cache->nact; ia++)
+    module_wet_deposition_parcel(ctl, met0, met1, atm, cache, dt,
+				 cache->iact[ia]);
+}
+
+/*****************************************************************************/
+
+void module_wet_deposition_parcel(
+  ctl_t * ctl,
+  met_t * met0,
+  met_t * met1,
+  atm_t * atm,
+  cache_t * cache,
+  double *dt,
+  int ip) {
+
+  if (dt[ip] != 0) {
+
+    double H, Is, Si, T, cl, lambda, iwc, lwc, pc, cw[3];
+
+    int inside, ci[3];
+
+    /* Check whether particle is below cloud top... */
+    intpol_met_cache(cache, met0, ip, atm->p[ip], atm->lon[ip], atm->lat[ip],
+		     ci, cw);
+    intpol_met_time_2d(met0, met0->pc, met1, met1->pc, atm->time[ip],
+		       atm->lon[ip], atm->lat[ip], &pc, ci, cw, 0);
+    if (!check_finite(pc) || atm->p[ip] <= pc)
+      return;
+
+    /* Check whether particle is inside or below cloud... */
+    intpol_met_time_3d(met0, met0->lwc, met1, met1->lwc, atm->time[ip],
+		       atm->p[ip], atm->lon[ip], atm->lat[ip], &lwc, ci, cw,
+		       0);
+    intpol_met_time_3d(met0, met0->iwc, met1, met1->iwc, atm->time[ip],
+		       atm->p[ip], atm->lon[ip], atm->lat[ip], &iwc, ci, cw,
+		       0);
+    inside = (iwc > 0 || lwc > 0);
+
+    /* Estimate precipitation rate (Pisso et al., 2019)... */
+    intpol_met_time_2d(met0, met0->cl, met1, met1->cl, atm->time[ip],
+		       atm->lon[ip], atm->lat[ip], &cl, ci, cw, 0);
+    Is = pow(2. * cl, 1. / 0.36);
+    if (Is < 0.01)
+      return;
+
+    /* Calculate in-cloud scavenging for gases... */
+    if (inside) {
+
+      /* Get temperature... */
+      intpol_met_time_3d(met0, met0->t, met1, met1->t, atm->time[ip],
+			 atm->p[ip], atm->lon[ip], atm->lat[ip], &T, ci, cw,
+			 0);
+
+      /* Get Henry's constant (Sander, 2015)... */
+      H = ctl->wet_depo[2] * 101.325
+	* exp(ctl->wet_depo[3] * (1. / T - 1. / 298.15));
+
+      /* Get scavenging coefficient (Hertel et al., 1995)... */
+      Si = 1. / ((1. - cl) / (H * RI / P0 * T) + cl);
+      lambda = 6.2 * Si * Is / 3.6e6;
+    }
+
+    /* Calculate below-cloud scavenging for gases (Pisso et al., 2019)... */
+    else
+      lambda = ctl->wet_depo[0] * pow(Is, ctl->wet_depo[1]);
+
+    /* Calculate exponential decay... */
+    atm->q[ctl->qnt_m][ip] *= exp(-dt[ip] * lambda);
+  }
+}
+
+/*****************************************************************************/
+
+void random_normal(
+  unsigned int key0,
+  unsigned int key1,
+  double ctr0,
+  unsigned int ctr1,
+  double *rs) {
+
+  union {
+    double d;
+    unsigned long long u;
+  } c = {
+  ctr0};
+
+  unsigned int x[4] = { (unsigned int) c.u, (unsigned int) (c.u >> 32),
+    ctr1, 0
+  };
+
+  /* Apply ten rounds of Philox4x32... */
+  for (int i = 0; i < 10; i++) {
+    unsigned long long p0 = 0xD2511F53ULL * x[0];
+    unsigned long long p1 = 0xCD9E8D57ULL * x[2];
+    x[0] = (unsigned int) (p1 >> 32) ^ x[1] ^ key0;
+    x[1] = (unsigned int) p1;
+    x[2] = (unsigned int) (p0 >> 32) ^ x[3] ^ key1;
+    x[3] = (unsigned int) p0;
+    key0 += 0x9E3779B9U;
+    key1 += 0xBB67AE85U;
+  }
+
+  /* Convert to normal distribution (Box-Muller)... */
+  for (int i = 0; i < 4; i += 2) {
+    double u1 = (x[i] + 0.5) / 4294967296.;
+    double u2 = (x[i + 1] + 0.5) / 4294967296.;
+    rs[i] = sqrt(-2. * log(u1)) * cos(2. * M_PI * u2);
+    rs[i + 1] = sqrt(-2. * log(u1)) * sin(2. * M_PI * u2);
+  }
+}
+
+/*****************************************************************************/
+
+static int read_atm_asc_line(
+  const char *s,
+  const char *e,
+  int nl,
+  ctl_t * ctl,
+  atm_t * atm,
+  int ip) {
+
+  char buf[64], *end;
+
+  double val[NQ + 4];
+
+  int i;
+
+  size_t n;
+
+  /* Read data (tokens are separated by blanks and tabs like with TOK)... */
+  for (i = 0; i < ctl->nq + 4; i++) {
+    while (s < e && (*s == ' ' || *s == '\t'))
+      s++;
+    if (s >= e) {
+      if (nl && (i == 0 || s[-1] == ' ' || s[-1] == '\t'))
+	return 0;
+      ERRMSG("Error while reading!");
+    }
+    for (n = 0; s < e && *s != ' ' && *s != '\t'; s++)
+      if (n < sizeof(buf) - 1)
+	buf[n++] = *s;
+    buf[n] = 0;
+    val[i] = strtod(buf, &end);
+    if (end == buf)
       return 0;
+  }
+
+  /* Copy data and convert altitude to pressure... */
+  atm->time[ip] = val[0];
+  atm->p[ip] = P(val[1]);
+  atm->lon[ip] = val[2];
+  atm->lat[ip] = val[3];
+  for (i = 0; i < ctl->nq; i++)
+    atm->q[i][ip] = val[i + 4];
+
+  return 1;
+}
+
+/*****************************************************************************/
+
+static int read_atm_asc(
+  const char *filename,
+  ctl_t * ctl,
+  atm_t * atm) {
+
+  char *map;
+
+  int fd, ic, iq, nc, *nok;
+
+  size_t *beg, *off, size;
+
+  struct stat st;
+
+  /* Open file... */
+  if ((fd = open(filename, O_RDONLY)) < 0)
+    return 0;
+  if (fstat(fd, &st) != 0)
+    ERRMSG("Cannot access file!");
+  if ((size = (size_t) st.st_size) == 0) {
+    close(fd);
+    return 1;
+  }
+
+  /* Map file into memory... */
+  map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED)
+    ERRMSG("Cannot map file!");
+  madvise(map, size, MADV_SEQUENTIAL);
+
+  /* Split file into chunks at line boundaries... */
+  nc = (int) GSL_MIN((size_t) (8 * omp_get_max_threads()),
+		     size / 65536 + 1);
+  ALLOC(beg, size_t, nc + 1);
+  ALLOC(off, size_t, nc + 1);
+  ALLOC(nok, int, nc);
+  for (ic = 1; ic < nc; ic++) {
+    char *nlp;
+    beg[ic] = GSL_MAX(beg[ic - 1], size / (size_t) nc * (size_t) ic);
+    nlp = memchr(map + beg[ic], '\n', size - beg[ic]);
+    beg[ic] = nlp ? (size_t) (nlp - map) + 1 : size;
+  }
+  beg[nc] = size;
+
+  /* Count lines... */
+#pragma omp parallel for default(shared) private(ic)
+  for (ic = 0; ic < nc; ic++) {
+    const char *s = map + beg[ic], *e = map + beg[ic + 1];
+    for (off[ic + 1] = 0; s < e; off[ic + 1]++) {
+      const char *nlp = memchr(s, '\n', (size_t) (e - s));
+      s = nlp ? nlp + 1 : e;
     }
+  }
+  for (ic = 0; ic < nc; ic++)
+    off[ic + 1] += off[ic];
 
-    /* Read line... */
-    while (fgets(line, LEN, in)) {
+  /* Allocate... */
+  alloc_atm(ctl, atm, (int) off[nc]);
+
+  /* Parse chunks in parallel... */
+#pragma omp parallel for default(shared) private(ic) schedule(dynamic)
+  for (ic = 0; ic < nc; ic++) {
+    const char *s = map + beg[ic], *e = map + beg[ic + 1];
+    nok[ic] = 0;
+    while (s < e) {
+      const char *nlp = memchr(s, '\n', (size_t) (e - s));
+      const char *le = nlp ? nlp : e;
+      if (read_atm_asc_line(s, le, nlp != NULL, ctl, atm,
+			    (int) off[ic] + nok[ic]))
+	nok[ic]++;
+      s = nlp ? nlp + 1 : e;
+    }
+  }
 
-      /* Read data... */
-      TOK(line, tok, "%lg", atm->time[atm->np]);
-      TOK(NULL, tok, "%lg", atm->p[atm->np]);
-      TOK(NULL, tok, "%lg", atm->lon[atm->np]);
-      TOK(NULL, tok, "%lg", atm->lat[atm->np]);
+  /* Remove gaps left by comments and empty lines... */
+  for (ic = 0; ic < nc; ic++) {
+    if ((size_t) atm->np != off[ic]) {
+      size_t n = (size_t) nok[ic] * sizeof(double);
+      memmove(atm->time + atm->np, atm->time + off[ic], n);
+      memmove(atm->p + atm->np, atm->p + off[ic], n);
+      memmove(atm->lon + atm->np, atm->lon + off[ic], n);
+      memmove(atm->lat + atm->np, atm->lat + off[ic], n);
       for (iq = 0; iq < ctl->nq; iq++)
-	TOK(NULL, tok, "%lg", atm->q[iq][atm->np]);
+	memmove(atm->q[iq] + atm->np, atm->q[iq] + off[ic], n);
+    }
+    atm->np += nok[ic];
+  }
+
+  /* Free... */
+  munmap(map, size);
+  free(beg);
+  free(off);
+  free(nok);
 
-      /* Convert altitude to pressure... */
-      atm->p[atm->np] = P(atm->p[atm->np]);
+  return 1;
+}
 
-      /* Increment data point counter... */
-      if ((++atm->np) > NP)
-	ERRMSG("Too many data points!");
-    }
+/*****************************************************************************/
 
-    /* Close file... */
-    fclose(in);
+static int read_atm_bin(
+  const char *filename,
+  ctl_t * ctl,
+  atm_t * atm) {
+
+  char *map, *names = NULL;
+
+  double *data;
+
+  int cp = 1, fd, hdr[4], fq[NQ], i, iq, np, nq;
+
+  size_t size;
+
+  struct stat st;
+
+  /* Open file and map it into memory... */
+  if ((fd = open(filename, O_RDONLY)) < 0)
+    return 0;
+  if (fstat(fd, &st) != 0)
+    ERRMSG("Cannot access file!");
+  if ((size = (size_t) st.st_size) < sizeof(int))
+    ERRMSG("Error while reading!");
+  map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED)
+    ERRMSG("Cannot map file!");
+
+  /* Read legacy file (number of parcels and data arrays)... */
+  memcpy(hdr, map, sizeof(int));
+  if (hdr[0] >= 0) {
+    np = hdr[0];
+    nq = ctl->nq;
+    if (size < sizeof(int) + (size_t) np * (size_t) (nq + 4)
+	* sizeof(double))
+      ERRMSG("Legacy binary atmospheric data do not match NQ!");
+    for (iq = 0; iq < nq; iq++)
+      fq[iq] = iq;
+    data = NULL;
   }
 
-  /* Read binary data... */
-  else if (ctl->atm_type == 1) {
+  /* Read versioned file (header, quantity names, and data arrays)... */
+  else {
+    if (size < sizeof(hdr))
+      ERRMSG("Error while reading!");
+    memcpy(hdr, map, sizeof(hdr));
+    if (hdr[0] != ATM_BIN_MAGIC)
+      ERRMSG("Unknown format of binary atmospheric data!");
+    if (hdr[1] != ATM_BIN_VERSION)
+      ERRMSG("Binary atmospheric data written by another version!");
+    np = hdr[2];
+    nq = hdr[3];
+    names = map + sizeof(hdr);
+    data = (double *) (names + (size_t) nq * ATM_BIN_NAME);
+    if (np < 0 || nq < 0 || size != sizeof(hdr) + (size_t) nq * ATM_BIN_NAME
+	+ (size_t) np * (size_t) (nq + 4) * sizeof(double))
+      ERRMSG("Error while reading!");
+
+    /* Find quantities by name... */
+    for (iq = 0; iq < ctl->nq; iq++) {
+      for (fq[iq] = -1, i = 0; i < nq; i++)
+	if (strncmp(names + (size_t) i * ATM_BIN_NAME, ctl->qnt_name[iq],
+		    ATM_BIN_NAME) == 0)
+	  fq[iq] = i;
+      if (fq[iq] < 0)
+	ERRMSG("Cannot find quantity in binary atmospheric data!");
+    }
 
-    /* Open file... */
-    if (!(in = fopen(filename, "r")))
-      return 0;
+#ifndef _OPENACC
+    /* Use mapped data without copying (not for managed memory)... */
+    cp = 0;
+#endif
+  }
 
-    /* Read data... */
-    FREAD(&atm->np, int, 1, in);
-    FREAD(atm->time, double,
-	    (size_t) atm->np,
-	  in);
-    FREAD(atm->p, double,
-	    (size_t) atm->np,
-	  in);
-    FREAD(atm->lon, double,
-	    (size_t) atm->np,
-	  in);
-    FREAD(atm->lat, double,
-	    (size_t) atm->np,
-	  in);
+  /* Set pointers to mapped data... */
+  if (!cp) {
+    free_atm(atm);
+    atm->map = map;
+    atm->mapsize = size;
+    atm->np = atm->npmax = np;
+    atm->time = data;
+    atm->p = data + np;
+    atm->lon = data + 2 * (size_t) np;
+    atm->lat = data + 3 * (size_t) np;
     for (iq = 0; iq < ctl->nq; iq++)
-      FREAD(atm->q[iq], double,
-	      (size_t) atm->np,
-	    in);
+      atm->q[iq] = data + (size_t) (fq[iq] + 4) * (size_t) np;
+  }
 
-    /* Close file... */
-    fclose(in);
+  /* Copy data... */
+  else {
+    size_t n = (size_t) np * sizeof(double);
+    char *d = data ? (char *) data : map + sizeof(int);
+    alloc_atm(ctl, atm, np);
+    atm->np = np;
+    memcpy(atm->time, d, n);
+    memcpy(atm->p, d + n, n);
+    memcpy(atm->lon, d + 2 * n, n);
+    memcpy(atm->lat, d + 3 * n, n);
+    for (iq = 0; iq < ctl->nq; iq++)
+      memcpy(atm->q[iq], d + (size_t) (fq[iq] + 4) * n, n);
+    munmap(map, size);
+  }
+
+  return 1;
+}
+
+/*****************************************************************************/
+
+int read_atm(
+  const char *filename,
+  ctl_t * ctl,
+  atm_t * atm) {
+
+  double t0;
+
+  int dimid, ip, iq, ncid, varid;
+
+  size_t nparts;
+
+  /* Release memory-mapped data of previous file... */
+  if (atm->map)
+    free_atm(atm);
+
+  /* Init... */
+  atm->np = 0;
+
+  /* Write info... */
+  printf("Read atmospheric data: %s\n", filename);
+
+  /* Read ASCII data... */
+  if (ctl->atm_type == 0) {
+    if (!read_atm_asc(filename, ctl, atm)) {
+      WARN("File not found!");
+      return 0;
+    }
+  }
+
+  /* Read binary data... */
+  else if (ctl->atm_type == 1) {
+    if (!read_atm_bin(filename, ctl, atm))
+      return 0;
   }
 
   /* Read netCDF data... */
   else if (ctl->atm_type == 2) {
 
     /* Open file... */
-    if (nc_open(filename, NC_NOWRITE, &ncid) != NC_NOERR)
+    pthread_mutex_lock(&nc_mutex);
+    if (nc_open(filename, NC_NOWRITE, &ncid) != NC_NOERR) {
+      pthread_mutex_unlock(&nc_mutex);
       return 0;
+    }
 
     /* Get dimensions... */
     NC(nc_inq_dimid(ncid, "NPARTS", &dimid));
     NC(nc_inq_dimlen(ncid, dimid, &nparts));
     atm->np = (int) nparts;
-    if (atm->np > NP)
-      ERRMSG("Too many particles!");
+    alloc_atm(ctl, atm, atm->np);
 
     /* Get time... */
     NC(nc_inq_varid(ncid, "time", &varid));
@@ -2133,6 +4133,44 @@ int read_atm(
 
     /* Close file... */
     NC(nc_close(ncid));
+    pthread_mutex_unlock(&nc_mutex);
+  }
+
+  /* Read netCDF data... */
+  else if (ctl->atm_type == 3) {
+
+    /* Open file... */
+    pthread_mutex_lock(&nc_mutex);
+    if (nc_open(filename, NC_NOWRITE, &ncid) != NC_NOERR) {
+      pthread_mutex_unlock(&nc_mutex);
+      return 0;
+    }
+
+    /* Get dimensions... */
+    NC(nc_inq_dimid(ncid, "NP", &dimid));
+    NC(nc_inq_dimlen(ncid, dimid, &nparts));
+    atm->np = (int) nparts;
+    alloc_atm(ctl, atm, atm->np);
+
+    /* Read data... */
+    if (atm->np > 0) {
+      NC(nc_inq_varid(ncid, "time", &varid));
+      NC(nc_get_var_double(ncid, varid, atm->time));
+      NC(nc_inq_varid(ncid, "press", &varid));
+      NC(nc_get_var_double(ncid, varid, atm->p));
+      NC(nc_inq_varid(ncid, "lon", &varid));
+      NC(nc_get_var_double(ncid, varid, atm->lon));
+      NC(nc_inq_varid(ncid, "lat", &varid));
+      NC(nc_get_var_double(ncid, varid, atm->lat));
+      for (iq = 0; iq < ctl->nq; iq++) {
+	NC(nc_inq_varid(ncid, ctl->qnt_name[iq], &varid));
+	NC(nc_get_var_double(ncid, varid, atm->q[iq]));
+      }
+    }
+
+    /* Close file... */
+    NC(nc_close(ncid));
+    pthread_mutex_unlock(&nc_mutex);
   }
 
   /* Error... */
@@ -2149,6 +4187,202 @@ int read_atm(
 
 /*****************************************************************************/
 
+/*! State of the atm file list reader thread. */
+static struct {
+  pthread_t thread;
+  ctl_t *ctl;
+  atm_t *atm[2][2];
+  char **files;
+  int active, ifile, nset, status;
+} atm_list;
+
+static void *read_atm_list_read(
+  void *arg) {
+
+  int i;
+
+  /* Read all files of the set... */
+  atm_list.status = 1;
+  for (i = 0; i < atm_list.nset && atm_list.status; i++)
+    atm_list.status = read_atm(atm_list.files[atm_list.ifile + i],
+			       atm_list.ctl, atm_list.atm[1][i]);
+
+  return arg;
+}
+
+/*****************************************************************************/
+
+int read_atm_list(
+  ctl_t * ctl,
+  int nfile,
+  char *files[],
+  int nset,
+  int *ifile,
+  atm_t ** atm) {
+
+  atm_t *atms;
+
+  int i;
+
+  /* Start with first set... */
+  if (*ifile < 0) {
+    if (nset < 1 || nset > 2)
+      ERRMSG("Number of files per set must be 1 or 2!");
+    if (!atm_list.atm[0][0])
+      for (i = 0; i < 2; i++) {
+	ALLOC(atm_list.atm[0][i], atm_t, 1);
+	ALLOC(atm_list.atm[1][i], atm_t, 1);
+      }
+    atm_list.ctl = ctl;
+    atm_list.files = files;
+    atm_list.nset = nset;
+    atm_list.ifile = -1;
+  }
+
+  /* Loop until a set could be read... */
+  for (;;) {
+
+    /* Wait for reader thread or read first set directly... */
+    if (atm_list.active) {
+      if (pthread_join(atm_list.thread, NULL) != 0)
+	ERRMSG("Cannot join reader thread!");
+      atm_list.active = 0;
+    } else if (atm_list.ifile < 0 && nfile >= nset) {
+      atm_list.ifile = 0;
+      read_atm_list_read(NULL);
+    } else {
+      for (i = 0; i < 2; i++) {
+	free_atm(atm_list.atm[0][i]);
+	free_atm(atm_list.atm[1][i]);
+	free(atm_list.atm[0][i]);
+	free(atm_list.atm[1][i]);
+	atm_list.atm[0][i] = atm_list.atm[1][i] = NULL;
+      }
+      for (i = 0; i < nset; i++)
+	atm[i] = NULL;
+      return 0;
+    }
+
+    /* Swap buffers... */
+    for (i = 0; i < 2; i++) {
+      atms = atm_list.atm[0][i];
+      atm_list.atm[0][i] = atm_list.atm[1][i];
+      atm_list.atm[1][i] = atms;
+    }
+    *ifile = atm_list.ifile;
+    int status = atm_list.status;
+
+    /* Start reading next set... */
+    if (atm_list.ifile + 2 * nset <= nfile) {
+      atm_list.ifile += nset;
+      atm_list.active = 1;
+      if (pthread_create(&atm_list.thread, NULL, read_atm_list_read, NULL)
+	  != 0)
+	ERRMSG("Cannot create reader thread!");
+    }
+
+    /* Return data... */
+    if (status) {
+      for (i = 0; i < nset; i++)
+	atm[i] = atm_list.atm[0][i];
+      return 1;
+    }
+  }
+}
+
+/*****************************************************************************/
+
+/*! State of output writers in checkpoints. */
+typedef struct {
+  long inpos[NCHKW], outpos[NCHKW];
+  double acc[NCHKW][4];
+} chk_wr_t;
+
+/*! Open files and restored state of output writers. */
+static struct {
+  FILE **in[NCHKW], **out[NCHKW];
+  chk_wr_t state;
+} chk_wr;
+
+int read_chk(
+  const char *filename,
+  ctl_t * ctl,
+  atm_t * atm,
+  cache_t * cache,
+  double *t) {
+
+  FILE *in;
+
+  char magic[8];
+
+  int head[3], np;
+
+  /* Open file... */
+  if (!(in = fopen(filename, "r")))
+    return 0;
+
+  /* Read header... */
+  FREAD(magic, char, 8, in);
+  if (memcmp(magic, "MPTRACCK", 8) != 0)
+    ERRMSG("File is not a checkpoint file!");
+  FREAD(head, int, 3, in);
+  if (head[0] != CHK_VERSION)
+    ERRMSG("Wrong version of checkpoint file!");
+  FREAD(t, double, 1, in);
+
+  /* Read only the time... */
+  if (!atm) {
+    fclose(in);
+    return 1;
+  }
+
+  /* Write info... */
+  printf("Read checkpoint: %s\n", filename);
+
+  /* Check dimensions... */
+  np = head[1];
+  if (np != atm->np || head[2] != ctl->nq)
+    ERRMSG("Checkpoint does not match air parcel data!");
+
+  /* Read air parcel data... */
+  FREAD(atm->time, double, (size_t) np, in);
+  FREAD(atm->p, double, (size_t) np, in);
+  FREAD(atm->lon, double, (size_t) np, in);
+  FREAD(atm->lat, double, (size_t) np, in);
+  for (int iq = 0; iq < ctl->nq; iq++)
+    FREAD(atm->q[iq], double, (size_t) np, in);
+
+  /* Read cache data... */
+  FREAD(cache->id, int, (size_t) np, in);
+  FREAD(cache->up, float, (size_t) np, in);
+  FREAD(cache->vp, float, (size_t) np, in);
+  FREAD(cache->wp, float, (size_t) np, in);
+  FREAD(cache->iso_var, double, (size_t) np, in);
+
+  /* Read isosurface balloon data... */
+  FREAD(&cache->iso_n, int, 1, in);
+  free(cache->iso_ps);
+  free(cache->iso_ts);
+  cache->iso_ps = cache->iso_ts = NULL;
+  if (cache->iso_n > 0) {
+    ALLOC(cache->iso_ps, double, cache->iso_n);
+    ALLOC(cache->iso_ts, double, cache->iso_n);
+    FREAD(cache->iso_ps, double, (size_t) cache->iso_n, in);
+    FREAD(cache->iso_ts, double, (size_t) cache->iso_n, in);
+  }
+
+  /* Read state of output writers... */
+  FREAD(&chk_wr.state, chk_wr_t, 1, in);
+
+  /* Close file... */
+  fclose(in);
+
+  /* Return success... */
+  return 1;
+}
+
+/*****************************************************************************/
+
 void read_ctl(
   const char *filename,
   int argc,
@@ -2297,6 +4531,16 @@ void read_ctl(
     ERRMSG("Set DIRECTION to -1 or 1!");
   ctl->t_stop = scan_ctl(filename, argc, argv, "T_STOP", -1, "1e100", NULL);
   ctl->dt_mod = scan_ctl(filename, argc, argv, "DT_MOD", -1, "600", NULL);
+  ctl->fused_step =
+    (int) scan_ctl(filename, argc, argv, "FUSED_STEP", -1, "0", NULL);
+  ctl->advect_cfl =
+    scan_ctl(filename, argc, argv, "ADVECT_CFL", -1, "0", NULL);
+  ctl->sort_dt = scan_ctl(filename, argc, argv, "SORT_DT", -1, "0", NULL);
+  ctl->intpol_cache =
+    (int) scan_ctl(filename, argc, argv, "INTPOL_CACHE", -1, "0", NULL);
+  ctl->mpi_decomp =
+    (int) scan_ctl(filename, argc, argv, "MPI_DECOMP", -1, "0", NULL);
+  ctl->batch = (int) scan_ctl(filename, argc, argv, "BATCH", -1, "1", NULL);
 
   /* Meteorological data... */
   ctl->dt_met = scan_ctl(filename, argc, argv, "DT_MET", -1, "21600", NULL);
@@ -2306,6 +4550,14 @@ void read_ctl(
   ctl->met_sx = (int) scan_ctl(filename, argc, argv, "MET_SX", -1, "1", NULL);
   ctl->met_sy = (int) scan_ctl(filename, argc, argv, "MET_SY", -1, "1", NULL);
   ctl->met_sp = (int) scan_ctl(filename, argc, argv, "MET_SP", -1, "1", NULL);
+  ctl->met_lon0 =
+    scan_ctl(filename, argc, argv, "MET_LON0", -1, "-360", NULL);
+  ctl->met_lon1 =
+    scan_ctl(filename, argc, argv, "MET_LON1", -1, "360", NULL);
+  ctl->met_lat0 = scan_ctl(filename, argc, argv, "MET_LAT0", -1, "-90", NULL);
+  ctl->met_lat1 = scan_ctl(filename, argc, argv, "MET_LAT1", -1, "90", NULL);
+  ctl->met_z0 = scan_ctl(filename, argc, argv, "MET_Z0", -1, "-999", NULL);
+  ctl->met_z1 = scan_ctl(filename, argc, argv, "MET_Z1", -1, "999", NULL);
   ctl->met_np = (int) scan_ctl(filename, argc, argv, "MET_NP", -1, "0", NULL);
   if (ctl->met_np > EP)
     ERRMSG("Too many levels!");
@@ -2314,9 +4566,18 @@ void read_ctl(
   ctl->met_tropo =
     (int) scan_ctl(filename, argc, argv, "MET_TROPO", -1, "3", NULL);
   scan_ctl(filename, argc, argv, "MET_STAGE", -1, "-", ctl->met_stage);
+  ctl->met_prefetch =
+    (int) scan_ctl(filename, argc, argv, "MET_PREFETCH", -1, "0", NULL);
+  scan_ctl(filename, argc, argv, "MET_CACHE", -1, "-", ctl->met_cache);
+  ctl->met_uvw16 =
+    (int) scan_ctl(filename, argc, argv, "MET_UVW16", -1, "0", NULL);
   ctl->met_dt_out =
     scan_ctl(filename, argc, argv, "MET_DT_OUT", -1, "0.1", NULL);
 
+  /* Read and calculate all meteo fields by default... */
+  ctl->met_h2o = ctl->met_o3 = ctl->met_cloud = 1;
+  ctl->met_z = ctl->met_pv = 1;
+
   /* Isosurface parameters... */
   ctl->isosurf =
     (int) scan_ctl(filename, argc, argv, "ISOSURF", -1, "0", NULL);
@@ -2335,6 +4596,8 @@ void read_ctl(
     scan_ctl(filename, argc, argv, "TURB_MESOX", -1, "0.16", NULL);
   ctl->turb_mesoz =
     scan_ctl(filename, argc, argv, "TURB_MESOZ", -1, "0.16", NULL);
+  ctl->turb_seed =
+    (int) scan_ctl(filename, argc, argv, "TURB_SEED", -1, "0", NULL);
 
   /* Species parameters... */
   scan_ctl(filename, argc, argv, "SPECIES", -1, "-", ctl->species);
@@ -2368,6 +4631,10 @@ void read_ctl(
   ctl->psc_hno3 =
     scan_ctl(filename, argc, argv, "PSC_HNO3", -1, "9e-9", NULL);
 
+  /* Asynchronous output... */
+  ctl->out_async =
+    (int) scan_ctl(filename, argc, argv, "OUT_ASYNC", -1, "0", NULL);
+
   /* Output of atmospheric data... */
   scan_ctl(filename, argc, argv, "ATM_BASENAME", -1, "-", ctl->atm_basename);
   scan_ctl(filename, argc, argv, "ATM_GPFILE", -1, "-", ctl->atm_gpfile);
@@ -2380,6 +4647,14 @@ void read_ctl(
   ctl->atm_type =
     (int) scan_ctl(filename, argc, argv, "ATM_TYPE", -1, "0", NULL);
 
+  /* Compression of netCDF output... */
+  ctl->nc_level =
+    (int) scan_ctl(filename, argc, argv, "NC_LEVEL", -1, "0", NULL);
+  ctl->nc_chunk =
+    (int) scan_ctl(filename, argc, argv, "NC_CHUNK", -1, "0", NULL);
+  ctl->nc_quant =
+    (int) scan_ctl(filename, argc, argv, "NC_QUANT", -1, "0", NULL);
+
   /* Output of CSI data... */
   scan_ctl(filename, argc, argv, "CSI_BASENAME", -1, "-", ctl->csi_basename);
   ctl->csi_dt_out =
@@ -2413,6 +4688,8 @@ void read_ctl(
     scan_ctl(filename, argc, argv, "GRID_DT_OUT", -1, "86400", NULL);
   ctl->grid_sparse =
     (int) scan_ctl(filename, argc, argv, "GRID_SPARSE", -1, "0", NULL);
+  ctl->grid_type =
+    (int) scan_ctl(filename, argc, argv, "GRID_TYPE", -1, "0", NULL);
   ctl->grid_z0 = scan_ctl(filename, argc, argv, "GRID_Z0", -1, "0", NULL);
   ctl->grid_z1 = scan_ctl(filename, argc, argv, "GRID_Z1", -1, "100", NULL);
   ctl->grid_nz =
@@ -2454,9 +4731,35 @@ void read_ctl(
   /* Output of station data... */
   scan_ctl(filename, argc, argv, "STAT_BASENAME", -1, "-",
 	   ctl->stat_basename);
+  scan_ctl(filename, argc, argv, "STAT_FILE", -1, "-", ctl->stat_file);
   ctl->stat_lon = scan_ctl(filename, argc, argv, "STAT_LON", -1, "0", NULL);
   ctl->stat_lat = scan_ctl(filename, argc, argv, "STAT_LAT", -1, "0", NULL);
   ctl->stat_r = scan_ctl(filename, argc, argv, "STAT_R", -1, "50", NULL);
+
+  /* Output of performance data... */
+  scan_ctl(filename, argc, argv, "PERF_BASENAME", -1, "-",
+	   ctl->perf_basename);
+
+  /* Checkpoints... */
+  scan_ctl(filename, argc, argv, "CHK_BASENAME", -1, "-", ctl->chk_basename);
+  ctl->chk_dt_out =
+    scan_ctl(filename, argc, argv, "CHK_DT_OUT", -1, "86400", NULL);
+  ctl->restart =
+    (int) scan_ctl(filename, argc, argv, "RESTART", -1, "0", NULL);
+}
+
+/*****************************************************************************/
+
+/*! Count a meteo file that has been read. */
+static void read_met_count(
+  const char *filename) {
+
+  struct stat st;
+
+  if (stat(filename, &st) == 0) {
+    counter(COUNTER_MET_FILES, 1);
+    counter(COUNTER_MET_BYTES, (double) st.st_size);
+  }
 }
 
 /*****************************************************************************/
@@ -2468,9 +4771,7 @@ int read_met(
 
   char cmd[2 * LEN], levname[LEN], tstr[10];
 
-  int ip, dimid, ncid, varid, year, mon, day, hour;
-
-  size_t np, nx, ny;
+  int ip, ncid, year, mon, day, hour;
 
   /* Write info... */
   printf("Read meteorological data: %s\n", filename);
@@ -2486,7 +4787,12 @@ int read_met(
   hour = atoi(tstr);
   time2jsec(year, mon, day, hour, 0, 0, 0, &met->time);
 
-  /* Open netCDF file... */
+  /* Try to read preprocessed data from cache... */
+  if (ctl->met_cache[0] != '-' && read_met_cache(ctl, filename, met))
+    return 1;
+
+  /* Open netCDF file (the prefetch thread may call read_met)... */
+  pthread_mutex_lock(&nc_mutex);
   if (nc_open(filename, NC_NOWRITE, &ncid) != NC_NOERR) {
 
     /* Try to stage meteo file... */
@@ -2499,71 +4805,46 @@ int read_met(
 
     /* Try to open again... */
     if (nc_open(filename, NC_NOWRITE, &ncid) != NC_NOERR) {
+      pthread_mutex_unlock(&nc_mutex);
       WARN("File not found!");
       return 0;
     }
   }
+  read_met_count(filename);
 
-  /* Get dimensions... */
-  NC(nc_inq_dimid(ncid, "lon", &dimid));
-  NC(nc_inq_dimlen(ncid, dimid, &nx));
-  if (nx < 2 || nx > EX)
-    ERRMSG("Number of longitudes out of range!");
-
-  NC(nc_inq_dimid(ncid, "lat", &dimid));
-  NC(nc_inq_dimlen(ncid, dimid, &ny));
-  if (ny < 2 || ny > EY)
-    ERRMSG("Number of latitudes out of range!");
-
-  sprintf(levname, "lev");
-  NC(nc_inq_dimid(ncid, levname, &dimid));
-  NC(nc_inq_dimlen(ncid, dimid, &np));
-  if (np == 1) {
-    sprintf(levname, "lev_2");
-    NC(nc_inq_dimid(ncid, levname, &dimid));
-    NC(nc_inq_dimlen(ncid, dimid, &np));
-  }
-  if (np < 2 || np > EP)
-    ERRMSG("Number of levels out of range!");
-
-  /* Store dimensions... */
-  met->np = (int) np;
-  met->nx = (int) nx;
-  met->ny = (int) ny;
+  /* Get grid and subset... */
+  read_met_grid(ctl, ncid, levname, met);
 
-  /* Get horizontal grid... */
-  NC(nc_inq_varid(ncid, "lon", &varid));
-  NC(nc_get_var_double(ncid, varid, met->lon));
-  NC(nc_inq_varid(ncid, "lat", &varid));
-  NC(nc_get_var_double(ncid, varid, met->lat));
+  /* Allocate (extra longitude for periodic boundary conditions)... */
+  alloc_met(met, met->nx + 1, met->ny, GSL_MAX(met->np, ctl->met_np));
 
   /* Read meteorological data... */
-  if (!read_met_help_3d(ncid, "t", "T", met, met->t, 1.0))
+  if (!read_met_help_3d(ncid, "t", "T", met, met->t, 1.0, 1))
     ERRMSG("Cannot read temperature!");
-  if (!read_met_help_3d(ncid, "u", "U", met, met->u, 1.0))
+  if (!read_met_help_3d(ncid, "u", "U", met, met->uvw, 1.0, 3))
     ERRMSG("Cannot read zonal wind!");
-  if (!read_met_help_3d(ncid, "v", "V", met, met->v, 1.0))
+  if (!read_met_help_3d(ncid, "v", "V", met, met->uvw + 1, 1.0, 3))
     ERRMSG("Cannot read meridional wind!");
-  if (!read_met_help_3d(ncid, "w", "W", met, met->w, 0.01f))
+  if (!read_met_help_3d(ncid, "w", "W", met, met->uvw + 2, 0.01f, 3))
     ERRMSG("Cannot read vertical velocity");
-  if (!read_met_help_3d(ncid, "q", "Q", met, met->h2o, (float) (MA / MH2O)))
-    WARN("Cannot read specific humidity!");
-  if (!read_met_help_3d(ncid, "o3", "O3", met, met->o3, (float) (MA / MO3)))
-    WARN("Cannot read ozone data!");
-  if (!read_met_help_3d(ncid, "clwc", "CLWC", met, met->lwc, 1.0))
-    WARN("Cannot read cloud liquid water content!");
-  if (!read_met_help_3d(ncid, "ciwc", "CIWC", met, met->iwc, 1.0))
-    WARN("Cannot read cloud ice water content!");
+  if (ctl->met_h2o)
+    if (!read_met_help_3d(ncid, "q", "Q", met, met->h2o,
+			  (float) (MA / MH2O), 1))
+      WARN("Cannot read specific humidity!");
+  if (ctl->met_o3)
+    if (!read_met_help_3d(ncid, "o3", "O3", met, met->o3,
+			  (float) (MA / MO3), 1))
+      WARN("Cannot read ozone data!");
+  if (ctl->met_cloud) {
+    if (!read_met_help_3d(ncid, "clwc", "CLWC", met, met->lwc, 1.0, 1))
+      WARN("Cannot read cloud liquid water content!");
+    if (!read_met_help_3d(ncid, "ciwc", "CIWC", met, met->iwc, 1.0, 1))
+      WARN("Cannot read cloud ice water content!");
+  }
 
   /* Meteo data on pressure levels... */
   if (ctl->met_np <= 0) {
 
-    /* Read pressure levels from file... */
-    NC(nc_inq_varid(ncid, levname, &varid));
-    NC(nc_get_var_double(ncid, varid, met->p));
-    for (ip = 0; ip < met->np; ip++)
-      met->p[ip] /= 100.;
-
     /* Extrapolate data for lower boundary... */
     read_met_extrapolate(met);
   }
@@ -2572,17 +4853,21 @@ int read_met(
   else {
 
     /* Read pressure data from file... */
-    read_met_help_3d(ncid, "pl", "PL", met, met->pl, 0.01f);
+    read_met_help_3d(ncid, "pl", "PL", met, met->pl, 0.01f, 1);
 
     /* Interpolate from model levels to pressure levels... */
-    read_met_ml2pl(ctl, met, met->t);
-    read_met_ml2pl(ctl, met, met->u);
-    read_met_ml2pl(ctl, met, met->v);
-    read_met_ml2pl(ctl, met, met->w);
-    read_met_ml2pl(ctl, met, met->h2o);
-    read_met_ml2pl(ctl, met, met->o3);
-    read_met_ml2pl(ctl, met, met->lwc);
-    read_met_ml2pl(ctl, met, met->iwc);
+    read_met_ml2pl(ctl, met, met->t, 1);
+    read_met_ml2pl(ctl, met, met->uvw, 3);
+    read_met_ml2pl(ctl, met, met->uvw + 1, 3);
+    read_met_ml2pl(ctl, met, met->uvw + 2, 3);
+    if (ctl->met_h2o)
+      read_met_ml2pl(ctl, met, met->h2o, 1);
+    if (ctl->met_o3)
+      read_met_ml2pl(ctl, met, met->o3, 1);
+    if (ctl->met_cloud) {
+      read_met_ml2pl(ctl, met, met->lwc, 1);
+      read_met_ml2pl(ctl, met, met->iwc, 1);
+    }
 
     /* Set pressure levels... */
     met->np = ctl->met_np;
@@ -2598,6 +4883,10 @@ int read_met(
   /* Read surface data... */
   read_met_surface(ncid, met);
 
+  /* Close file... */
+  NC(nc_close(ncid));
+  pthread_mutex_unlock(&nc_mutex);
+
   /* Create periodic boundary conditions... */
   read_met_periodic(met);
 
@@ -2605,19 +4894,30 @@ int read_met(
   read_met_sample(ctl, met);
 
   /* Calculate geopotential heights... */
-  read_met_geopot(met);
+  if (ctl->met_z)
+    read_met_geopot(met);
 
   /* Calculate potential vorticity... */
-  read_met_pv(met);
+  if (ctl->met_pv)
+    read_met_pv(met);
 
   /* Calculate tropopause pressure... */
   read_met_tropo(ctl, met);
 
   /* Calculate cloud properties... */
-  read_met_cloud(met);
+  if (ctl->met_cloud)
+    read_met_cloud(met);
 
-  /* Close file... */
-  NC(nc_close(ncid));
+  /* Set up lookup table of pressure levels... */
+  read_met_plut(met);
+
+  /* Save preprocessed data to cache... */
+  if (ctl->met_cache[0] != '-')
+    write_met_cache(ctl, filename, met);
+
+  /* Pack winds into 16-bit integers... */
+  if (ctl->met_uvw16)
+    read_met_uvw16(met);
 
   /* Return success... */
   return 1;
@@ -2625,6 +4925,167 @@ int read_met(
 
 /*****************************************************************************/
 
+int read_met_cache(
+  ctl_t * ctl,
+  char *filename,
+  met_t * met) {
+
+  FILE *in;
+
+  char cachefile[2 * LEN], magic[8];
+
+  double time, lon[EX], lat[EY], p[EP];
+
+  float **fields[14] = { &met->ps, &met->zs, &met->pt, &met->pc, &met->cl,
+    &met->z, &met->t, &met->pv, &met->h2o, &met->o3, &met->lwc, &met->iwc,
+    &met->pl, &met->uvw
+  };
+
+  int dims[8], i;
+
+  unsigned long key, key2;
+
+  /* Get cache file... */
+  key = read_met_cache_file(ctl, filename, cachefile);
+
+  /* Open file... */
+  if (!(in = fopen(cachefile, "r")))
+    return 0;
+
+  /* Read and check header... */
+  if (fread(magic, 1, 8, in) != 8 || memcmp(magic, "MPTRACMC", 8) != 0
+      || fread(dims, sizeof(int), 8, in) != 8
+      || dims[0] != MET_CACHE_VERSION
+      || fread(&key2, sizeof(unsigned long), 1, in) != 1 || key2 != key) {
+    fclose(in);
+    return 0;
+  }
+  FREAD(&time, double,
+	1,
+	in);
+  FREAD(lon, double,
+	EX,
+	in);
+  FREAD(lat, double,
+	EY,
+	in);
+  FREAD(p, double,
+	EP,
+	in);
+
+  /* Write info... */
+  printf("Read meteorological cache: %s\n", cachefile);
+
+#ifdef _OPENACC
+  /* Read data into managed memory... */
+  alloc_met(met, dims[4], dims[5], dims[6]);
+  for (i = 0; i < 14; i++)
+    FREAD(*fields[i], float,
+	    (size_t) (i < 5 ? 1 : i < 13 ? dims[6] : 3 * dims[6])
+	    * (size_t) dims[4]
+	    * (size_t) dims[5],
+	  in);
+  fclose(in);
+#else
+  /* Map data into memory... */
+  size_t offset = (size_t) ftell(in);
+  struct stat st;
+  if (fstat(fileno(in), &st) != 0
+      || (size_t) st.st_size != offset + (5 + 11 * (size_t) dims[6])
+      * (size_t) dims[4] * (size_t) dims[5] * sizeof(float)) {
+    fclose(in);
+    return 0;
+  }
+  void *map = mmap(NULL, (size_t) st.st_size, PROT_READ | PROT_WRITE,
+		   MAP_PRIVATE, fileno(in), 0);
+  fclose(in);
+  if (map == MAP_FAILED)
+    return 0;
+  free_met(met);
+  met->map = map;
+  met->mapsize = (size_t) st.st_size;
+  met->ex = dims[4];
+  met->ey = dims[5];
+  met->ep = dims[6];
+  for (i = 0; i < 14; i++) {
+    *fields[i] = (float *) ((char *) map + offset);
+    offset += (size_t) (i < 5 ? 1 : i < 13 ? met->ep : 3 * met->ep)
+      * (size_t) met->ex
+      * (size_t) met->ey * sizeof(float);
+  }
+#endif
+
+  /* Copy grid... */
+  met->time = time;
+  met->nx = dims[1];
+  met->ny = dims[2];
+  met->np = dims[3];
+  memcpy(met->lon, lon, sizeof(met->lon));
+  memcpy(met->lat, lat, sizeof(met->lat));
+  memcpy(met->p, p, sizeof(met->p));
+  read_met_plut(met);
+  read_met_count(cachefile);
+  if (ctl->met_uvw16)
+    read_met_uvw16(met);
+
+  /* Return success... */
+  return 1;
+}
+
+/*****************************************************************************/
+
+unsigned long read_met_cache_file(
+  ctl_t * ctl,
+  char *filename,
+  char *cachefile) {
+
+  struct stat st;
+
+  char *base;
+
+  long fparam[2] = { 0, 0 };
+
+  int iparam[13] = { MET_CACHE_VERSION, ctl->met_dx, ctl->met_dy,
+    ctl->met_dp, ctl->met_sx, ctl->met_sy, ctl->met_sp, ctl->met_tropo,
+    ctl->met_h2o, ctl->met_o3, ctl->met_cloud, ctl->met_z, ctl->met_pv
+  };
+
+  double dparam[6] = { ctl->met_lon0, ctl->met_lon1, ctl->met_lat0,
+    ctl->met_lat1, ctl->met_z0, ctl->met_z1
+  };
+
+  unsigned long key = 14695981039346656037UL;
+
+  size_t i;
+
+  /* Get modification time and size of source file... */
+  if (stat(filename, &st) == 0) {
+    fparam[0] = (long) st.st_mtime;
+    fparam[1] = (long) st.st_size;
+  }
+
+  /* Hash file name, file status, and preprocessing parameters (FNV-1a)... */
+  for (i = 0; i < strlen(filename); i++)
+    key = (key ^ (unsigned char) filename[i]) * 1099511628211UL;
+  for (i = 0; i < sizeof(fparam); i++)
+    key = (key ^ ((unsigned char *) fparam)[i]) * 1099511628211UL;
+  for (i = 0; i < sizeof(iparam); i++)
+    key = (key ^ ((unsigned char *) iparam)[i]) * 1099511628211UL;
+  for (i = 0; i < sizeof(dparam); i++)
+    key = (key ^ ((unsigned char *) dparam)[i]) * 1099511628211UL;
+  for (i = 0; i < (size_t) ctl->met_np * sizeof(double); i++)
+    key = (key ^ ((unsigned char *) ctl->met_p)[i]) * 1099511628211UL;
+
+  /* Set filename... */
+  base = strrchr(filename, '/');
+  sprintf(cachefile, "%s/%s.%016lx.bin", ctl->met_cache,
+	  base ? base + 1 : filename, key);
+
+  return key;
+}
+
+/*****************************************************************************/
+
 void read_met_cloud(
   met_t * met) {
 
@@ -2636,24 +5097,28 @@ void read_met_cloud(
     for (iy = 0; iy < met->ny; iy++) {
 
       /* Init... */
-      met->pc[ix][iy] = GSL_NAN;
-      met->cl[ix][iy] = 0;
+      met->pc[ARRAY_2D(ix, iy, met->ey)] = GSL_NAN;
+      met->cl[ARRAY_2D(ix, iy, met->ey)] = 0;
 
       /* Loop over pressure levels... */
       for (ip = 0; ip < met->np - 1; ip++) {
 
 	/* Check pressure... */
-	if (met->p[ip] > met->ps[ix][iy] || met->p[ip] < P(20.))
+	if (met->p[ip] > met->ps[ARRAY_2D(ix, iy, met->ey)]
+	    || met->p[ip] < P(20.))
 	  continue;
 
 	/* Get cloud top pressure ... */
-	if (met->iwc[ix][iy][ip] > 0 || met->lwc[ix][iy][ip] > 0)
-	  met->pc[ix][iy] = (float) met->p[ip + 1];
+	if (met->iwc[ARRAY_3D(ix, iy, met->ey, ip, met->ep)] > 0
+	    || met->lwc[ARRAY_3D(ix, iy, met->ey, ip, met->ep)] > 0)
+	  met->pc[ARRAY_2D(ix, iy, met->ey)] = (float) met->p[ip + 1];
 
 	/* Get cloud water... */
-	met->cl[ix][iy] += (float)
-	  (0.5 * (met->iwc[ix][iy][ip] + met->iwc[ix][iy][ip + 1]
-		  + met->lwc[ix][iy][ip] + met->lwc[ix][iy][ip + 1])
+	met->cl[ARRAY_2D(ix, iy, met->ey)] += (float)
+	  (0.5 * (met->iwc[ARRAY_3D(ix, iy, met->ey, ip, met->ep)]
+		  + met->iwc[ARRAY_3D(ix, iy, met->ey, ip + 1, met->ep)]
+		  + met->lwc[ARRAY_3D(ix, iy, met->ey, ip, met->ep)]
+		  + met->lwc[ARRAY_3D(ix, iy, met->ey, ip + 1, met->ep)])
 	   * 100. * (met->p[ip] - met->p[ip + 1]) / G0);
       }
     }
@@ -2673,22 +5138,30 @@ void read_met_extrapolate(
 
       /* Find lowest valid data point... */
       for (ip0 = met->np - 1; ip0 >= 0; ip0--)
-	if (!check_finite(met->t[ix][iy][ip0])
-	    || !check_finite(met->u[ix][iy][ip0])
-	    || !check_finite(met->v[ix][iy][ip0])
-	    || !check_finite(met->w[ix][iy][ip0]))
+	if (!check_finite(met->t[ARRAY_3D(ix, iy, met->ey, ip0, met->ep)])
+	    || !check_finite(met->uvw[3 * ARRAY_3D(ix, iy, met->ey, ip0,
+						   met->ep)])
+	    || !check_finite(met->uvw[3 * ARRAY_3D(ix, iy, met->ey, ip0,
+						   met->ep) + 1])
+	    || !check_finite(met->uvw[3 * ARRAY_3D(ix, iy, met->ey, ip0,
+						   met->ep) + 2]))
 	  break;
 
       /* Extrapolate... */
       for (ip = ip0; ip >= 0; ip--) {
-	met->t[ix][iy][ip] = met->t[ix][iy][ip + 1];
-	met->u[ix][iy][ip] = met->u[ix][iy][ip + 1];
-	met->v[ix][iy][ip] = met->v[ix][iy][ip + 1];
-	met->w[ix][iy][ip] = met->w[ix][iy][ip + 1];
-	met->h2o[ix][iy][ip] = met->h2o[ix][iy][ip + 1];
-	met->o3[ix][iy][ip] = met->o3[ix][iy][ip + 1];
-	met->lwc[ix][iy][ip] = met->lwc[ix][iy][ip + 1];
-	met->iwc[ix][iy][ip] = met->iwc[ix][iy][ip + 1];
+	met->t[ARRAY_3D(ix, iy, met->ey, ip, met->ep)]
+	  = met->t[ARRAY_3D(ix, iy, met->ey, ip + 1, met->ep)];
+	for (int ic = 0; ic < 3; ic++)
+	  met->uvw[3 * ARRAY_3D(ix, iy, met->ey, ip, met->ep) + ic]
+	    = met->uvw[3 * ARRAY_3D(ix, iy, met->ey, ip + 1, met->ep) + ic];
+	met->h2o[ARRAY_3D(ix, iy, met->ey, ip, met->ep)]
+	  = met->h2o[ARRAY_3D(ix, iy, met->ey, ip + 1, met->ep)];
+	met->o3[ARRAY_3D(ix, iy, met->ey, ip, met->ep)]
+	  = met->o3[ARRAY_3D(ix, iy, met->ey, ip + 1, met->ep)];
+	met->lwc[ARRAY_3D(ix, iy, met->ey, ip, met->ep)]
+	  = met->lwc[ARRAY_3D(ix, iy, met->ey, ip + 1, met->ep)];
+	met->iwc[ARRAY_3D(ix, iy, met->ey, ip, met->ep)]
+	  = met->iwc[ARRAY_3D(ix, iy, met->ey, ip + 1, met->ep)];
       }
     }
 }
@@ -2700,12 +5173,15 @@ void read_met_geopot(
 
   const int dx = 6, dy = 4;
 
-  static float help[EX][EY][EP];
+  float *help;
 
   double logp[EP], ts, z0, cw[3];
 
   int ip, ip0, ix, ix2, ix3, iy, iy2, n, ci[3];
 
+  /* Allocate... */
+  ALLOC(help, float, met->ex * met->ey * met->ep);
+
   /* Calculate log pressure... */
   for (ip = 0; ip < met->np; ip++)
     logp[ip] = log(met->p[ip]);
@@ -2715,7 +5191,7 @@ void read_met_geopot(
   for (ix = 0; ix < met->nx; ix++)
     for (iy = 0; iy < met->ny; iy++)
       for (ip = 0; ip < met->np; ip++)
-	met->z[ix][iy][ip] = GSL_NAN;
+	met->z[ARRAY_3D(ix, iy, met->ey, ip, met->ep)] = GSL_NAN;
 
   /* Apply hydrostatic equation to calculate geopotential heights... */
 #pragma omp parallel for default(shared) private(ix,iy,z0,ip0,ts,ip,ci,cw)
@@ -2727,62 +5203,254 @@ void read_met_geopot(
 			  cw, 1);
 
       /* Find surface pressure level index... */
-      ip0 = locate_irr(met->p, met->np, met->ps[ix][iy]);
+      ip0 = locate_irr(met->p, met->np, met->ps[ARRAY_2D(ix, iy, met->ey)]);
 
       /* Get virtual temperature at the surface... */
       ts =
 	LIN(met->p[ip0],
-	    TVIRT(met->t[ix][iy][ip0], met->h2o[ix][iy][ip0]),
+	    TVIRT(met->t[ARRAY_3D(ix, iy, met->ey, ip0, met->ep)],
+		  met->h2o[ARRAY_3D(ix, iy, met->ey, ip0, met->ep)]),
 	    met->p[ip0 + 1],
-	    TVIRT(met->t[ix][iy][ip0 + 1], met->h2o[ix][iy][ip0 + 1]),
-	    met->ps[ix][iy]);
+	    TVIRT(met->t[ARRAY_3D(ix, iy, met->ey, ip0 + 1, met->ep)],
+		  met->h2o[ARRAY_3D(ix, iy, met->ey, ip0 + 1, met->ep)]),
+	    met->ps[ARRAY_2D(ix, iy, met->ey)]);
 
       /* Upper part of profile... */
-      met->z[ix][iy][ip0 + 1]
+      met->z[ARRAY_3D(ix, iy, met->ey, ip0 + 1, met->ep)]
 	= (float) (z0 + RI / MA / G0 * 0.5
-		   * (ts + TVIRT(met->t[ix][iy][ip0 + 1],
-				 met->h2o[ix][iy][ip0 + 1]))
-		   * (log(met->ps[ix][iy]) - logp[ip0 + 1]));
+		   * (ts + TVIRT(met->t[ARRAY_3D(ix, iy, met->ey, ip0 + 1,
+						 met->ep)],
+				 met->h2o[ARRAY_3D(ix, iy, met->ey, ip0 + 1,
+						   met->ep)]))
+		   * (log(met->ps[ARRAY_2D(ix, iy, met->ey)])
+		      - logp[ip0 + 1]));
       for (ip = ip0 + 2; ip < met->np; ip++)
-	met->z[ix][iy][ip]
-	  = (float) (met->z[ix][iy][ip - 1] + RI / MA / G0 * 0.5 *
-		     (TVIRT(met->t[ix][iy][ip - 1], met->h2o[ix][iy][ip - 1])
-		      + TVIRT(met->t[ix][iy][ip], met->h2o[ix][iy][ip]))
+	met->z[ARRAY_3D(ix, iy, met->ey, ip, met->ep)]
+	  = (float) (met->z[ARRAY_3D(ix, iy, met->ey, ip - 1, met->ep)]
+		     + RI / MA / G0 * 0.5 *
+		     (TVIRT(met->t[ARRAY_3D(ix, iy, met->ey, ip - 1, met->ep)],
+			    met->h2o[ARRAY_3D(ix, iy, met->ey, ip - 1,
+					      met->ep)])
+		      + TVIRT(met->t[ARRAY_3D(ix, iy, met->ey, ip, met->ep)],
+			      met->h2o[ARRAY_3D(ix, iy, met->ey, ip,
+						met->ep)]))
 		     * (logp[ip - 1] - logp[ip]));
     }
 
-  /* Horizontal smoothing... */
+  /* Horizontal smoothing (wrap around only for global grids)... */
+  int periodic = (fabs(met->lon[met->nx - 1] - met->lon[0] - 360) < 0.01);
 #pragma omp parallel for default(shared) private(ix,iy,ip,n,ix2,ix3,iy2)
   for (ix = 0; ix < met->nx; ix++)
     for (iy = 0; iy < met->ny; iy++)
       for (ip = 0; ip < met->np; ip++) {
 	n = 0;
-	help[ix][iy][ip] = 0;
+	help[ARRAY_3D(ix, iy, met->ey, ip, met->ep)] = 0;
 	for (ix2 = ix - dx; ix2 <= ix + dx; ix2++) {
 	  ix3 = ix2;
 	  if (ix3 < 0)
 	    ix3 += met->nx;
 	  else if (ix3 >= met->nx)
 	    ix3 -= met->nx;
+	  if (!periodic && ix3 != ix2)
+	    continue;
 	  for (iy2 = GSL_MAX(iy - dy, 0);
 	       iy2 <= GSL_MIN(iy + dy, met->ny - 1); iy2++)
-	    if (check_finite(met->z[ix3][iy2][ip])) {
-	      help[ix][iy][ip] += met->z[ix3][iy2][ip];
+	    if (check_finite(met->z[ARRAY_3D(ix3, iy2, met->ey, ip,
+					     met->ep)])) {
+	      help[ARRAY_3D(ix, iy, met->ey, ip, met->ep)]
+		+= met->z[ARRAY_3D(ix3, iy2, met->ey, ip, met->ep)];
 	      n++;
 	    }
 	}
 	if (n > 0)
-	  help[ix][iy][ip] /= (float) n;
+	  help[ARRAY_3D(ix, iy, met->ey, ip, met->ep)] /= (float) n;
 	else
-	  help[ix][iy][ip] = GSL_NAN;
+	  help[ARRAY_3D(ix, iy, met->ey, ip, met->ep)] = GSL_NAN;
       }
 
-  /* Copy data... */
-#pragma omp parallel for default(shared) private(ix,iy,ip)
-  for (ix = 0; ix < met->nx; ix++)
-    for (iy = 0; iy < met->ny; iy++)
-      for (ip = 0; ip < met->np; ip++)
-	met->z[ix][iy][ip] = help[ix][iy][ip];
+  /* Copy data... */
+#pragma omp parallel for default(shared) private(ix,iy,ip)
+  for (ix = 0; ix < met->nx; ix++)
+    for (iy = 0; iy < met->ny; iy++)
+      for (ip = 0; ip < met->np; ip++)
+	met->z[ARRAY_3D(ix, iy, met->ey, ip, met->ep)]
+	  = help[ARRAY_3D(ix, iy, met->ey, ip, met->ep)];
+
+  /* Free... */
+  free(help);
+}
+
+/*****************************************************************************/
+
+void read_met_grid(
+  ctl_t * ctl,
+  int ncid,
+  char *levname,
+  met_t * met) {
+
+  double lon[EX], lat[EY], p[EP], z[EP], dlon, shift;
+
+  int dimid, varid, i, i0, i1, n;
+
+  size_t np, nx, ny;
+
+  /* Get dimensions... */
+  NC(nc_inq_dimid(ncid, "lon", &dimid));
+  NC(nc_inq_dimlen(ncid, dimid, &nx));
+  if (nx < 2 || nx > EX)
+    ERRMSG("Number of longitudes out of range!");
+
+  NC(nc_inq_dimid(ncid, "lat", &dimid));
+  NC(nc_inq_dimlen(ncid, dimid, &ny));
+  if (ny < 2 || ny > EY)
+    ERRMSG("Number of latitudes out of range!");
+
+  sprintf(levname, "lev");
+  NC(nc_inq_dimid(ncid, levname, &dimid));
+  NC(nc_inq_dimlen(ncid, dimid, &np));
+  if (np == 1) {
+    sprintf(levname, "lev_2");
+    NC(nc_inq_dimid(ncid, levname, &dimid));
+    NC(nc_inq_dimlen(ncid, dimid, &np));
+  }
+  if (np < 2 || np > EP)
+    ERRMSG("Number of levels out of range!");
+
+  /* Get grid... */
+  NC(nc_inq_varid(ncid, "lon", &varid));
+  NC(nc_get_var_double(ncid, varid, lon));
+  NC(nc_inq_varid(ncid, "lat", &varid));
+  NC(nc_get_var_double(ncid, varid, lat));
+  if (ctl->met_np <= 0) {
+    NC(nc_inq_varid(ncid, levname, &varid));
+    NC(nc_get_var_double(ncid, varid, p));
+  }
+
+  /* Select longitudes... */
+  met->nxf = (int) nx;
+  dlon = lon[1] - lon[0];
+  shift = 0;
+  if (ctl->met_lon1 - ctl->met_lon0 >= 360 - dlon) {
+    i0 = 0;
+    n = (int) nx;
+  }
+
+  /* Subsets of global grids may wrap around the globe... */
+  else if (fabs(lon[nx - 1] - lon[0] + dlon - 360) < 0.01) {
+    for (i0 = 0, i = 1; i < (int) nx; i++)
+      if (fmod(lon[i] - ctl->met_lon0 + 720, 360)
+	  < fmod(lon[i0] - ctl->met_lon0 + 720, 360))
+	i0 = i;
+    i0 = (i0 + (int) nx - 1) % (int) nx;
+    shift = ctl->met_lon0 - fmod(ctl->met_lon0 - lon[i0] + 720, 360)
+      - lon[i0];
+    for (n = 1; n < (int) nx
+	 && lon[(i0 + n - 1) % (int) nx] + shift
+	 + (i0 + n - 1 >= (int) nx ? 360 : 0) < ctl->met_lon1; n++);
+  }
+
+  /* Subsets of regional grids... */
+  else {
+    read_met_grid_range(lon, (int) nx, ctl->met_lon0, ctl->met_lon1, &i0,
+			&i1);
+    n = i1 - i0 + 1;
+  }
+  met->sub[0] = i0;
+  met->nx = n;
+  for (i = 0; i < n; i++)
+    met->lon[i] = lon[(i0 + i) % (int) nx] + shift
+      + (i0 + i >= (int) nx ? 360 : 0);
+  if (met->nx < 2)
+    ERRMSG("Longitude range of meteo data subset is too small!");
+
+  /* Select latitudes... */
+  read_met_grid_range(lat, (int) ny, ctl->met_lat0, ctl->met_lat1, &i0,
+		      &i1);
+  met->sub[1] = i0;
+  met->ny = i1 - i0 + 1;
+  for (i = 0; i < met->ny; i++)
+    met->lat[i] = lat[i0 + i];
+  if (met->ny < 2)
+    ERRMSG("Latitude range of meteo data subset is too small!");
+
+  /* Select pressure levels (not for model levels)... */
+  met->sub[2] = 0;
+  met->np = (int) np;
+  if (ctl->met_np <= 0) {
+    for (i = 0; i < (int) np; i++) {
+      p[i] /= 100.;
+      z[i] = Z(p[i]);
+    }
+    read_met_grid_range(z, (int) np, ctl->met_z0, ctl->met_z1, &i0, &i1);
+    met->sub[2] = i0;
+    met->np = i1 - i0 + 1;
+    for (i = 0; i < met->np; i++)
+      met->p[i] = p[i0 + i];
+    if (met->np < 2)
+      ERRMSG("Level range of meteo data subset is too small!");
+  }
+}
+
+/*****************************************************************************/
+
+void read_met_grid_range(
+  double *x,
+  int n,
+  double x0,
+  double x1,
+  int *i0,
+  int *i1) {
+
+  /* Find first and last grid intervals overlapping the range... */
+  for (*i0 = 0; *i0 < n - 1
+       && !(GSL_MAX(x[*i0], x[*i0 + 1]) > x0
+	    && GSL_MIN(x[*i0], x[*i0 + 1]) < x1); (*i0)++);
+  for (*i1 = n - 1; *i1 > 0
+       && !(GSL_MAX(x[*i1 - 1], x[*i1]) > x0
+	    && GSL_MIN(x[*i1 - 1], x[*i1]) < x1); (*i1)--);
+}
+
+/*****************************************************************************/
+
+/*! Read subset of netCDF variable (one or two parts in longitude). */
+static void read_met_help_read(
+  int ncid,
+  int varid,
+  met_t * met,
+  int np,
+  float *help) {
+
+  size_t start[NC_MAX_VAR_DIMS], count[NC_MAX_VAR_DIMS];
+
+  int d, ndims, na = GSL_MIN(met->nx, met->nxf - met->sub[0]);
+
+  /* Set hyperslab (leading dimensions like time at first index)... */
+  NC(nc_inq_varndims(ncid, varid, &ndims));
+  if (ndims < (np > 0 ? 3 : 2))
+    ERRMSG("Meteo variable has too few dimensions!");
+  for (d = 0; d < ndims; d++) {
+    start[d] = 0;
+    count[d] = 1;
+  }
+  if (np > 0) {
+    start[ndims - 3] = (size_t) met->sub[2];
+    count[ndims - 3] = (size_t) np;
+  }
+  start[ndims - 2] = (size_t) met->sub[1];
+  count[ndims - 2] = (size_t) met->ny;
+  start[ndims - 1] = (size_t) met->sub[0];
+  count[ndims - 1] = (size_t) na;
+
+  /* Read eastern part up to the end of the file grid... */
+  NC(nc_get_vara_float(ncid, varid, start, count, help));
+
+  /* Read part wrapped around the globe... */
+  if (na < met->nx) {
+    start[ndims - 1] = 0;
+    count[ndims - 1] = (size_t) (met->nx - na);
+    NC(nc_get_vara_float(ncid, varid, start, count,
+			 help + GSL_MAX(np, 1) * met->ny * na));
+  }
 }
 
 /*****************************************************************************/
@@ -2792,12 +5460,13 @@ int read_met_help_3d(
   char *varname,
   char *varname2,
   met_t * met,
-  float dest[EX][EY][EP],
-  float scl) {
+  float *dest,
+  float scl,
+  int stride) {
 
   float *help;
 
-  int ip, ix, iy, varid;
+  int ip, ix, iy, varid, na = GSL_MIN(met->nx, met->nxf - met->sub[0]);
 
   /* Check if variable exists... */
   if (nc_inq_varid(ncid, varname, &varid) != NC_NOERR)
@@ -2805,22 +5474,26 @@ int read_met_help_3d(
       return 0;
 
   /* Allocate... */
-  ALLOC(help, float, EX * EY * EP);
+  ALLOC(help, float, met->nx * met->ny * met->np);
 
   /* Read data... */
-  NC(nc_get_var_float(ncid, varid, help));
+  read_met_help_read(ncid, varid, met, met->np, help);
 
   /* Copy and check data... */
 #pragma omp parallel for default(shared) private(ix,iy,ip)
-  for (ix = 0; ix < met->nx; ix++)
+  for (ix = 0; ix < met->nx; ix++) {
+    float *h = (ix < na ? help : help + met->np * met->ny * na);
+    int jx = (ix < na ? ix : ix - na), nh = (ix < na ? na : met->nx - na);
     for (iy = 0; iy < met->ny; iy++)
       for (ip = 0; ip < met->np; ip++) {
-	dest[ix][iy][ip] = help[(ip * met->ny + iy) * met->nx + ix];
-	if (fabsf(dest[ix][iy][ip]) < 1e14f)
-	  dest[ix][iy][ip] *= scl;
+	float *d = &dest[stride * ARRAY_3D(ix, iy, met->ey, ip, met->ep)];
+	*d = h[(ip * met->ny + iy) * nh + jx];
+	if (fabsf(*d) < 1e14f)
+	  *d *= scl;
 	else
-	  dest[ix][iy][ip] = GSL_NAN;
+	  *d = GSL_NAN;
       }
+  }
 
   /* Free... */
   free(help);
@@ -2836,12 +5509,12 @@ int read_met_help_2d(
   char *varname,
   char *varname2,
   met_t * met,
-  float dest[EX][EY],
+  float *dest,
   float scl) {
 
   float *help;
 
-  int ix, iy, varid;
+  int ix, iy, varid, na = GSL_MIN(met->nx, met->nxf - met->sub[0]);
 
   /* Check if variable exists... */
   if (nc_inq_varid(ncid, varname, &varid) != NC_NOERR)
@@ -2849,21 +5522,24 @@ int read_met_help_2d(
       return 0;
 
   /* Allocate... */
-  ALLOC(help, float, EX * EY);
+  ALLOC(help, float, met->nx * met->ny);
 
   /* Read data... */
-  NC(nc_get_var_float(ncid, varid, help));
+  read_met_help_read(ncid, varid, met, 0, help);
 
   /* Copy and check data... */
 #pragma omp parallel for default(shared) private(ix,iy)
-  for (ix = 0; ix < met->nx; ix++)
+  for (ix = 0; ix < met->nx; ix++) {
+    float *h = (ix < na ? help : help + met->ny * na);
+    int jx = (ix < na ? ix : ix - na), nh = (ix < na ? na : met->nx - na);
     for (iy = 0; iy < met->ny; iy++) {
-      dest[ix][iy] = help[iy * met->nx + ix];
-      if (fabsf(dest[ix][iy]) < 1e14f)
-	dest[ix][iy] *= scl;
+      dest[ARRAY_2D(ix, iy, met->ey)] = h[iy * nh + jx];
+      if (fabsf(dest[ARRAY_2D(ix, iy, met->ey)]) < 1e14f)
+	dest[ARRAY_2D(ix, iy, met->ey)] *= scl;
       else
-	dest[ix][iy] = GSL_NAN;
+	dest[ARRAY_2D(ix, iy, met->ey)] = GSL_NAN;
     }
+  }
 
   /* Free... */
   free(help);
@@ -2874,10 +5550,100 @@ int read_met_help_2d(
 
 /*****************************************************************************/
 
+/*! State of the meteo file list reader thread. */
+static struct {
+  pthread_t thread;
+  ctl_t *ctl;
+  met_t *met[2];
+  char *filename;
+  int active, ifile, status;
+} met_list;
+
+static void *read_met_list_read(
+  void *arg) {
+
+  /* Read and preprocess data... */
+  met_list.status =
+    read_met(met_list.ctl, met_list.filename, met_list.met[1]);
+
+  return arg;
+}
+
+/*****************************************************************************/
+
+int read_met_list(
+  ctl_t * ctl,
+  int nfile,
+  char *files[],
+  int *ifile,
+  met_t ** met) {
+
+  met_t *mets;
+
+  /* Start with first file... */
+  if (*ifile < 0) {
+    if (!met_list.met[0]) {
+      ALLOC(met_list.met[0], met_t, 1);
+      ALLOC(met_list.met[1], met_t, 1);
+    }
+    met_list.ctl = ctl;
+    met_list.ifile = -1;
+  }
+
+  /* Loop until a file could be read... */
+  for (;;) {
+
+    /* Wait for reader thread or read first file directly... */
+    if (met_list.active) {
+      if (pthread_join(met_list.thread, NULL) != 0)
+	ERRMSG("Cannot join reader thread!");
+      met_list.active = 0;
+    } else if (met_list.ifile < 0 && nfile > 0) {
+      met_list.ifile = 0;
+      met_list.filename = files[0];
+      read_met_list_read(NULL);
+    } else {
+      free_met(met_list.met[0]);
+      free_met(met_list.met[1]);
+      free(met_list.met[0]);
+      free(met_list.met[1]);
+      met_list.met[0] = met_list.met[1] = NULL;
+      *met = NULL;
+      return 0;
+    }
+
+    /* Swap buffers... */
+    mets = met_list.met[0];
+    met_list.met[0] = met_list.met[1];
+    met_list.met[1] = mets;
+    *ifile = met_list.ifile;
+    int status = met_list.status;
+
+    /* Start reading next file... */
+    if (met_list.ifile + 1 < nfile) {
+      met_list.ifile++;
+      met_list.filename = files[met_list.ifile];
+      met_list.active = 1;
+      if (pthread_create(&met_list.thread, NULL, read_met_list_read, NULL)
+	  != 0)
+	ERRMSG("Cannot create reader thread!");
+    }
+
+    /* Return data... */
+    if (status) {
+      *met = met_list.met[0];
+      return 1;
+    }
+  }
+}
+
+/*****************************************************************************/
+
 void read_met_ml2pl(
   ctl_t * ctl,
   met_t * met,
-  float var[EX][EY][EP]) {
+  float *var,
+  int stride) {
 
   double aux[EP], p[EP], pt;
 
@@ -2890,7 +5656,7 @@ void read_met_ml2pl(
 
       /* Copy pressure profile... */
       for (ip = 0; ip < met->np; ip++)
-	p[ip] = met->pl[ix][iy][ip];
+	p[ip] = met->pl[ARRAY_3D(ix, iy, met->ey, ip, met->ep)];
 
       /* Interpolate... */
       for (ip = 0; ip < ctl->met_np; ip++) {
@@ -2901,13 +5667,15 @@ void read_met_ml2pl(
 		 || (pt < p[met->np - 1] && p[1] < p[0]))
 	  pt = p[met->np - 1];
 	ip2 = locate_irr(p, met->np, pt);
-	aux[ip] = LIN(p[ip2], var[ix][iy][ip2],
-		      p[ip2 + 1], var[ix][iy][ip2 + 1], pt);
+	aux[ip] =
+	  LIN(p[ip2], var[stride * ARRAY_3D(ix, iy, met->ey, ip2, met->ep)],
+	      p[ip2 + 1],
+	      var[stride * ARRAY_3D(ix, iy, met->ey, ip2 + 1, met->ep)], pt);
       }
 
       /* Copy data... */
       for (ip = 0; ip < ctl->met_np; ip++)
-	var[ix][iy][ip] = (float) aux[ip];
+	var[stride * ARRAY_3D(ix, iy, met->ey, ip, met->ep)] = (float) aux[ip];
     }
 }
 
@@ -2922,7 +5690,7 @@ void read_met_periodic(
     return;
 
   /* Increase longitude counter... */
-  if ((++met->nx) > EX)
+  if ((++met->nx) > met->ex)
     ERRMSG("Cannot create periodic boundary conditions!");
 
   /* Set longitude... */
@@ -2931,29 +5699,53 @@ void read_met_periodic(
   /* Loop over latitudes and pressure levels... */
 #pragma omp parallel for default(shared)
   for (int iy = 0; iy < met->ny; iy++) {
-    met->ps[met->nx - 1][iy] = met->ps[0][iy];
-    met->zs[met->nx - 1][iy] = met->zs[0][iy];
+    met->ps[ARRAY_2D(met->nx - 1, iy, met->ey)]
+      = met->ps[ARRAY_2D(0, iy, met->ey)];
+    met->zs[ARRAY_2D(met->nx - 1, iy, met->ey)]
+      = met->zs[ARRAY_2D(0, iy, met->ey)];
     for (int ip = 0; ip < met->np; ip++) {
-      met->t[met->nx - 1][iy][ip] = met->t[0][iy][ip];
-      met->u[met->nx - 1][iy][ip] = met->u[0][iy][ip];
-      met->v[met->nx - 1][iy][ip] = met->v[0][iy][ip];
-      met->w[met->nx - 1][iy][ip] = met->w[0][iy][ip];
-      met->h2o[met->nx - 1][iy][ip] = met->h2o[0][iy][ip];
-      met->o3[met->nx - 1][iy][ip] = met->o3[0][iy][ip];
-      met->lwc[met->nx - 1][iy][ip] = met->lwc[0][iy][ip];
-      met->iwc[met->nx - 1][iy][ip] = met->iwc[0][iy][ip];
+      met->t[ARRAY_3D(met->nx - 1, iy, met->ey, ip, met->ep)]
+	= met->t[ARRAY_3D(0, iy, met->ey, ip, met->ep)];
+      for (int ic = 0; ic < 3; ic++)
+	met->uvw[3 * ARRAY_3D(met->nx - 1, iy, met->ey, ip, met->ep) + ic]
+	  = met->uvw[3 * ARRAY_3D(0, iy, met->ey, ip, met->ep) + ic];
+      met->h2o[ARRAY_3D(met->nx - 1, iy, met->ey, ip, met->ep)]
+	= met->h2o[ARRAY_3D(0, iy, met->ey, ip, met->ep)];
+      met->o3[ARRAY_3D(met->nx - 1, iy, met->ey, ip, met->ep)]
+	= met->o3[ARRAY_3D(0, iy, met->ey, ip, met->ep)];
+      met->lwc[ARRAY_3D(met->nx - 1, iy, met->ey, ip, met->ep)]
+	= met->lwc[ARRAY_3D(0, iy, met->ey, ip, met->ep)];
+      met->iwc[ARRAY_3D(met->nx - 1, iy, met->ey, ip, met->ep)]
+	= met->iwc[ARRAY_3D(0, iy, met->ey, ip, met->ep)];
     }
   }
 }
 
 /*****************************************************************************/
 
+void read_met_plut(
+  met_t * met) {
+
+  /* Set bins of log-pressure between the outermost levels... */
+  met->plut0 = log(met->p[met->np - 1]);
+  met->plutd = (NPLUT - 1) / (log(met->p[0]) - met->plut0);
+
+  /* Get level index at the lower edge of each bin... */
+  for (int i = 0; i < NPLUT; i++)
+    met->plut[i] =
+      locate_irr(met->p, met->np, exp(met->plut0 + i / met->plutd));
+}
+
+/*****************************************************************************/
+
 void read_met_pv(
   met_t * met) {
 
   double c0, c1, cr, dx, dy, dp0, dp1, denom, dtdx, dvdx, dtdy, dudy,
     dtdp, dudp, dvdp, latr, vort, pows[EP];
 
+  float *u = met->uvw, *v = met->uvw + 1;
+
   int ip, ip0, ip1, ix, ix0, ix1, iy, iy0, iy1;
 
   /* Set powers... */
@@ -2988,12 +5780,18 @@ void read_met_pv(
       for (ip = 0; ip < met->np; ip++) {
 
 	/* Get gradients in longitude... */
-	dtdx = (met->t[ix1][iy][ip] - met->t[ix0][iy][ip]) * pows[ip] / dx;
-	dvdx = (met->v[ix1][iy][ip] - met->v[ix0][iy][ip]) / dx;
+	dtdx = (met->t[ARRAY_3D(ix1, iy, met->ey, ip, met->ep)]
+		- met->t[ARRAY_3D(ix0, iy, met->ey, ip, met->ep)]) * pows[ip]
+		/ dx;
+	dvdx = (v[3 * ARRAY_3D(ix1, iy, met->ey, ip, met->ep)]
+		- v[3 * ARRAY_3D(ix0, iy, met->ey, ip, met->ep)]) / dx;
 
 	/* Get gradients in latitude... */
-	dtdy = (met->t[ix][iy1][ip] - met->t[ix][iy0][ip]) * pows[ip] / dy;
-	dudy = (met->u[ix][iy1][ip] * c1 - met->u[ix][iy0][ip] * c0) / dy;
+	dtdy = (met->t[ARRAY_3D(ix, iy1, met->ey, ip, met->ep)]
+		- met->t[ARRAY_3D(ix, iy0, met->ey, ip, met->ep)]) * pows[ip]
+		/ dy;
+	dudy = (u[3 * ARRAY_3D(ix, iy1, met->ey, ip, met->ep)] * c1
+		- u[3 * ARRAY_3D(ix, iy0, met->ey, ip, met->ep)] * c0) / dy;
 
 	/* Set indices... */
 	ip0 = GSL_MAX(ip - 1, 0);
@@ -3004,29 +5802,37 @@ void read_met_pv(
 	dp1 = 100. * (met->p[ip1] - met->p[ip]);
 	if (ip != ip0 && ip != ip1) {
 	  denom = dp0 * dp1 * (dp0 + dp1);
-	  dtdp = (dp0 * dp0 * met->t[ix][iy][ip1] * pows[ip1]
-		  - dp1 * dp1 * met->t[ix][iy][ip0] * pows[ip0]
-		  + (dp1 * dp1 - dp0 * dp0) * met->t[ix][iy][ip] * pows[ip])
+	  dtdp = (dp0 * dp0 * met->t[ARRAY_3D(ix, iy, met->ey, ip1, met->ep)]
+		  * pows[ip1]
+		  - dp1 * dp1 * met->t[ARRAY_3D(ix, iy, met->ey, ip0, met->ep)]
+		  * pows[ip0]
+		  + (dp1 * dp1 - dp0 * dp0)
+		  * met->t[ARRAY_3D(ix, iy, met->ey, ip, met->ep)] * pows[ip])
 	    / denom;
-	  dudp = (dp0 * dp0 * met->u[ix][iy][ip1]
-		  - dp1 * dp1 * met->u[ix][iy][ip0]
-		  + (dp1 * dp1 - dp0 * dp0) * met->u[ix][iy][ip])
+	  dudp = (dp0 * dp0 * u[3 * ARRAY_3D(ix, iy, met->ey, ip1, met->ep)]
+		  - dp1 * dp1 * u[3 * ARRAY_3D(ix, iy, met->ey, ip0, met->ep)]
+		  + (dp1 * dp1 - dp0 * dp0)
+		  * u[3 * ARRAY_3D(ix, iy, met->ey, ip, met->ep)])
 	    / denom;
-	  dvdp = (dp0 * dp0 * met->v[ix][iy][ip1]
-		  - dp1 * dp1 * met->v[ix][iy][ip0]
-		  + (dp1 * dp1 - dp0 * dp0) * met->v[ix][iy][ip])
+	  dvdp = (dp0 * dp0 * v[3 * ARRAY_3D(ix, iy, met->ey, ip1, met->ep)]
+		  - dp1 * dp1 * v[3 * ARRAY_3D(ix, iy, met->ey, ip0, met->ep)]
+		  + (dp1 * dp1 - dp0 * dp0)
+		  * v[3 * ARRAY_3D(ix, iy, met->ey, ip, met->ep)])
 	    / denom;
 	} else {
 	  denom = dp0 + dp1;
 	  dtdp =
-	    (met->t[ix][iy][ip1] * pows[ip1] -
-	     met->t[ix][iy][ip0] * pows[ip0]) / denom;
-	  dudp = (met->u[ix][iy][ip1] - met->u[ix][iy][ip0]) / denom;
-	  dvdp = (met->v[ix][iy][ip1] - met->v[ix][iy][ip0]) / denom;
+	    (met->t[ARRAY_3D(ix, iy, met->ey, ip1, met->ep)] * pows[ip1] -
+	     met->t[ARRAY_3D(ix, iy, met->ey, ip0, met->ep)] * pows[ip0])
+	       / denom;
+	  dudp = (u[3 * ARRAY_3D(ix, iy, met->ey, ip1, met->ep)]
+		  - u[3 * ARRAY_3D(ix, iy, met->ey, ip0, met->ep)]) / denom;
+	  dvdp = (v[3 * ARRAY_3D(ix, iy, met->ey, ip1, met->ep)]
+		  - v[3 * ARRAY_3D(ix, iy, met->ey, ip0, met->ep)]) / denom;
 	}
 
 	/* Calculate PV... */
-	met->pv[ix][iy][ip] = (float)
+	met->pv[ARRAY_3D(ix, iy, met->ey, ip, met->ep)] = (float)
 	  (1e6 * G0 *
 	   (-dtdp * (dvdx - dudy / cr + vort) + dvdp * dtdx - dudp * dtdy));
       }
@@ -3037,12 +5843,12 @@ void read_met_pv(
 #pragma omp parallel for default(shared) private(ix,ip)
   for (ix = 0; ix < met->nx; ix++)
     for (ip = 0; ip < met->np; ip++) {
-      met->pv[ix][0][ip]
-	= met->pv[ix][1][ip]
-	= met->pv[ix][2][ip];
-      met->pv[ix][met->ny - 1][ip]
-	= met->pv[ix][met->ny - 2][ip]
-	= met->pv[ix][met->ny - 3][ip];
+      met->pv[ARRAY_3D(ix, 0, met->ey, ip, met->ep)]
+	= met->pv[ARRAY_3D(ix, 1, met->ey, ip, met->ep)]
+	= met->pv[ARRAY_3D(ix, 2, met->ey, ip, met->ep)];
+      met->pv[ARRAY_3D(ix, met->ny - 1, met->ey, ip, met->ep)]
+	= met->pv[ARRAY_3D(ix, met->ny - 2, met->ey, ip, met->ep)]
+	= met->pv[ARRAY_3D(ix, met->ny - 3, met->ey, ip, met->ep)];
     }
 }
 
@@ -3052,113 +5858,116 @@ void read_met_sample(
   ctl_t * ctl,
   met_t * met) {
 
-  met_t *help;
+  float *f2[2] = { met->ps, met->zs }, *f3[8] = {
+  met->t, met->uvw, met->uvw + 1, met->uvw + 2}, *help, *help2;
 
-  float w, wsum;
+  int s3[8] = { 1, 3, 3, 3 };
 
-  int ip, ip2, ix, ix2, ix3, iy, iy2;
+  int dx = ctl->met_dx, dy = ctl->met_dy, dp = ctl->met_dp,
+    sx = ctl->met_sx, sy = ctl->met_sy, sp = ctl->met_sp, i, n2 = 2, n3 = 4;
 
   /* Check parameters... */
-  if (ctl->met_dp <= 1 && ctl->met_dx <= 1 && ctl->met_dy <= 1
-      && ctl->met_sp <= 1 && ctl->met_sx <= 1 && ctl->met_sy <= 1)
+  if (dp <= 1 && dx <= 1 && dy <= 1 && sp <= 1 && sx <= 1 && sy <= 1)
     return;
 
+  /* Get size of downsampled grid... */
+  int nx = (met->nx - 1) / dx + 1;
+  int ny = (met->ny - 1) / dy + 1;
+  int np = (met->np - 1) / dp + 1;
+
+  /* Select fields that have been read... */
+  if (ctl->met_h2o) {
+    s3[n3] = 1;
+    f3[n3++] = met->h2o;
+  }
+  if (ctl->met_o3) {
+    s3[n3] = 1;
+    f3[n3++] = met->o3;
+  }
+  if (ctl->met_cloud) {
+    s3[n3] = s3[n3 + 1] = 1;
+    f3[n3++] = met->lwc;
+    f3[n3++] = met->iwc;
+  }
+
   /* Allocate... */
-  ALLOC(help, met_t, 1);
+  ALLOC(help, float,
+	nx * met->ny * met->np);
+  ALLOC(help2, float,
+	nx * ny * met->np);
+
+  /* Smoothing (separable triangular filter, evaluated only at the
+     points of the downsampled grid)... */
+  for (i = 0; i < n2 + n3; i++) {
+
+    float *f = (i < n2 ? f2[i] : f3[i - n2]);
+    int mp = (i < n2 ? 1 : met->np), np2 = (i < n2 ? 1 : np);
+    int ep = (i < n2 ? 1 : met->ep), st = (i < n2 ? 1 : s3[i - n2]);
+
+    /* Filter in longitude (periodic)... */
+#pragma omp parallel for default(shared) collapse(2)
+    for (int ix = 0; ix < nx; ix++)
+      for (int iy = 0; iy < met->ny; iy++)
+	for (int ip = 0; ip < mp; ip++) {
+	  float sum = 0, wsum = 0;
+	  for (int ix2 = ix * dx - sx + 1; ix2 <= ix * dx + sx - 1; ix2++) {
+	    int ix3 = ix2;
+	    if (ix3 < 0)
+	      ix3 += met->nx;
+	    else if (ix3 >= met->nx)
+	      ix3 -= met->nx;
+	    float w = (float) (1.0 - fabs(ix * dx - ix2) / sx);
+	    sum += w * f[st * ARRAY_3D(ix3, iy, met->ey, ip, ep)];
+	    wsum += w;
+	  }
+	  help[ARRAY_3D(ix, iy, met->ny, ip, mp)] = sum / wsum;
+	}
 
-  /* Copy data... */
-  help->nx = met->nx;
-  help->ny = met->ny;
-  help->np = met->np;
-  memcpy(help->lon, met->lon, sizeof(met->lon));
-  memcpy(help->lat, met->lat, sizeof(met->lat));
-  memcpy(help->p, met->p, sizeof(met->p));
-
-  /* Smoothing... */
-  for (ix = 0; ix < met->nx; ix += ctl->met_dx) {
-    for (iy = 0; iy < met->ny; iy += ctl->met_dy) {
-      for (ip = 0; ip < met->np; ip += ctl->met_dp) {
-	help->ps[ix][iy] = 0;
-	help->zs[ix][iy] = 0;
-	help->t[ix][iy][ip] = 0;
-	help->u[ix][iy][ip] = 0;
-	help->v[ix][iy][ip] = 0;
-	help->w[ix][iy][ip] = 0;
-	help->h2o[ix][iy][ip] = 0;
-	help->o3[ix][iy][ip] = 0;
-	help->lwc[ix][iy][ip] = 0;
-	help->iwc[ix][iy][ip] = 0;
-	wsum = 0;
-	for (ix2 = ix - ctl->met_sx + 1; ix2 <= ix + ctl->met_sx - 1; ix2++) {
-	  ix3 = ix2;
-	  if (ix3 < 0)
-	    ix3 += met->nx;
-	  else if (ix3 >= met->nx)
-	    ix3 -= met->nx;
+    /* Filter in latitude... */
+#pragma omp parallel for default(shared) collapse(2)
+    for (int ix = 0; ix < nx; ix++)
+      for (int iy = 0; iy < ny; iy++)
+	for (int ip = 0; ip < mp; ip++) {
+	  float sum = 0, wsum = 0;
+	  for (int iy2 = GSL_MAX(iy * dy - sy + 1, 0);
+	       iy2 <= GSL_MIN(iy * dy + sy - 1, met->ny - 1); iy2++) {
+	    float w = (float) (1.0 - fabs(iy * dy - iy2) / sy);
+	    sum += w * help[ARRAY_3D(ix, iy2, met->ny, ip, mp)];
+	    wsum += w;
+	  }
+	  help2[ARRAY_3D(ix, iy, ny, ip, mp)] = sum / wsum;
+	}
 
-	  for (iy2 = GSL_MAX(iy - ctl->met_sy + 1, 0);
-	       iy2 <= GSL_MIN(iy + ctl->met_sy - 1, met->ny - 1); iy2++)
-	    for (ip2 = GSL_MAX(ip - ctl->met_sp + 1, 0);
-		 ip2 <= GSL_MIN(ip + ctl->met_sp - 1, met->np - 1); ip2++) {
-	      w = (float) (1.0 - fabs(ix - ix2) / ctl->met_sx)
-		* (float) (1.0 - fabs(iy - iy2) / ctl->met_sy)
-		* (float) (1.0 - fabs(ip - ip2) / ctl->met_sp);
-	      help->ps[ix][iy] += w * met->ps[ix3][iy2];
-	      help->zs[ix][iy] += w * met->zs[ix3][iy2];
-	      help->t[ix][iy][ip] += w * met->t[ix3][iy2][ip2];
-	      help->u[ix][iy][ip] += w * met->u[ix3][iy2][ip2];
-	      help->v[ix][iy][ip] += w * met->v[ix3][iy2][ip2];
-	      help->w[ix][iy][ip] += w * met->w[ix3][iy2][ip2];
-	      help->h2o[ix][iy][ip] += w * met->h2o[ix3][iy2][ip2];
-	      help->o3[ix][iy][ip] += w * met->o3[ix3][iy2][ip2];
-	      help->lwc[ix][iy][ip] += w * met->lwc[ix3][iy2][ip2];
-	      help->iwc[ix][iy][ip] += w * met->iwc[ix3][iy2][ip2];
-	      wsum += w;
-	    }
+    /* Filter in pressure and store on downsampled grid... */
+#pragma omp parallel for default(shared) collapse(2)
+    for (int ix = 0; ix < nx; ix++)
+      for (int iy = 0; iy < ny; iy++)
+	for (int ip = 0; ip < np2; ip++) {
+	  float sum = 0, wsum = 0;
+	  for (int ip2 = GSL_MAX(ip * dp - sp + 1, 0);
+	       ip2 <= GSL_MIN(ip * dp + sp - 1, mp - 1); ip2++) {
+	    float w = (float) (1.0 - fabs(ip * dp - ip2) / sp);
+	    sum += w * help2[ARRAY_3D(ix, iy, ny, ip2, mp)];
+	    wsum += w;
+	  }
+	  f[st * ARRAY_3D(ix, iy, met->ey, ip, ep)] = sum / wsum;
 	}
-	help->ps[ix][iy] /= wsum;
-	help->zs[ix][iy] /= wsum;
-	help->t[ix][iy][ip] /= wsum;
-	help->u[ix][iy][ip] /= wsum;
-	help->v[ix][iy][ip] /= wsum;
-	help->w[ix][iy][ip] /= wsum;
-	help->h2o[ix][iy][ip] /= wsum;
-	help->o3[ix][iy][ip] /= wsum;
-	help->lwc[ix][iy][ip] /= wsum;
-	help->iwc[ix][iy][ip] /= wsum;
-      }
-    }
   }
 
-  /* Downsampling... */
-  met->nx = 0;
-  for (ix = 0; ix < help->nx; ix += ctl->met_dx) {
-    met->lon[met->nx] = help->lon[ix];
-    met->ny = 0;
-    for (iy = 0; iy < help->ny; iy += ctl->met_dy) {
-      met->lat[met->ny] = help->lat[iy];
-      met->ps[met->nx][met->ny] = help->ps[ix][iy];
-      met->zs[met->nx][met->ny] = help->zs[ix][iy];
-      met->np = 0;
-      for (ip = 0; ip < help->np; ip += ctl->met_dp) {
-	met->p[met->np] = help->p[ip];
-	met->t[met->nx][met->ny][met->np] = help->t[ix][iy][ip];
-	met->u[met->nx][met->ny][met->np] = help->u[ix][iy][ip];
-	met->v[met->nx][met->ny][met->np] = help->v[ix][iy][ip];
-	met->w[met->nx][met->ny][met->np] = help->w[ix][iy][ip];
-	met->h2o[met->nx][met->ny][met->np] = help->h2o[ix][iy][ip];
-	met->o3[met->nx][met->ny][met->np] = help->o3[ix][iy][ip];
-	met->lwc[met->nx][met->ny][met->np] = help->lwc[ix][iy][ip];
-	met->iwc[met->nx][met->ny][met->np] = help->iwc[ix][iy][ip];
-	met->np++;
-      }
-      met->ny++;
-    }
-    met->nx++;
-  }
+  /* Downsampling of coordinates... */
+  for (i = 0; i < nx; i++)
+    met->lon[i] = met->lon[i * dx];
+  for (i = 0; i < ny; i++)
+    met->lat[i] = met->lat[i * dy];
+  for (i = 0; i < np; i++)
+    met->p[i] = met->p[i * dp];
+  met->nx = nx;
+  met->ny = ny;
+  met->np = np;
 
   /* Free... */
   free(help);
+  free(help2);
 }
 
 /*****************************************************************************/
@@ -3175,11 +5984,12 @@ void read_met_surface(
       ERRMSG("Cannot not read surface pressure data!");
       for (ix = 0; ix < met->nx; ix++)
 	for (iy = 0; iy < met->ny; iy++)
-	  met->ps[ix][iy] = (float) met->p[0];
+	  met->ps[ARRAY_2D(ix, iy, met->ey)] = (float) met->p[0];
     } else {
       for (iy = 0; iy < met->ny; iy++)
 	for (ix = 0; ix < met->nx; ix++)
-	  met->ps[ix][iy] = (float) (exp(met->ps[ix][iy]) / 100.);
+	  met->ps[ARRAY_2D(ix, iy, met->ey)]
+	    = (float) (exp(met->ps[ARRAY_2D(ix, iy, met->ey)]) / 100.);
     }
   }
 
@@ -3214,14 +6024,15 @@ void read_met_tropo(
   if (ctl->met_tropo == 0)
     for (ix = 0; ix < met->nx; ix++)
       for (iy = 0; iy < met->ny; iy++)
-	met->pt[ix][iy] = GSL_NAN;
+	met->pt[ARRAY_2D(ix, iy, met->ey)] = GSL_NAN;
 
   /* Use tropopause climatology... */
   else if (ctl->met_tropo == 1) {
 #pragma omp parallel for default(shared) private(ix,iy)
     for (ix = 0; ix < met->nx; ix++)
       for (iy = 0; iy < met->ny; iy++)
-	met->pt[ix][iy] = (float) clim_tropo(met->time, met->lat[iy]);
+	met->pt[ARRAY_2D(ix, iy, met->ey)]
+	  = (float) clim_tropo(met->time, met->lat[iy]);
   }
 
   /* Use cold point... */
@@ -3234,15 +6045,15 @@ void read_met_tropo(
 
 	/* Interpolate temperature profile... */
 	for (iz = 0; iz < met->np; iz++)
-	  t[iz] = met->t[ix][iy][iz];
+	  t[iz] = met->t[ARRAY_3D(ix, iy, met->ey, iz, met->ep)];
 	spline(z, t, met->np, z2, t2, 171);
 
 	/* Find minimum... */
 	iz = (int) gsl_stats_min_index(t2, 1, 171);
 	if (iz > 0 && iz < 170)
-	  met->pt[ix][iy] = (float) p2[iz];
+	  met->pt[ARRAY_2D(ix, iy, met->ey)] = (float) p2[iz];
 	else
-	  met->pt[ix][iy] = GSL_NAN;
+	  met->pt[ARRAY_2D(ix, iy, met->ey)] = GSL_NAN;
       }
   }
 
@@ -3256,11 +6067,11 @@ void read_met_tropo(
 
 	/* Interpolate temperature profile... */
 	for (iz = 0; iz < met->np; iz++)
-	  t[iz] = met->t[ix][iy][iz];
+	  t[iz] = met->t[ARRAY_3D(ix, iy, met->ey, iz, met->ep)];
 	spline(z, t, met->np, z2, t2, 191);
 
 	/* Find 1st tropopause... */
-	met->pt[ix][iy] = GSL_NAN;
+	met->pt[ARRAY_2D(ix, iy, met->ey)] = GSL_NAN;
 	for (iz = 0; iz <= 170; iz++) {
 	  found = 1;
 	  for (iz2 = iz + 1; iz2 <= iz + 20; iz2++)
@@ -3271,14 +6082,14 @@ void read_met_tropo(
 	    }
 	  if (found) {
 	    if (iz > 0 && iz < 170)
-	      met->pt[ix][iy] = (float) p2[iz];
+	      met->pt[ARRAY_2D(ix, iy, met->ey)] = (float) p2[iz];
 	    break;
 	  }
 	}
 
 	/* Find 2nd tropopause... */
 	if (ctl->met_tropo == 4) {
-	  met->pt[ix][iy] = GSL_NAN;
+	  met->pt[ARRAY_2D(ix, iy, met->ey)] = GSL_NAN;
 	  for (; iz <= 170; iz++) {
 	    found = 1;
 	    for (iz2 = iz + 1; iz2 <= iz + 10; iz2++)
@@ -3300,7 +6111,7 @@ void read_met_tropo(
 	      }
 	    if (found) {
 	      if (iz > 0 && iz < 170)
-		met->pt[ix][iy] = (float) p2[iz];
+		met->pt[ARRAY_2D(ix, iy, met->ey)] = (float) p2[iz];
 	      break;
 	    }
 	  }
@@ -3318,20 +6129,21 @@ void read_met_tropo(
 
 	/* Interpolate potential vorticity profile... */
 	for (iz = 0; iz < met->np; iz++)
-	  pv[iz] = met->pv[ix][iy][iz];
+	  pv[iz] = met->pv[ARRAY_3D(ix, iy, met->ey, iz, met->ep)];
 	spline(z, pv, met->np, z2, pv2, 171);
 
 	/* Interpolate potential temperature profile... */
 	for (iz = 0; iz < met->np; iz++)
-	  th[iz] = THETA(met->p[iz], met->t[ix][iy][iz]);
+	  th[iz] = THETA(met->p[iz],
+			 met->t[ARRAY_3D(ix, iy, met->ey, iz, met->ep)]);
 	spline(z, th, met->np, z2, th2, 171);
 
 	/* Find dynamical tropopause 3.5 PVU + 380 K */
-	met->pt[ix][iy] = GSL_NAN;
+	met->pt[ARRAY_2D(ix, iy, met->ey)] = GSL_NAN;
 	for (iz = 0; iz <= 170; iz++)
 	  if (fabs(pv2[iz]) >= 3.5 || th2[iz] >= 380.) {
 	    if (iz > 0 && iz < 170)
-	      met->pt[ix][iy] = (float) p2[iz];
+	      met->pt[ARRAY_2D(ix, iy, met->ey)] = (float) p2[iz];
 	    break;
 	  }
       }
@@ -3343,6 +6155,75 @@ void read_met_tropo(
 
 /*****************************************************************************/
 
+void read_met_uvw16(
+  met_t * met) {
+
+  /* Allocate... */
+  if (!met->uvwh)
+    ALLOC(met->uvwh, short,
+	  3 * met->ex * met->ey * met->ep);
+
+  /* Get offsets and scaling factors of each level... */
+#pragma omp parallel for default(shared)
+  for (int ip = 0; ip < met->np; ip++)
+    for (int ic = 0; ic < 3; ic++) {
+      float vmin = FLT_MAX, vmax = -FLT_MAX;
+      for (int ix = 0; ix < met->nx; ix++)
+	for (int iy = 0; iy < met->ny; iy++) {
+	  float v = met->uvw[3 * ARRAY_3D(ix, iy, met->ey, ip, met->ep) + ic];
+	  vmin = GSL_MIN(vmin, v);
+	  vmax = GSL_MAX(vmax, v);
+	}
+      met->uvwo[ip][ic] = 0.5f * (vmin + vmax);
+      met->uvws[ip][ic] = (vmax > vmin ? (vmax - vmin) / 65534.f : 1.f);
+    }
+
+  /* Convert data... */
+#pragma omp parallel for default(shared)
+  for (int ix = 0; ix < met->nx; ix++)
+    for (int iy = 0; iy < met->ny; iy++)
+      for (int ip = 0; ip < met->np; ip++)
+	for (int ic = 0; ic < 3; ic++) {
+	  int idx = 3 * ARRAY_3D(ix, iy, met->ey, ip, met->ep) + ic;
+	  met->uvwh[idx] = (short) lrintf((met->uvw[idx] - met->uvwo[ip][ic])
+					  / met->uvws[ip][ic]);
+	}
+
+  /* Release float winds (mapped cache files are kept)... */
+  if (!met->map)
+    free(met->uvw);
+  met->uvw = NULL;
+}
+
+/*****************************************************************************/
+
+void round_bits(
+  double *x,
+  size_t n,
+  int nbits) {
+
+  /* Check number of bits... */
+  if (nbits <= 0 || nbits >= 52)
+    return;
+
+  /* Round to nearest (ties away from zero) and clear trailing bits... */
+  unsigned long long half = 1ULL << (51 - nbits),
+    mask = ~((1ULL << (52 - nbits)) - 1);
+#pragma omp parallel for default(shared)
+  for (size_t i = 0; i < n; i++)
+    if (gsl_finite(x[i])) {
+      union {
+	double d;
+	unsigned long long u;
+      } c = {
+      x[i]};
+      c.u = (c.u + half) & mask;
+      x[i] = c.d;
+    }
+}
+
+/*****************************************************************************/
+
 double scan_ctl(
   const char *filename,
   int argc,
@@ -3448,6 +6329,123 @@ void spline(
 
 /*****************************************************************************/
 
+/*! Get median of data by selection on copies in a work array. */
+static double stats_median(
+  const double *data,
+  int n,
+  double *work) {
+
+  double a, b;
+
+  int lhs = (n - 1) / 2;
+
+  /* Select lower middle element (on a copy of the data)... */
+  memcpy(work, data, (size_t) n * sizeof(double));
+  a = gsl_stats_select(work, 1, (size_t) n, (size_t) lhs);
+  if (n % 2)
+    return a;
+
+  /* Select upper middle element (on a fresh copy, the order left
+     behind by the first selection is not used)... */
+  memcpy(work, data, (size_t) n * sizeof(double));
+  b = gsl_stats_select(work, 1, (size_t) n, (size_t) lhs + 1);
+
+  return 0.5 * (a + b);
+}
+
+/*****************************************************************************/
+
+double stats(
+  const char *param,
+  double *data,
+  int n,
+  double *work) {
+
+  double a = 0, b = 0, mean = 0, sd;
+
+  int i, nnan = 0;
+
+  /* Check number of data points... */
+  if (n <= 0)
+    return GSL_NAN;
+
+  /* Minimum and maximum... */
+  if (strcasecmp(param, "min") == 0 || strcasecmp(param, "max") == 0) {
+    a = b = data[0];
+#pragma omp parallel for default(shared) reduction(min:a) reduction(max:b) reduction(+:nnan)
+    for (i = 0; i < n; i++) {
+      a = GSL_MIN(a, data[i]);
+      b = GSL_MAX(b, data[i]);
+      nnan += gsl_isnan(data[i]);
+    }
+    if (nnan > 0)
+      return GSL_NAN;
+    return (strcasecmp(param, "min") == 0 ? a : b);
+  }
+
+  /* Median and median absolute deviation... */
+  if (strcasecmp(param, "median") == 0 || strcasecmp(param, "mad") == 0) {
+    double *dev, median = stats_median(data, n, work);
+    if (strcasecmp(param, "median") == 0)
+      return median;
+    ALLOC(dev, double,
+	  n);
+#pragma omp parallel for default(shared)
+    for (i = 0; i < n; i++)
+      dev[i] = fabs(data[i] - median);
+    a = stats_median(dev, n, work);
+    free(dev);
+    return a;
+  }
+
+  /* Mean (with correction pass to keep constant data exact)... */
+#pragma omp parallel for default(shared) reduction(+:mean)
+  for (i = 0; i < n; i++)
+    mean += data[i];
+  mean /= n;
+#pragma omp parallel for default(shared) reduction(+:a)
+  for (i = 0; i < n; i++)
+    a += data[i] - mean;
+  mean += a / n;
+  a = 0;
+  if (strcasecmp(param, "mean") == 0)
+    return mean;
+
+  /* Absolute deviation... */
+  if (strcasecmp(param, "absdev") == 0) {
+#pragma omp parallel for default(shared) reduction(+:a)
+    for (i = 0; i < n; i++)
+      a += fabs(data[i] - mean);
+    return a / n;
+  }
+
+  /* Standard deviation... */
+#pragma omp parallel for default(shared) reduction(+:a)
+  for (i = 0; i < n; i++)
+    a += SQR(data[i] - mean);
+  sd = sqrt(a / (n - 1));
+  if (strcasecmp(param, "stddev") == 0)
+    return sd;
+
+  /* Skewness and kurtosis... */
+  if (strcasecmp(param, "skew") == 0 || strcasecmp(param, "kurt") == 0) {
+    a = b = 0;
+#pragma omp parallel for default(shared) reduction(+:a,b)
+    for (i = 0; i < n; i++) {
+      double x = (data[i] - mean) / sd;
+      a += x * x * x;
+      b += x * x * x * x;
+    }
+    return (strcasecmp(param, "skew") == 0 ? a / n : b / n - 3.0);
+  }
+
+  /* Unknown parameter... */
+  ERRMSG("Unknown parameter!");
+  return GSL_NAN;
+}
+
+/*****************************************************************************/
+
 double stddev(
   double *data,
   int n) {
@@ -3488,50 +6486,349 @@ void time2jsec(
   t0.tm_min = 0;
   t0.tm_sec = 0;
 
-  t1.tm_year = year - 1900;
-  t1.tm_mon = mon - 1;
-  t1.tm_mday = day;
-  t1.tm_hour = hour;
-  t1.tm_min = min;
-  t1.tm_sec = sec;
+  t1.tm_year = year - 1900;
+  t1.tm_mon = mon - 1;
+  t1.tm_mday = day;
+  t1.tm_hour = hour;
+  t1.tm_min = min;
+  t1.tm_sec = sec;
+
+  *jsec = (double) timegm(&t1) - (double) timegm(&t0) + remain;
+}
+
+/*****************************************************************************/
+
+double timer(
+  const char *name,
+  int id,
+  int mode) {
+
+  static double starttime[NTIMER], runtime[NTIMER];
+
+#ifdef NVTX
+  static nvtxRangeId_t range[NTIMER];
+#endif
+
+  /* Check id... */
+  if (id < 0 || id >= NTIMER)
+    ERRMSG("Too many timers!");
+
+  /* Start timer... */
+  if (mode == 1) {
+    if (starttime[id] <= 0) {
+      starttime[id] = omp_get_wtime();
+#ifdef NVTX
+      range[id] = nvtxRangeStartA(name);
+#endif
+    } else
+      ERRMSG("Timer already started!");
+  }
+
+  /* Stop timer... */
+  else if (mode == 2) {
+    if (starttime[id] > 0) {
+      runtime[id] = runtime[id] + omp_get_wtime() - starttime[id];
+      starttime[id] = -1;
+#ifdef NVTX
+      nvtxRangeEnd(range[id]);
+#endif
+    }
+  }
+
+  /* Print timer... */
+  else if (mode == 3) {
+    printf("%s = %.3f s\n", name, runtime[id]);
+    runtime[id] = 0;
+  }
+
+  return runtime[id];
+}
+
+/*****************************************************************************/
+
+/*! Job of the asynchronous output writer. */
+typedef struct {
+  ctl_t *ctl;
+  char filename[LEN];
+  double t;
+  atm_t *atm;
+  size_t nc;
+  unsigned long *cidx;
+  int *cnp;
+  double *cmass, *ccd, *cvmr;
+  cache_t *cache;
+  chk_wr_t wr;
+} out_job_t;
+
+/*! State of the asynchronous output writer. */
+static struct {
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  out_job_t *job;
+  int active, stop, head, count, n;
+} out_async = {
+  .mutex = PTHREAD_MUTEX_INITIALIZER,
+  .cond = PTHREAD_COND_INITIALIZER
+};
+
+static void write_async_chk(
+  out_job_t * job) {
+
+  FILE *out;
+
+  atm_t *atm = job->atm;
+
+  cache_t *cache = job->cache;
+
+  char tmp[2 * LEN];
+
+  int head[3] = { CHK_VERSION, atm->np, job->ctl->nq };
+
+  size_t np = (size_t) atm->np;
+
+  /* Write info... */
+  printf("Write checkpoint: %s\n", job->filename);
+
+  /* Create temporary file... */
+  sprintf(tmp, "%s.tmp", job->filename);
+  if (!(out = fopen(tmp, "w")))
+    ERRMSG("Cannot create file!");
+
+  /* Write header... */
+  FWRITE("MPTRACCK", char, 8, out);
+  FWRITE(head, int, 3, out);
+  FWRITE(&job->t, double, 1, out);
+
+  /* Write air parcel data... */
+  FWRITE(atm->time, double, np, out);
+  FWRITE(atm->p, double, np, out);
+  FWRITE(atm->lon, double, np, out);
+  FWRITE(atm->lat, double, np, out);
+  for (int iq = 0; iq < job->ctl->nq; iq++)
+    FWRITE(atm->q[iq], double, np, out);
+
+  /* Write cache data... */
+  FWRITE(cache->id, int, np, out);
+  FWRITE(cache->up, float, np, out);
+  FWRITE(cache->vp, float, np, out);
+  FWRITE(cache->wp, float, np, out);
+  FWRITE(cache->iso_var, double, np, out);
+  FWRITE(&cache->iso_n, int, 1, out);
+  FWRITE(cache->iso_ps, double, (size_t) cache->iso_n, out);
+  FWRITE(cache->iso_ts, double, (size_t) cache->iso_n, out);
+
+  /* Write state of output writers... */
+  FWRITE(&job->wr, chk_wr_t, 1, out);
+
+  /* Replace old checkpoint only when complete... */
+  if (fclose(out) != 0)
+    ERRMSG("Error while writing!");
+  if (rename(tmp, job->filename) != 0)
+    ERRMSG("Cannot rename checkpoint file!");
+}
+
+static void write_async_job(
+  out_job_t * job) {
+
+  ctl_t *ctl = job->ctl;
+
+  /* Write checkpoint... */
+  if (job->cache) {
+    write_async_chk(job);
+    free_atm(job->atm);
+    free(job->atm);
+    free_cache(job->cache);
+    free(job->cache);
+  }
+
+  /* Write atmospheric data... */
+  else if (job->atm) {
+    write_atm(job->filename, ctl, job->atm, job->t);
+    free_atm(job->atm);
+    free(job->atm);
+  }
+
+  /* Write gridded data... */
+  else {
+    if (ctl->grid_type == 0)
+      write_grid_asc(job->filename, ctl, job->t, job->nc, job->cidx,
+		     job->cnp, job->cmass, job->ccd, job->cvmr);
+    else if (ctl->grid_type == 1)
+      write_grid_nc(job->filename, ctl, job->t, job->nc, job->cidx,
+		    job->cnp, job->ccd, job->cvmr);
+    else
+      ERRMSG("Grid data format GRID_TYPE unknown!");
+    free(job->cidx);
+    free(job->cnp);
+    free(job->cmass);
+    free(job->ccd);
+    free(job->cvmr);
+  }
+}
+
+static void *write_async_run(
+  void *arg) {
+
+  out_job_t job;
+
+  for (;;) {
+
+    /* Wait for next job... */
+    pthread_mutex_lock(&out_async.mutex);
+    while (out_async.count == 0 && !out_async.stop)
+      pthread_cond_wait(&out_async.cond, &out_async.mutex);
+    if (out_async.count == 0) {
+      pthread_mutex_unlock(&out_async.mutex);
+      break;
+    }
+
+    /* Take job from queue... */
+    job = out_async.job[out_async.head];
+    out_async.head = (out_async.head + 1) % out_async.n;
+    out_async.count--;
+    pthread_cond_broadcast(&out_async.cond);
+    pthread_mutex_unlock(&out_async.mutex);
+
+    /* Write data... */
+    write_async_job(&job);
+  }
+
+  return arg;
+}
+
+static void write_async_push(
+  ctl_t * ctl,
+  out_job_t * job) {
+
+  /* Write data synchronously... */
+  job->ctl = ctl;
+  if (ctl->out_async <= 0) {
+    write_async_job(job);
+    return;
+  }
+
+  /* Start writer thread... */
+  if (!out_async.active) {
+    if (out_async.n != ctl->out_async) {
+      free(out_async.job);
+      out_async.n = ctl->out_async;
+      ALLOC(out_async.job, out_job_t, out_async.n);
+    }
+    out_async.head = out_async.count = out_async.stop = 0;
+    out_async.active = 1;
+    if (pthread_create(&out_async.thread, NULL, write_async_run, NULL) != 0)
+      ERRMSG("Cannot create output thread!");
+  }
+
+  /* Add job to queue (wait while the queue is full)... */
+  pthread_mutex_lock(&out_async.mutex);
+  while (out_async.count >= out_async.n)
+    pthread_cond_wait(&out_async.cond, &out_async.mutex);
+  out_async.job[(out_async.head + out_async.count) % out_async.n] = *job;
+  out_async.count++;
+  pthread_cond_broadcast(&out_async.cond);
+  pthread_mutex_unlock(&out_async.mutex);
+}
+
+/*****************************************************************************/
+
+static atm_t *write_async_copy(
+  ctl_t * ctl,
+  atm_t * atm) {
+
+  atm_t *copy;
+
+  /* Copy air parcel data to staging buffer... */
+  ALLOC(copy, atm_t, 1);
+  if (atm->np > 0) {
+    size_t n = (size_t) atm->np * sizeof(double);
+    alloc_atm(ctl, copy, atm->np);
+    memcpy(copy->time, atm->time, n);
+    memcpy(copy->p, atm->p, n);
+    memcpy(copy->lon, atm->lon, n);
+    memcpy(copy->lat, atm->lat, n);
+    for (int iq = 0; iq < ctl->nq; iq++)
+      memcpy(copy->q[iq], atm->q[iq], n);
+  }
+  copy->np = atm->np;
+
+  return copy;
+}
+
+/*****************************************************************************/
+
+void write_async_atm(
+  const char *filename,
+  ctl_t * ctl,
+  atm_t * atm,
+  double t) {
+
+  out_job_t job;
+
+  /* Write data synchronously... */
+  if (ctl->out_async <= 0) {
+    write_atm(filename, ctl, atm, t);
+    return;
+  }
+
+  /* Copy air parcel data to staging buffer... */
+  memset(&job, 0, sizeof(out_job_t));
+  strcpy(job.filename, filename);
+  job.t = t;
+  job.atm = write_async_copy(ctl, atm);
 
-  *jsec = (double) timegm(&t1) - (double) timegm(&t0) + remain;
+  /* Hand over to writer thread... */
+  write_async_push(ctl, &job);
 }
 
 /*****************************************************************************/
 
-void timer(
-  const char *name,
-  int id,
-  int mode) {
-
-  static double starttime[NTIMER], runtime[NTIMER];
+void write_async_grid(
+  const char *filename,
+  ctl_t * ctl,
+  double t,
+  size_t nc,
+  unsigned long *cidx,
+  int *cnp,
+  double *cmass,
+  double *ccd,
+  double *cvmr) {
+
+  out_job_t job;
+
+  /* Set up job... */
+  memset(&job, 0, sizeof(out_job_t));
+  strcpy(job.filename, filename);
+  job.t = t;
+  job.nc = nc;
+  job.cidx = cidx;
+  job.cnp = cnp;
+  job.cmass = cmass;
+  job.ccd = ccd;
+  job.cvmr = cvmr;
+
+  /* Hand over to writer thread... */
+  write_async_push(ctl, &job);
+}
 
-  /* Check id... */
-  if (id < 0 || id >= NTIMER)
-    ERRMSG("Too many timers!");
+/*****************************************************************************/
 
-  /* Start timer... */
-  if (mode == 1) {
-    if (starttime[id] <= 0)
-      starttime[id] = omp_get_wtime();
-    else
-      ERRMSG("Timer already started!");
-  }
+void write_async_wait(
+  void) {
 
-  /* Stop timer... */
-  else if (mode == 2) {
-    if (starttime[id] > 0) {
-      runtime[id] = runtime[id] + omp_get_wtime() - starttime[id];
-      starttime[id] = -1;
-    }
-  }
+  /* Check for active writer thread... */
+  if (!out_async.active)
+    return;
 
-  /* Print timer... */
-  else if (mode == 3) {
-    printf("%s = %.3f s\n", name, runtime[id]);
-    runtime[id] = 0;
-  }
+  /* Stop writer thread after the remaining jobs... */
+  pthread_mutex_lock(&out_async.mutex);
+  out_async.stop = 1;
+  pthread_cond_broadcast(&out_async.cond);
+  pthread_mutex_unlock(&out_async.mutex);
+  if (pthread_join(out_async.thread, NULL) != 0)
+    ERRMSG("Cannot join output thread!");
+  out_async.active = 0;
 }
 
 /*****************************************************************************/
@@ -3628,10 +6925,22 @@ void write_atm(
     if (!(out = fopen(filename, "w")))
       ERRMSG("Cannot create file!");
 
-    /* Write data... */
-    FWRITE(&atm->np, int,
-	   1,
+    /* Write header and quantity names... */
+    int hdr[4] = { ATM_BIN_MAGIC, ATM_BIN_VERSION, atm->np, ctl->nq };
+    FWRITE(hdr, int,
+	   4,
 	   out);
+    for (iq = 0; iq < ctl->nq; iq++) {
+      char name[ATM_BIN_NAME] = { 0 };
+      if (strlen(ctl->qnt_name[iq]) >= ATM_BIN_NAME)
+	ERRMSG("Quantity name too long for binary output!");
+      strcpy(name, ctl->qnt_name[iq]);
+      FWRITE(name, char,
+	     ATM_BIN_NAME,
+	     out);
+    }
+
+    /* Write data... */
     FWRITE(atm->time, double,
 	     (size_t) atm->np,
 	   out);
@@ -3653,6 +6962,64 @@ void write_atm(
     fclose(out);
   }
 
+  /* Write netCDF data... */
+  else if (ctl->atm_type == 3) {
+
+    double *help;
+
+    int dimid, ncid, varid[NQ + 4];
+
+    size_t chunk[1] = { (size_t) GSL_MIN(ctl->nc_chunk, atm->np) };
+
+    /* Create file... */
+    pthread_mutex_lock(&nc_mutex);
+    NC(nc_create(filename, NC_CLOBBER | (ctl->nc_level > 0 ? NC_NETCDF4
+					 : NC_64BIT_OFFSET), &ncid));
+
+    /* Define dimensions and variables... */
+    NC(nc_def_dim(ncid, "NP", (size_t) atm->np, &dimid));
+    NC_DEF_VAR(ncid, "time", NC_DOUBLE, 1, &dimid, varid[0], "time",
+	       "seconds since 2000-01-01 00:00:00 UTC");
+    NC_DEF_VAR(ncid, "press", NC_DOUBLE, 1, &dimid, varid[1], "pressure",
+	       "hPa");
+    NC_DEF_VAR(ncid, "lon", NC_DOUBLE, 1, &dimid, varid[2], "longitude",
+	       "degrees_east");
+    NC_DEF_VAR(ncid, "lat", NC_DOUBLE, 1, &dimid, varid[3], "latitude",
+	       "degrees_north");
+    for (iq = 0; iq < ctl->nq; iq++)
+      NC_DEF_VAR(ncid, ctl->qnt_name[iq], NC_DOUBLE, 1, &dimid,
+		 varid[iq + 4], ctl->qnt_name[iq], ctl->qnt_unit[iq]);
+
+    /* Set chunking and compression... */
+    if (atm->np > 0)
+      for (iq = 0; iq < ctl->nq + 4; iq++)
+	NC_DEFLATE(ncid, varid[iq], chunk[0] > 0 ? chunk : NULL,
+		   ctl->nc_level);
+
+    /* End definitions... */
+    NC(nc_enddef(ncid));
+
+    /* Write data... */
+    if (atm->np > 0) {
+      NC(nc_put_var_double(ncid, varid[0], atm->time));
+      NC(nc_put_var_double(ncid, varid[1], atm->p));
+      NC(nc_put_var_double(ncid, varid[2], atm->lon));
+      NC(nc_put_var_double(ncid, varid[3], atm->lat));
+      ALLOC(help, double,
+	    atm->np);
+      for (iq = 0; iq < ctl->nq; iq++) {
+	memcpy(help, atm->q[iq], (size_t) atm->np * sizeof(double));
+	round_bits(help, (size_t) atm->np, ctl->nc_quant);
+	NC(nc_put_var_double(ncid, varid[iq + 4], help));
+      }
+      free(help);
+    }
+
+    /* Close file... */
+    NC(nc_close(ncid));
+    pthread_mutex_unlock(&nc_mutex);
+  }
+
   /* Error... */
   else
     ERRMSG("Atmospheric data type not supported!");
@@ -3660,6 +7027,95 @@ void write_atm(
 
 /*****************************************************************************/
 
+void write_chk(
+  const char *filename,
+  ctl_t * ctl,
+  atm_t * atm,
+  cache_t * cache,
+  double t) {
+
+  out_job_t job;
+
+  /* Get positions of open files of output writers... */
+  memset(&job, 0, sizeof(out_job_t));
+  job.wr = chk_wr.state;
+  for (int iw = 0; iw < NCHKW; iw++) {
+    job.wr.outpos[iw] = -1;
+    if (chk_wr.out[iw] && *chk_wr.out[iw]) {
+      fflush(*chk_wr.out[iw]);
+      job.wr.outpos[iw] = ftell(*chk_wr.out[iw]);
+    }
+    if (chk_wr.in[iw] && *chk_wr.in[iw])
+      job.wr.inpos[iw] = ftell(*chk_wr.in[iw]);
+  }
+
+  /* Copy air parcel data to staging buffer... */
+  strcpy(job.filename, filename);
+  job.t = t;
+  job.atm = write_async_copy(ctl, atm);
+
+  /* Copy cache data to staging buffer... */
+  size_t np = (size_t) GSL_MAX(atm->np, 1);
+  ALLOC(job.cache, cache_t, 1);
+  ALLOC(job.cache->id, int, np);
+  ALLOC(job.cache->up, float, np);
+  ALLOC(job.cache->vp, float, np);
+  ALLOC(job.cache->wp, float, np);
+  ALLOC(job.cache->iso_var, double, np);
+  np = (size_t) atm->np;
+  memcpy(job.cache->id, cache->id, np * sizeof(int));
+  memcpy(job.cache->up, cache->up, np * sizeof(float));
+  memcpy(job.cache->vp, cache->vp, np * sizeof(float));
+  memcpy(job.cache->wp, cache->wp, np * sizeof(float));
+  memcpy(job.cache->iso_var, cache->iso_var, np * sizeof(double));
+  job.cache->iso_n = cache->iso_n;
+  if (cache->iso_n > 0) {
+    size_t n = (size_t) cache->iso_n * sizeof(double);
+    ALLOC(job.cache->iso_ps, double, cache->iso_n);
+    ALLOC(job.cache->iso_ts, double, cache->iso_n);
+    memcpy(job.cache->iso_ps, cache->iso_ps, n);
+    memcpy(job.cache->iso_ts, cache->iso_ts, n);
+  }
+
+  /* Hand over to writer thread... */
+  write_async_push(ctl, &job);
+}
+
+/*****************************************************************************/
+
+static void write_chk_open(
+  const char *filename,
+  int iw,
+  int resume,
+  FILE ** out) {
+
+  /* Create new file... */
+  if (!resume) {
+    if (!(*out = fopen(filename, "w")))
+      ERRMSG("Cannot create file!");
+  }
+
+  /* Append to file that was closed at the checkpoint... */
+  else if (chk_wr.state.outpos[iw] < 0) {
+    if (!(*out = fopen(filename, "a")))
+      ERRMSG("Cannot open file!");
+  }
+
+  /* Discard data written after the checkpoint and append... */
+  else {
+    if (!(*out = fopen(filename, "r+")))
+      ERRMSG("Cannot open file!");
+    if (ftruncate(fileno(*out), (off_t) chk_wr.state.outpos[iw]) != 0)
+      ERRMSG("Cannot truncate file!");
+    fseek(*out, 0, SEEK_END);
+  }
+
+  /* Register file for checkpoints... */
+  chk_wr.out[iw] = out;
+}
+
+/*****************************************************************************/
+
 void write_csi(
   const char *filename,
   ctl_t * ctl,
@@ -3670,40 +7126,72 @@ void write_csi(
 
   static char line[LEN];
 
-  static double modmean[GX][GY][GZ], obsmean[GX][GY][GZ],
-    rt, rz, rlon, rlat, robs, t0, t1, area, dlon, dlat, lat;
+  static double *modmean, *obsmean, rt, rz, rlon, rlat, robs, t0, t1, area,
+    dlon, dlat, lat;
 
-  static int obscount[GX][GY][GZ], cx, cy, cz, ip, ix, iy, iz;
+  static int *obscount, cx, cy, cz, ncell;
 
-  /* Init... */
-  if (t == ctl->t_start) {
+  int rank = 0;
+
+  /* Get MPI rank (only the master writes output)... */
+#ifdef MPI
+  if (ctl->mpi_decomp)
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
+
+  /* Init (or resume from checkpoint)... */
+  if (t == ctl->t_start || !modmean) {
 
     /* Check quantity index for mass... */
     if (ctl->qnt_m < 0)
       ERRMSG("Need quantity mass!");
 
+    /* Allocate... */
+    ncell = ctl->csi_nx * ctl->csi_ny * ctl->csi_nz;
+    ALLOC(modmean, double,
+	  ncell);
+    ALLOC(obsmean, double,
+	  ncell);
+    ALLOC(obscount, int,
+	  ncell);
+  }
+
+  /* Open files on master... */
+  if (rank == 0 && (t == ctl->t_start || !out)) {
+    int resume = (t != ctl->t_start);
+
     /* Open observation data file... */
     printf("Read CSI observation data: %s\n", ctl->csi_obsfile);
     if (!(in = fopen(ctl->csi_obsfile, "r")))
       ERRMSG("Cannot open file!");
+    if (resume)
+      fseek(in, chk_wr.state.inpos[CHKW_CSI], SEEK_SET);
+    chk_wr.in[CHKW_CSI] = &in;
 
     /* Create new file... */
     printf("Write CSI data: %s\n", filename);
-    if (!(out = fopen(filename, "w")))
-      ERRMSG("Cannot create file!");
+    write_chk_open(filename, CHKW_CSI, resume, &out);
+
+    /* Restore counters... */
+    if (resume) {
+      cx = (int) chk_wr.state.acc[CHKW_CSI][0];
+      cy = (int) chk_wr.state.acc[CHKW_CSI][1];
+      cz = (int) chk_wr.state.acc[CHKW_CSI][2];
+    }
 
     /* Write header... */
-    fprintf(out,
-	    "# $1 = time [s]\n"
-	    "# $2 = number of hits (cx)\n"
-	    "# $3 = number of misses (cy)\n"
-	    "# $4 = number of false alarms (cz)\n"
-	    "# $5 = number of observations (cx + cy)\n"
-	    "# $6 = number of forecasts (cx + cz)\n"
-	    "# $7 = bias (forecasts/observations) [%%]\n"
-	    "# $8 = probability of detection (POD) [%%]\n"
-	    "# $9 = false alarm rate (FAR) [%%]\n"
-	    "# $10 = critical success index (CSI) [%%]\n\n");
+    else
+      fprintf(out,
+	      "# $1 = time [s]\n"
+	      "# $2 = number of hits (cx)\n"
+	      "# $3 = number of misses (cy)\n"
+	      "# $4 = number of false alarms (cz)\n"
+	      "# $5 = number of observations (cx + cy)\n"
+	      "# $6 = number of forecasts (cx + cz)\n"
+	      "# $7 = bias (forecasts/observations) [%%]\n"
+	      "# $8 = probability of detection (POD) [%%]\n"
+	      "# $9 = false alarm rate (FAR) [%%]\n"
+	      "# $10 = critical success index (CSI) [%%]\n\n");
   }
 
   /* Set time interval... */
@@ -3711,14 +7199,14 @@ void write_csi(
   t1 = t + 0.5 * ctl->dt_mod;
 
   /* Initialize grid cells... */
-#pragma omp parallel for default(shared) private(ix,iy,iz)
-  for (ix = 0; ix < ctl->csi_nx; ix++)
-    for (iy = 0; iy < ctl->csi_ny; iy++)
-      for (iz = 0; iz < ctl->csi_nz; iz++)
-	modmean[ix][iy][iz] = obsmean[ix][iy][iz] = obscount[ix][iy][iz] = 0;
+#pragma omp parallel for default(shared)
+  for (int icell = 0; icell < ncell; icell++) {
+    modmean[icell] = obsmean[icell] = 0;
+    obscount[icell] = 0;
+  }
 
   /* Read observation data... */
-  while (fgets(line, LEN, in)) {
+  while (rank == 0 && fgets(line, LEN, in)) {
 
     /* Read data... */
     if (sscanf(line, "%lg %lg %lg %lg %lg", &rt, &rz, &rlon, &rlat, &robs) !=
@@ -3732,12 +7220,12 @@ void write_csi(
       break;
 
     /* Calculate indices... */
-    ix = (int) ((rlon - ctl->csi_lon0)
-		/ (ctl->csi_lon1 - ctl->csi_lon0) * ctl->csi_nx);
-    iy = (int) ((rlat - ctl->csi_lat0)
-		/ (ctl->csi_lat1 - ctl->csi_lat0) * ctl->csi_ny);
-    iz = (int) ((rz - ctl->csi_z0)
-		/ (ctl->csi_z1 - ctl->csi_z0) * ctl->csi_nz);
+    int ix = (int) ((rlon - ctl->csi_lon0)
+		    / (ctl->csi_lon1 - ctl->csi_lon0) * ctl->csi_nx);
+    int iy = (int) ((rlat - ctl->csi_lat0)
+		    / (ctl->csi_lat1 - ctl->csi_lat0) * ctl->csi_ny);
+    int iz = (int) ((rz - ctl->csi_z0)
+		    / (ctl->csi_z1 - ctl->csi_z0) * ctl->csi_nz);
 
     /* Check indices... */
     if (ix < 0 || ix >= ctl->csi_nx ||
@@ -3745,25 +7233,29 @@ void write_csi(
       continue;
 
     /* Get mean observation index... */
-    obsmean[ix][iy][iz] += robs;
-    obscount[ix][iy][iz]++;
+    int icell = ARRAY_3D(ix, iy, ctl->csi_ny, iz, ctl->csi_nz);
+    obsmean[icell] += robs;
+    obscount[icell]++;
   }
 
-  /* Analyze model data... */
-#pragma omp parallel for default(shared) private(ip,ix,iy,iz)
-  for (ip = 0; ip < atm->np; ip++) {
+  /* Analyze model data (on the device if air parcels are present)... */
+#ifdef _OPENACC
+  int dev = acc_is_present(atm, sizeof(atm_t));
+#pragma acc parallel loop independent gang vector present(ctl,atm) copy(modmean[0:ncell]) if(dev)
+#endif
+  for (int ip = 0; ip < atm->np; ip++) {
 
     /* Check time... */
     if (atm->time[ip] < t0 || atm->time[ip] > t1)
       continue;
 
     /* Get indices... */
-    ix = (int) ((atm->lon[ip] - ctl->csi_lon0)
-		/ (ctl->csi_lon1 - ctl->csi_lon0) * ctl->csi_nx);
-    iy = (int) ((atm->lat[ip] - ctl->csi_lat0)
-		/ (ctl->csi_lat1 - ctl->csi_lat0) * ctl->csi_ny);
-    iz = (int) ((Z(atm->p[ip]) - ctl->csi_z0)
-		/ (ctl->csi_z1 - ctl->csi_z0) * ctl->csi_nz);
+    int ix = (int) ((atm->lon[ip] - ctl->csi_lon0)
+		    / (ctl->csi_lon1 - ctl->csi_lon0) * ctl->csi_nx);
+    int iy = (int) ((atm->lat[ip] - ctl->csi_lat0)
+		    / (ctl->csi_lat1 - ctl->csi_lat0) * ctl->csi_ny);
+    int iz = (int) ((Z(atm->p[ip]) - ctl->csi_z0)
+		    / (ctl->csi_z1 - ctl->csi_z0) * ctl->csi_nz);
 
     /* Check indices... */
     if (ix < 0 || ix >= ctl->csi_nx ||
@@ -3771,39 +7263,62 @@ void write_csi(
       continue;
 
     /* Get total mass in grid cell... */
-    modmean[ix][iy][iz] += atm->q[ctl->qnt_m][ip];
+#ifdef _OPENACC
+#pragma acc atomic update
+#endif
+    modmean[ARRAY_3D(ix, iy, ctl->csi_ny, iz, ctl->csi_nz)]
+      += atm->q[ctl->qnt_m][ip];
+  }
+
+#ifdef MPI
+  /* Sum up model data of all MPI tasks on master... */
+  if (ctl->mpi_decomp) {
+    MPI_Reduce(rank == 0 ? MPI_IN_PLACE : modmean, modmean, ncell,
+	       MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    if (rank != 0) {
+      if (t == ctl->t_stop) {
+	free(modmean);
+	free(obsmean);
+	free(obscount);
+	modmean = NULL;
+      }
+      return;
+    }
   }
+#endif
 
   /* Analyze all grid cells... */
-#pragma omp parallel for default(shared) private(ix,iy,iz,dlon,dlat,lat,area)
-  for (ix = 0; ix < ctl->csi_nx; ix++)
-    for (iy = 0; iy < ctl->csi_ny; iy++)
-      for (iz = 0; iz < ctl->csi_nz; iz++) {
+  for (int ix = 0; ix < ctl->csi_nx; ix++)
+    for (int iy = 0; iy < ctl->csi_ny; iy++)
+      for (int iz = 0; iz < ctl->csi_nz; iz++) {
+
+	/* Get index... */
+	int icell = ARRAY_3D(ix, iy, ctl->csi_ny, iz, ctl->csi_nz);
 
 	/* Calculate mean observation index... */
-	if (obscount[ix][iy][iz] > 0)
-	  obsmean[ix][iy][iz] /= obscount[ix][iy][iz];
+	if (obscount[icell] > 0)
+	  obsmean[icell] /= obscount[icell];
 
 	/* Calculate column density... */
-	if (modmean[ix][iy][iz] > 0) {
+	if (modmean[icell] > 0) {
 	  dlon = (ctl->csi_lon1 - ctl->csi_lon0) / ctl->csi_nx;
 	  dlat = (ctl->csi_lat1 - ctl->csi_lat0) / ctl->csi_ny;
 	  lat = ctl->csi_lat0 + dlat * (iy + 0.5);
 	  area = dlat * M_PI * RE / 180. * dlon * M_PI * RE / 180.
 	    * cos(lat * M_PI / 180.);
-	  modmean[ix][iy][iz] /= (1e6 * area);
+	  modmean[icell] /= (1e6 * area);
 	}
 
 	/* Calculate CSI... */
-	if (obscount[ix][iy][iz] > 0) {
-	  if (obsmean[ix][iy][iz] >= ctl->csi_obsmin &&
-	      modmean[ix][iy][iz] >= ctl->csi_modmin)
+	if (obscount[icell] > 0) {
+	  if (obsmean[icell] >= ctl->csi_obsmin &&
+	      modmean[icell] >= ctl->csi_modmin)
 	    cx++;
-	  else if (obsmean[ix][iy][iz] >= ctl->csi_obsmin &&
-		   modmean[ix][iy][iz] < ctl->csi_modmin)
+	  else if (obsmean[icell] >= ctl->csi_obsmin &&
+		   modmean[icell] < ctl->csi_modmin)
 	    cy++;
-	  else if (obsmean[ix][iy][iz] < ctl->csi_obsmin &&
-		   modmean[ix][iy][iz] >= ctl->csi_modmin)
+	  else if (obsmean[icell] < ctl->csi_obsmin &&
+		   modmean[icell] >= ctl->csi_modmin)
 	    cz++;
 	}
       }
@@ -3823,9 +7338,21 @@ void write_csi(
     cx = cy = cz = 0;
   }
 
+  /* Keep counters for checkpoints... */
+  chk_wr.state.acc[CHKW_CSI][0] = cx;
+  chk_wr.state.acc[CHKW_CSI][1] = cy;
+  chk_wr.state.acc[CHKW_CSI][2] = cz;
+
   /* Close file... */
-  if (t == ctl->t_stop)
+  if (t == ctl->t_stop) {
     fclose(out);
+    fclose(in);
+    out = in = NULL;
+    free(modmean);
+    free(obsmean);
+    free(obscount);
+    modmean = NULL;
+  }
 }
 
 /*****************************************************************************/
@@ -3838,190 +7365,632 @@ void write_ens(
 
   static FILE *out;
 
-  static double dummy, ens, lat, lon, p[NENS], q[NQ][NENS],
-    t0, t1, x[NENS][3], xm[3];
+  double dummy, lat, lon, *stat, t0, t1, xm[3];
 
-  static int ip, iq;
+  int iq, nens, nv, rank = 0;
 
-  static size_t i, n;
+  /* Get MPI rank (only the master writes output)... */
+#ifdef MPI
+  if (ctl->mpi_decomp)
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
 
-  /* Init... */
-  if (t == ctl->t_start) {
+  /* Check quantities... */
+  if (ctl->qnt_ens < 0)
+    ERRMSG("Missing ensemble IDs!");
 
-    /* Check quantities... */
-    if (ctl->qnt_ens < 0)
-      ERRMSG("Missing ensemble IDs!");
+  /* Init (or resume from checkpoint)... */
+  if (rank == 0 && (t == ctl->t_start || !out)) {
+    int resume = (t != ctl->t_start);
 
     /* Create new file... */
     printf("Write ensemble data: %s\n", filename);
-    if (!(out = fopen(filename, "w")))
-      ERRMSG("Cannot create file!");
+    write_chk_open(filename, CHKW_ENS, resume, &out);
 
     /* Write header... */
-    fprintf(out,
-	    "# $1 = time [s]\n"
-	    "# $2 = altitude [km]\n"
-	    "# $3 = longitude [deg]\n" "# $4 = latitude [deg]\n");
-    for (iq = 0; iq < ctl->nq; iq++)
-      fprintf(out, "# $%d = %s (mean) [%s]\n", 5 + iq,
-	      ctl->qnt_name[iq], ctl->qnt_unit[iq]);
-    for (iq = 0; iq < ctl->nq; iq++)
-      fprintf(out, "# $%d = %s (sigma) [%s]\n", 5 + ctl->nq + iq,
-	      ctl->qnt_name[iq], ctl->qnt_unit[iq]);
-    fprintf(out, "# $%d = number of members\n\n", 5 + 2 * ctl->nq);
+    if (!resume) {
+      fprintf(out,
+	      "# $1 = time [s]\n"
+	      "# $2 = altitude [km]\n"
+	      "# $3 = longitude [deg]\n" "# $4 = latitude [deg]\n");
+      for (iq = 0; iq < ctl->nq; iq++)
+	fprintf(out, "# $%d = %s (mean) [%s]\n", 5 + iq,
+		ctl->qnt_name[iq], ctl->qnt_unit[iq]);
+      for (iq = 0; iq < ctl->nq; iq++)
+	fprintf(out, "# $%d = %s (sigma) [%s]\n", 5 + ctl->nq + iq,
+		ctl->qnt_name[iq], ctl->qnt_unit[iq]);
+      fprintf(out, "# $%d = number of members\n\n", 5 + 2 * ctl->nq);
+    }
   }
 
   /* Set time interval... */
   t0 = t - 0.5 * ctl->dt_mod;
   t1 = t + 0.5 * ctl->dt_mod;
 
-  /* Init... */
-  ens = GSL_NAN;
-  n = 0;
-
-  /* Loop over air parcels... */
-  for (ip = 0; ip < atm->np; ip++) {
+  /* Get sort keys from ensemble IDs and parcel indices (skip air
+     parcels with NaN or out-of-range IDs)... */
+  long *key;
+  ALLOC(key, long,
+	GSL_MAX(atm->np, 1));
+#ifdef _OPENACC
+  int dev = acc_is_present(atm, sizeof(atm_t));
+#pragma acc parallel loop independent gang vector present(ctl,atm) copyout(key[0:atm->np]) if(dev)
+#else
+#pragma omp parallel for default(shared)
+#endif
+  for (int ip = 0; ip < atm->np; ip++) {
+    double ens = atm->q[ctl->qnt_ens][ip];
+    if (atm->time[ip] < t0 || atm->time[ip] > t1
+	|| !(ens >= 0 && ens <= INT_MAX))
+      key[ip] = -1;
+    else
+      key[ip] = ((long) ens << 32) + ip;
+  }
 
-    /* Check time... */
-    if (atm->time[ip] < t0 || atm->time[ip] > t1)
-      continue;
+  /* Sort air parcels by ensemble ID... */
+  gsl_sort_long(key, 1, (size_t) atm->np);
+
+  /* Find first air parcel of each ensemble... */
+  int *seg;
+  ALLOC(seg, int,
+	atm->np + 1);
+  nens = 0;
+  for (int i = 0; i < atm->np; i++)
+    if (key[i] >= 0 && (nens == 0 || (key[i] >> 32) != (key[i - 1] >> 32)))
+      seg[nens++] = i;
+  seg[nens] = atm->np;
+
+  /* Split ensembles into pieces of at most ENS_PIECE members... */
+  int *fp, *pe, *pi0, *pi1, npc = 0, npcmax = nens + atm->np / ENS_PIECE + 1;
+  ALLOC(fp, int,
+	nens + 1);
+  ALLOC(pe, int,
+	npcmax);
+  ALLOC(pi0, int,
+	npcmax);
+  ALLOC(pi1, int,
+	npcmax);
+  for (int ens = 0; ens < nens; ens++) {
+    fp[ens] = npc;
+    for (int i = seg[ens]; i < seg[ens + 1]; i += ENS_PIECE) {
+      pe[npc] = ens;
+      pi0[npc] = i;
+      pi1[npc++] = GSL_MIN(i + ENS_PIECE, seg[ens + 1]);
+    }
+  }
+  fp[nens] = npc;
 
-    /* Check ensemble id... */
-    if (atm->q[ctl->qnt_ens][ip] != ens) {
+  /* Allocate... */
+  nv = 5 + 2 * ctl->nq;
+  double *ps;
+  ALLOC(ps, double,
+	GSL_MAX(npc * nv, 1));
+  ALLOC(stat, double,
+	GSL_MAX(nens * nv, 1));
+
+  /* Sum up number of members, positions, and quantities of each
+     piece... */
+#ifdef _OPENACC
+#pragma acc parallel loop independent gang vector present(ctl,atm) copyin(key[0:atm->np],pi0[0:npc],pi1[0:npc]) copyout(ps[0:npc*nv]) if(dev)
+#else
+#pragma omp parallel for default(shared)
+#endif
+  for (int k = 0; k < npc; k++) {
+    double *s = ps + k * nv;
+    for (int i = 0; i < nv; i++)
+      s[i] = 0;
+    for (int i = pi0[k]; i < pi1[k]; i++) {
+      int ip = (int) (key[i] & 0xffffffff);
+      double x[3];
+      geo2cart(0, atm->lon[ip], atm->lat[ip], x);
+      s[0] += 1;
+      s[1] += atm->p[ip];
+      for (int j = 0; j < 3; j++)
+	s[2 + j] += x[j];
+      for (int iq2 = 0; iq2 < ctl->nq; iq2++)
+	s[5 + iq2] += atm->q[iq2][ip];
+    }
+  }
 
-      /* Write results... */
-      if (n > 0) {
+  /* Sum up pieces of each ensemble... */
+#pragma omp parallel for default(shared)
+  for (int ens = 0; ens < nens; ens++)
+    for (int j = 0; j < nv; j++) {
+      stat[ens * nv + j] = 0;
+      for (int k = fp[ens]; k < fp[ens + 1]; k++)
+	stat[ens * nv + j] += ps[k * nv + j];
+    }
 
-	/* Get mean position... */
-	xm[0] = xm[1] = xm[2] = 0;
-	for (i = 0; i < n; i++) {
-	  xm[0] += x[i][0] / (double) n;
-	  xm[1] += x[i][1] / (double) n;
-	  xm[2] += x[i][2] / (double) n;
-	}
-	cart2geo(xm, &dummy, &lon, &lat);
-	fprintf(out, "%.2f %g %g %g", t, Z(gsl_stats_mean(p, 1, n)), lon,
-		lat);
-
-	/* Get quantity statistics... */
-	for (iq = 0; iq < ctl->nq; iq++) {
-	  fprintf(out, " ");
-	  fprintf(out, ctl->qnt_format[iq], gsl_stats_mean(q[iq], 1, n));
-	}
-	for (iq = 0; iq < ctl->nq; iq++) {
-	  fprintf(out, " ");
-	  fprintf(out, ctl->qnt_format[iq], gsl_stats_sd(q[iq], 1, n));
-	}
-	fprintf(out, " %lu\n", n);
+#ifdef MPI
+  /* Sum up ensembles of all MPI tasks... */
+  double *gstat = NULL;
+  int ng = 0, *lmap = NULL;
+  if (ctl->mpi_decomp) {
+
+    /* Collect ensemble IDs and sums of all tasks... */
+    int *counts, *displs, ntot = 0, size;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    ALLOC(counts, int,
+	  size);
+    ALLOC(displs, int,
+	  size);
+    MPI_Allgather(&nens, 1, MPI_INT, counts, 1, MPI_INT, MPI_COMM_WORLD);
+    for (int i = 0; i < size; i++) {
+      displs[i] = ntot;
+      ntot += counts[i];
+    }
+    long *lid, *aid;
+    double *astat;
+    ALLOC(lid, long,
+	  GSL_MAX(nens, 1));
+    ALLOC(aid, long,
+	  GSL_MAX(ntot, 1));
+    ALLOC(astat, double,
+	  GSL_MAX(ntot * nv, 1));
+    for (int ens = 0; ens < nens; ens++)
+      lid[ens] = key[seg[ens]] >> 32;
+    MPI_Allgatherv(lid, nens, MPI_LONG, aid, counts, displs, MPI_LONG,
+		   MPI_COMM_WORLD);
+    for (int i = 0; i < size; i++) {
+      counts[i] *= nv;
+      displs[i] *= nv;
+    }
+    MPI_Allgatherv(stat, nens * nv, MPI_DOUBLE, astat, counts, displs,
+		   MPI_DOUBLE, MPI_COMM_WORLD);
+
+    /* Merge ensembles of all tasks (sums in order of tasks)... */
+    for (int i = 0; i < ntot; i++)
+      aid[i] = (aid[i] << 32) + i;
+    gsl_sort_long(aid, 1, (size_t) ntot);
+    ALLOC(gstat, double,
+	  GSL_MAX(ntot * nv, 1));
+    for (int i = 0; i < ntot; i++) {
+      if (i > 0 && (aid[i] >> 32) != (aid[i - 1] >> 32))
+	ng++;
+      for (int j = 0; j < 5 + ctl->nq; j++)
+	gstat[ng * nv + j] += astat[(aid[i] & 0xffffffff) * nv + j];
+    }
+    ng = (ntot > 0 ? ng + 1 : 0);
+
+    /* Use global sums for local ensembles... */
+    ALLOC(lmap, int,
+	  GSL_MAX(nens, 1));
+    for (int ens = 0, g = 0, i = 0; ens < nens; ens++) {
+      while ((aid[i] >> 32) != lid[ens]) {
+	if (i + 1 < ntot && (aid[i + 1] >> 32) != (aid[i] >> 32))
+	  g++;
+	i++;
       }
+      lmap[ens] = g;
+      memcpy(stat + ens * nv, gstat + g * nv,
+	     (size_t) (5 + ctl->nq) * sizeof(double));
+    }
+
+    /* Free... */
+    free(counts);
+    free(displs);
+    free(lid);
+    free(aid);
+    free(astat);
+  }
+#endif
 
-      /* Init new ensemble... */
-      ens = atm->q[ctl->qnt_ens][ip];
-      n = 0;
+  /* Sum up squared deviations from the means of each piece... */
+#ifdef _OPENACC
+#pragma acc parallel loop independent gang vector present(ctl,atm) copyin(key[0:atm->np],pe[0:npc],pi0[0:npc],pi1[0:npc],stat[0:nens*nv]) copyout(ps[0:npc*nv]) if(dev)
+#else
+#pragma omp parallel for default(shared)
+#endif
+  for (int k = 0; k < npc; k++) {
+    double *s = stat + pe[k] * nv;
+    for (int iq2 = 0; iq2 < ctl->nq; iq2++)
+      ps[k * nv + 5 + ctl->nq + iq2] = 0;
+    for (int i = pi0[k]; i < pi1[k]; i++) {
+      int ip = (int) (key[i] & 0xffffffff);
+      for (int iq2 = 0; iq2 < ctl->nq; iq2++)
+	ps[k * nv + 5 + ctl->nq + iq2]
+	  += SQR(atm->q[iq2][ip] - s[5 + iq2] / s[0]);
     }
+  }
 
-    /* Save data... */
-    p[n] = atm->p[ip];
-    geo2cart(0, atm->lon[ip], atm->lat[ip], x[n]);
-    for (iq = 0; iq < ctl->nq; iq++)
-      q[iq][n] = atm->q[iq][ip];
-    if ((++n) >= NENS)
-      ERRMSG("Too many data points!");
+  /* Sum up pieces of each ensemble... */
+#pragma omp parallel for default(shared)
+  for (int ens = 0; ens < nens; ens++)
+    for (int j = 5 + ctl->nq; j < nv; j++)
+      for (int k = fp[ens]; k < fp[ens + 1]; k++)
+	stat[ens * nv + j] += ps[k * nv + j];
+
+#ifdef MPI
+  /* Sum up squared deviations of all MPI tasks on master... */
+  if (ctl->mpi_decomp) {
+    double *dev2;
+    ALLOC(dev2, double,
+	  GSL_MAX(ng * ctl->nq, 1));
+    for (int ens = 0; ens < nens; ens++)
+      for (int iq2 = 0; iq2 < ctl->nq; iq2++)
+	dev2[lmap[ens] * ctl->nq + iq2] = stat[ens * nv + 5 + ctl->nq + iq2];
+    MPI_Reduce(rank == 0 ? MPI_IN_PLACE : dev2, dev2, ng * ctl->nq,
+	       MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    for (int g = 0; g < ng; g++)
+      for (int iq2 = 0; iq2 < ctl->nq; iq2++)
+	gstat[g * nv + 5 + ctl->nq + iq2] = dev2[g * ctl->nq + iq2];
+    free(stat);
+    free(dev2);
+    free(lmap);
+    stat = gstat;
+    nens = (rank == 0 ? ng : 0);
   }
+#endif
 
   /* Write results... */
-  if (n > 0) {
+  for (int ens = 0; ens < nens; ens++) {
+
+    /* Check number of members... */
+    double *s = stat + ens * nv;
+    if (s[0] <= 0)
+      continue;
 
     /* Get mean position... */
-    xm[0] = xm[1] = xm[2] = 0;
-    for (i = 0; i < n; i++) {
-      xm[0] += x[i][0] / (double) n;
-      xm[1] += x[i][1] / (double) n;
-      xm[2] += x[i][2] / (double) n;
-    }
+    xm[0] = s[2] / s[0];
+    xm[1] = s[3] / s[0];
+    xm[2] = s[4] / s[0];
     cart2geo(xm, &dummy, &lon, &lat);
-    fprintf(out, "%.2f %g %g %g", t, Z(gsl_stats_mean(p, 1, n)), lon, lat);
+    fprintf(out, "%.2f %g %g %g", t, Z(s[1] / s[0]), lon, lat);
 
     /* Get quantity statistics... */
     for (iq = 0; iq < ctl->nq; iq++) {
       fprintf(out, " ");
-      fprintf(out, ctl->qnt_format[iq], gsl_stats_mean(q[iq], 1, n));
+      fprintf(out, ctl->qnt_format[iq], s[5 + iq] / s[0]);
     }
     for (iq = 0; iq < ctl->nq; iq++) {
       fprintf(out, " ");
-      fprintf(out, ctl->qnt_format[iq], gsl_stats_sd(q[iq], 1, n));
+      fprintf(out, ctl->qnt_format[iq],
+	      sqrt(s[5 + ctl->nq + iq] / (s[0] - 1)));
+    }
+    fprintf(out, " %.0f\n", s[0]);
+  }
+
+  /* Free... */
+  free(key);
+  free(seg);
+  free(fp);
+  free(pe);
+  free(pi0);
+  free(pi1);
+  free(ps);
+  free(stat);
+
+  /* Close file... */
+  if (t == ctl->t_stop && out) {
+    fclose(out);
+    out = NULL;
+  }
+}
+
+/*****************************************************************************/
+
+void write_grid(
+  const char *filename,
+  ctl_t * ctl,
+  met_t * met0,
+  met_t * met1,
+  atm_t * atm,
+  double t) {
+
+  double *ccd, *cmass, *cvmr, dz, dlon, dlat, t0, t1;
+
+  int *cnp;
+
+  size_t ic = 0, nc = 0, *perm;
+
+  unsigned long *cidx, *idx, ncell;
+
+  /* Check dimensions... */
+  if (ctl->grid_nx < 1 || ctl->grid_ny < 1 || ctl->grid_nz < 1)
+    ERRMSG("Grid dimensions must be positive!");
+
+  /* Set time interval for output... */
+  t0 = t - 0.5 * ctl->dt_mod;
+  t1 = t + 0.5 * ctl->dt_mod;
+
+  /* Set grid box size... */
+  dz = (ctl->grid_z1 - ctl->grid_z0) / ctl->grid_nz;
+  dlon = (ctl->grid_lon1 - ctl->grid_lon0) / ctl->grid_nx;
+  dlat = (ctl->grid_lat1 - ctl->grid_lat0) / ctl->grid_ny;
+
+  /* Get number of grid boxes... */
+  ncell = (unsigned long) ctl->grid_nx * (unsigned long) ctl->grid_ny
+    * (unsigned long) ctl->grid_nz;
+
+  /* Bin air parcels on the full grid (on the device)... */
+  int dense = 0;
+#ifdef _OPENACC
+  int dev = acc_is_present(atm, sizeof(atm_t));
+  dense = dev;
+#endif
+  if (dense) {
+
+    double *dmass;
+
+    int *dnp;
+
+    /* Allocate... */
+    ALLOC(dmass, double,
+	  ncell);
+    ALLOC(dnp, int,
+	  ncell);
+
+    /* Sum up number of air parcels and mass of each grid box... */
+#ifdef _OPENACC
+#pragma acc parallel loop independent gang vector present(ctl,atm) copy(dmass[0:ncell],dnp[0:ncell]) if(dev)
+#endif
+    for (int ip = 0; ip < atm->np; ip++)
+      if (atm->time[ip] >= t0 && atm->time[ip] <= t1) {
+	int ix = (int) ((atm->lon[ip] - ctl->grid_lon0) / dlon);
+	int iy = (int) ((atm->lat[ip] - ctl->grid_lat0) / dlat);
+	int iz = (int) ((Z(atm->p[ip]) - ctl->grid_z0) / dz);
+	if (ix >= 0 && ix < ctl->grid_nx && iy >= 0 && iy < ctl->grid_ny
+	    && iz >= 0 && iz < ctl->grid_nz) {
+	  unsigned long i =
+	    ((unsigned long) ix * (unsigned long) ctl->grid_ny
+	     + (unsigned long) iy) * (unsigned long) ctl->grid_nz
+	    + (unsigned long) iz;
+#ifdef _OPENACC
+#pragma acc atomic update
+#endif
+	  dnp[i]++;
+	  if (ctl->qnt_m >= 0) {
+#ifdef _OPENACC
+#pragma acc atomic update
+#endif
+	    dmass[i] += atm->q[ctl->qnt_m][ip];
+	  }
+	}
+      }
+
+    /* Count non-empty grid boxes... */
+    for (unsigned long i = 0; i < ncell; i++)
+      if (dnp[i] > 0)
+	nc++;
+
+    /* Allocate... */
+    ALLOC(cidx, unsigned long,
+	  GSL_MAX(nc, 1));
+    ALLOC(cnp, int,
+	  GSL_MAX(nc, 1));
+    ALLOC(cmass, double,
+	  GSL_MAX(nc, 1));
+
+    /* Compact non-empty grid boxes... */
+    for (unsigned long i = 0; i < ncell; i++)
+      if (dnp[i] > 0) {
+	cidx[ic] = i;
+	cnp[ic] = dnp[i];
+	cmass[ic] = dmass[i];
+	ic++;
+      }
+
+    /* Free... */
+    free(dmass);
+    free(dnp);
+  }
+
+  /* Bin air parcels on the host... */
+  else {
+
+    /* Allocate... */
+    ALLOC(idx, unsigned long,
+	  atm->np);
+    ALLOC(perm, size_t,
+	  atm->np);
+
+    /* Get grid box index of each air parcel (ncell if outside)... */
+#pragma omp parallel for default(shared)
+    for (int ip = 0; ip < atm->np; ip++) {
+      idx[ip] = ncell;
+      if (atm->time[ip] >= t0 && atm->time[ip] <= t1) {
+	int ix = (int) ((atm->lon[ip] - ctl->grid_lon0) / dlon);
+	int iy = (int) ((atm->lat[ip] - ctl->grid_lat0) / dlat);
+	int iz = (int) ((Z(atm->p[ip]) - ctl->grid_z0) / dz);
+	if (ix >= 0 && ix < ctl->grid_nx && iy >= 0 && iy < ctl->grid_ny
+	    && iz >= 0 && iz < ctl->grid_nz)
+	  idx[ip] = ((unsigned long) ix * (unsigned long) ctl->grid_ny
+		      + (unsigned long) iy) * (unsigned long) ctl->grid_nz
+	    + (unsigned long) iz;
+      }
+    }
+
+    /* Sort air parcels by grid box... */
+    gsl_sort_ulong_index(perm, idx, 1, (size_t) atm->np);
+
+    /* Count non-empty grid boxes... */
+    for (size_t ip = 0; ip < (size_t) atm->np && idx[perm[ip]] < ncell; ip++)
+      if (ip == 0 || idx[perm[ip]] != idx[perm[ip - 1]])
+	nc++;
+
+    /* Allocate... */
+    ALLOC(cidx, unsigned long,
+	  GSL_MAX(nc, 1));
+    ALLOC(cnp, int,
+	  GSL_MAX(nc, 1));
+    ALLOC(cmass, double,
+	  GSL_MAX(nc, 1));
+
+    /* Sum up number of air parcels and mass of each grid box... */
+    for (size_t ip = 0; ip < (size_t) atm->np && idx[perm[ip]] < ncell; ip++) {
+      if (ip > 0 && idx[perm[ip]] != idx[perm[ip - 1]])
+	ic++;
+      cidx[ic] = idx[perm[ip]];
+      cnp[ic]++;
+      if (ctl->qnt_m >= 0)
+	cmass[ic] += atm->q[ctl->qnt_m][perm[ip]];
+    }
+
+    /* Free... */
+    free(idx);
+    free(perm);
+  }
+
+#ifdef MPI
+  /* Merge non-empty grid boxes of all MPI tasks on master... */
+  if (ctl->mpi_decomp) {
+
+    double *gmass = NULL;
+
+    int *cnt = NULL, *dsp = NULL, *gnp = NULL, n = (int) nc, ntot = 0,
+      rank, size;
+
+    unsigned long *gidx = NULL;
+
+    /* Gather number of grid boxes... */
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    if (rank == 0) {
+      ALLOC(cnt, int,
+	    size);
+      ALLOC(dsp, int,
+	    size);
+    }
+    MPI_Gather(&n, 1, MPI_INT, cnt, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    if (rank == 0) {
+      for (int i = 0; i < size; i++) {
+	if (cnt[i] > INT_MAX - ntot)
+	  ERRMSG("Too many grid boxes for MPI_Gatherv!");
+	dsp[i] = ntot;
+	ntot += cnt[i];
+      }
+      ALLOC(gidx, unsigned long,
+	    GSL_MAX(ntot, 1));
+      ALLOC(gnp, int,
+	    GSL_MAX(ntot, 1));
+      ALLOC(gmass, double,
+	    GSL_MAX(ntot, 1));
+    }
+
+    /* Gather grid boxes... */
+    MPI_Gatherv(cidx, n, MPI_UNSIGNED_LONG, gidx, cnt, dsp,
+		MPI_UNSIGNED_LONG, 0, MPI_COMM_WORLD);
+    MPI_Gatherv(cnp, n, MPI_INT, gnp, cnt, dsp, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Gatherv(cmass, n, MPI_DOUBLE, gmass, cnt, dsp, MPI_DOUBLE, 0,
+		MPI_COMM_WORLD);
+    free(cidx);
+    free(cnp);
+    free(cmass);
+    if (rank != 0)
+      return;
+
+    /* Sort grid boxes by index... */
+    ALLOC(perm, size_t,
+	  GSL_MAX(ntot, 1));
+    gsl_sort_ulong_index(perm, gidx, 1, (size_t) ntot);
+
+    /* Count distinct grid boxes... */
+    nc = 0;
+    for (int i = 0; i < ntot; i++)
+      if (i == 0 || gidx[perm[i]] != gidx[perm[i - 1]])
+	nc++;
+
+    /* Allocate... */
+    ALLOC(cidx, unsigned long,
+	  GSL_MAX(nc, 1));
+    ALLOC(cnp, int,
+	  GSL_MAX(nc, 1));
+    ALLOC(cmass, double,
+	  GSL_MAX(nc, 1));
+
+    /* Sum up grid boxes with the same index... */
+    ic = 0;
+    for (int i = 0; i < ntot; i++) {
+      if (i > 0 && gidx[perm[i]] != gidx[perm[i - 1]])
+	ic++;
+      cidx[ic] = gidx[perm[i]];
+      cnp[ic] += gnp[perm[i]];
+      cmass[ic] += gmass[perm[i]];
     }
-    fprintf(out, " %lu\n", n);
+
+    /* Free... */
+    free(cnt);
+    free(dsp);
+    free(gidx);
+    free(gnp);
+    free(gmass);
+    free(perm);
   }
+#endif
 
-  /* Close file... */
-  if (t == ctl->t_stop)
-    fclose(out);
+  /* Allocate... */
+  ALLOC(ccd, double,
+	GSL_MAX(nc, 1));
+  ALLOC(cvmr, double,
+	GSL_MAX(nc, 1));
+
+  /* Calculate column density and volume mixing ratio... */
+#pragma omp parallel for default(shared)
+  for (ic = 0; ic < nc; ic++) {
+
+    /* Set coordinates... */
+    int ix = (int) (cidx[ic] / ((unsigned long) ctl->grid_ny
+				 * (unsigned long) ctl->grid_nz));
+    int iy = (int) (cidx[ic] / (unsigned long) ctl->grid_nz
+		    % (unsigned long) ctl->grid_ny);
+    int iz = (int) (cidx[ic] % (unsigned long) ctl->grid_nz);
+    double z = ctl->grid_z0 + dz * (iz + 0.5);
+    double lon = ctl->grid_lon0 + dlon * (ix + 0.5);
+    double lat = ctl->grid_lat0 + dlat * (iy + 0.5);
+
+    /* Get pressure and temperature... */
+    double press = P(z), temp, cw[3];
+    int ci[3];
+    intpol_met_time_3d(met0, met0->t, met1, met1->t, t, press, lon,
+		       lat, &temp, ci, cw, 1);
+
+    /* Calculate surface area... */
+    double area = dlat * dlon * SQR(RE * M_PI / 180.)
+      * cos(lat * M_PI / 180.);
+
+    /* Calculate column density... */
+    ccd[ic] = cmass[ic] / (1e6 * area);
+
+    /* Calculate volume mixing ratio... */
+    double rho_air = 100. * press / (RA * temp);
+    cvmr[ic] = (ctl->molmass > 0) ? MA / ctl->molmass * cmass[ic]
+      / (rho_air * 1e6 * area * 1e3 * dz) : GSL_NAN;
+  }
+
+  /* Write data (the arrays are freed by the writer)... */
+  write_async_grid(filename, ctl, t, nc, cidx, cnp, cmass, ccd, cvmr);
 }
 
 /*****************************************************************************/
 
-void write_grid(
+void write_grid_asc(
   const char *filename,
   ctl_t * ctl,
-  met_t * met0,
-  met_t * met1,
-  atm_t * atm,
-  double t) {
+  double t,
+  size_t nc,
+  unsigned long *cidx,
+  int *cnp,
+  double *cmass,
+  double *ccd,
+  double *cvmr) {
 
   FILE *in, *out;
 
   char line[LEN];
 
-  static double mass[GX][GY][GZ], z, dz, lon, dlon, lat, dlat,
-    area, rho_air, press, temp, cd, vmr, t0, t1, r, cw[3];
+  double z, dz, lon, dlon, lat, dlat, area, r;
 
-  static int ip, ix, iy, iz, np[GX][GY][GZ], year, mon, day, hour, min, sec,
-    ci[3];
+  int ix, iy, iz, year, mon, day, hour, min, sec;
 
-  /* Check dimensions... */
-  if (ctl->grid_nx > GX || ctl->grid_ny > GY || ctl->grid_nz > GZ)
-    ERRMSG("Grid dimensions too large!");
+  size_t ic = 0;
 
-  /* Set time interval for output... */
-  t0 = t - 0.5 * ctl->dt_mod;
-  t1 = t + 0.5 * ctl->dt_mod;
+  unsigned long icell;
 
   /* Set grid box size... */
   dz = (ctl->grid_z1 - ctl->grid_z0) / ctl->grid_nz;
   dlon = (ctl->grid_lon1 - ctl->grid_lon0) / ctl->grid_nx;
   dlat = (ctl->grid_lat1 - ctl->grid_lat0) / ctl->grid_ny;
 
-  /* Initialize grid... */
-#pragma omp parallel for default(shared) private(ix,iy,iz)
-  for (ix = 0; ix < ctl->grid_nx; ix++)
-    for (iy = 0; iy < ctl->grid_ny; iy++)
-      for (iz = 0; iz < ctl->grid_nz; iz++) {
-	mass[ix][iy][iz] = 0;
-	np[ix][iy][iz] = 0;
-      }
-
-  /* Average data... */
-#pragma omp parallel for default(shared) private(ip,ix,iy,iz)
-  for (ip = 0; ip < atm->np; ip++)
-    if (atm->time[ip] >= t0 && atm->time[ip] <= t1) {
-
-      /* Get index... */
-      ix = (int) ((atm->lon[ip] - ctl->grid_lon0) / dlon);
-      iy = (int) ((atm->lat[ip] - ctl->grid_lat0) / dlat);
-      iz = (int) ((Z(atm->p[ip]) - ctl->grid_z0) / dz);
-
-      /* Check indices... */
-      if (ix < 0 || ix >= ctl->grid_nx ||
-	  iy < 0 || iy >= ctl->grid_ny || iz < 0 || iz >= ctl->grid_nz)
-	continue;
-
-      /* Add mass... */
-      if (ctl->qnt_m >= 0)
-	mass[ix][iy][iz] += atm->q[ctl->qnt_m][ip];
-      np[ix][iy][iz]++;
-    }
-
   /* Check if gnuplot output is requested... */
   if (ctl->grid_gpfile[0] != '-') {
 
@@ -4070,47 +8039,453 @@ void write_grid(
 	  "# $8 = column density [kg/m^2]\n"
 	  "# $9 = volume mixing ratio [ppv]\n\n");
 
-  /* Write data... */
-  for (ix = 0; ix < ctl->grid_nx; ix++) {
-    if (ix > 0 && ctl->grid_ny > 1 && !ctl->grid_sparse)
-      fprintf(out, "\n");
-    for (iy = 0; iy < ctl->grid_ny; iy++) {
-      if (iy > 0 && ctl->grid_nz > 1 && !ctl->grid_sparse)
+  /* Write sparse data... */
+  if (ctl->grid_sparse) {
+    for (ic = 0; ic < nc; ic++)
+      if (cmass[ic] > 0) {
+
+	/* Set coordinates... */
+	ix = (int) (cidx[ic] / ((unsigned long) ctl->grid_ny
+				* (unsigned long) ctl->grid_nz));
+	iy = (int) (cidx[ic] / (unsigned long) ctl->grid_nz
+		    % (unsigned long) ctl->grid_ny);
+	iz = (int) (cidx[ic] % (unsigned long) ctl->grid_nz);
+	z = ctl->grid_z0 + dz * (iz + 0.5);
+	lon = ctl->grid_lon0 + dlon * (ix + 0.5);
+	lat = ctl->grid_lat0 + dlat * (iy + 0.5);
+
+	/* Calculate surface area... */
+	area = dlat * dlon * SQR(RE * M_PI / 180.)
+	  * cos(lat * M_PI / 180.);
+
+	/* Write output... */
+	fprintf(out, "%.2f %g %g %g %g %g %d %g %g\n",
+		t, z, lon, lat, area, dz, cnp[ic], ccd[ic], cvmr[ic]);
+      }
+  }
+
+  /* Write dense data... */
+  else {
+    for (ix = 0, icell = 0; ix < ctl->grid_nx; ix++) {
+      if (ix > 0 && ctl->grid_ny > 1)
 	fprintf(out, "\n");
-      for (iz = 0; iz < ctl->grid_nz; iz++)
-	if (!ctl->grid_sparse || mass[ix][iy][iz] > 0) {
+      for (iy = 0; iy < ctl->grid_ny; iy++) {
+	if (iy > 0 && ctl->grid_nz > 1)
+	  fprintf(out, "\n");
+	for (iz = 0; iz < ctl->grid_nz; iz++, icell++) {
 
 	  /* Set coordinates... */
 	  z = ctl->grid_z0 + dz * (iz + 0.5);
 	  lon = ctl->grid_lon0 + dlon * (ix + 0.5);
 	  lat = ctl->grid_lat0 + dlat * (iy + 0.5);
 
-	  /* Get pressure and temperature... */
-	  press = P(z);
-	  intpol_met_time_3d(met0, met0->t, met1, met1->t, t, press, lon,
-			     lat, &temp, ci, cw, 1);
-
 	  /* Calculate surface area... */
 	  area = dlat * dlon * SQR(RE * M_PI / 180.)
 	    * cos(lat * M_PI / 180.);
 
-	  /* Calculate column density... */
-	  cd = mass[ix][iy][iz] / (1e6 * area);
-
-	  /* Calculate volume mixing ratio... */
-	  rho_air = 100. * press / (RA * temp);
-	  vmr = (ctl->molmass > 0) ? MA / ctl->molmass * mass[ix][iy][iz]
-	    / (rho_air * 1e6 * area * 1e3 * dz) : GSL_NAN;
-
 	  /* Write output... */
-	  fprintf(out, "%.2f %g %g %g %g %g %d %g %g\n",
-		  t, z, lon, lat, area, dz, np[ix][iy][iz], cd, vmr);
+	  if (ic < nc && cidx[ic] == icell) {
+	    fprintf(out, "%.2f %g %g %g %g %g %d %g %g\n",
+		    t, z, lon, lat, area, dz, cnp[ic], ccd[ic], cvmr[ic]);
+	    ic++;
+	  } else
+	    fprintf(out, "%.2f %g %g %g %g %g %d %g %g\n",
+		    t, z, lon, lat, area, dz, 0, 0.0,
+		    (ctl->molmass > 0) ? 0.0 : GSL_NAN);
 	}
+      }
+    }
+  }
+
+  /* Close file... */
+  fclose(out);
+}
+
+/*****************************************************************************/
+
+void write_grid_nc(
+  const char *filename,
+  ctl_t * ctl,
+  double t,
+  size_t nc,
+  unsigned long *cidx,
+  int *cnp,
+  double *ccd,
+  double *cvmr) {
+
+  double *help, *lon, *lat, *z;
+
+  int *ihelp, ix, iy, iz, ncid, dimid[4], tid, zid, lonid, latid, npid,
+    cdid, vmrid;
+
+  size_t ic, icell, ncell;
+
+  /* Write info... */
+  printf("Write grid data: %s\n", filename);
+
+  /* Get number of grid boxes... */
+  ncell = (size_t) ctl->grid_nx * (size_t) ctl->grid_ny
+    * (size_t) ctl->grid_nz;
+
+  /* Allocate... */
+  ALLOC(lon, double,
+	ctl->grid_sparse ? GSL_MAX(nc, 1) : (size_t) ctl->grid_nx);
+  ALLOC(lat, double,
+	ctl->grid_sparse ? GSL_MAX(nc, 1) : (size_t) ctl->grid_ny);
+  ALLOC(z, double,
+	ctl->grid_sparse ? GSL_MAX(nc, 1) : (size_t) ctl->grid_nz);
+
+  /* Create file... */
+  pthread_mutex_lock(&nc_mutex);
+  NC(nc_create(filename, NC_CLOBBER | (ctl->nc_level > 0 ? NC_NETCDF4
+				       : NC_64BIT_OFFSET), &ncid));
+
+  /* Define dimensions and coordinates... */
+  NC(nc_def_dim(ncid, "time", 1, &dimid[0]));
+  NC_DEF_VAR(ncid, "time", NC_DOUBLE, 1, dimid, tid, "time",
+	     "seconds since 2000-01-01 00:00:00 UTC");
+  if (ctl->grid_sparse) {
+    NC(nc_def_dim(ncid, "ncells", nc > 0 ? nc : NC_UNLIMITED, &dimid[1]));
+    NC_DEF_VAR(ncid, "z", NC_DOUBLE, 1, &dimid[1], zid, "altitude", "km");
+    NC_DEF_VAR(ncid, "lat", NC_DOUBLE, 1, &dimid[1], latid, "latitude",
+	       "degrees_north");
+    NC_DEF_VAR(ncid, "lon", NC_DOUBLE, 1, &dimid[1], lonid, "longitude",
+	       "degrees_east");
+  } else {
+    NC(nc_def_dim(ncid, "z", (size_t) ctl->grid_nz, &dimid[1]));
+    NC(nc_def_dim(ncid, "lat", (size_t) ctl->grid_ny, &dimid[2]));
+    NC(nc_def_dim(ncid, "lon", (size_t) ctl->grid_nx, &dimid[3]));
+    NC_DEF_VAR(ncid, "z", NC_DOUBLE, 1, &dimid[1], zid, "altitude", "km");
+    NC_DEF_VAR(ncid, "lat", NC_DOUBLE, 1, &dimid[2], latid, "latitude",
+	       "degrees_north");
+    NC_DEF_VAR(ncid, "lon", NC_DOUBLE, 1, &dimid[3], lonid, "longitude",
+	       "degrees_east");
+  }
+
+  /* Define variables... */
+  int ndims = ctl->grid_sparse ? 1 : 4,
+    *dims = ctl->grid_sparse ? &dimid[1] : dimid;
+  NC_DEF_VAR(ncid, "np", NC_INT, ndims, dims, npid,
+	     "number of particles", "1");
+  NC_DEF_VAR(ncid, "cd", NC_DOUBLE, ndims, dims, cdid,
+	     "column density", "kg m**-2");
+  NC_DEF_VAR(ncid, "vmr", NC_DOUBLE, ndims, dims, vmrid,
+	     "volume mixing ratio", "ppv");
+
+  /* Set compression... */
+  if (!ctl->grid_sparse || nc > 0) {
+    NC_DEFLATE(ncid, npid, (size_t *) NULL, ctl->nc_level);
+    NC_DEFLATE(ncid, cdid, (size_t *) NULL, ctl->nc_level);
+    NC_DEFLATE(ncid, vmrid, (size_t *) NULL, ctl->nc_level);
+  }
+
+  /* End definitions... */
+  NC(nc_enddef(ncid));
+
+  /* Write time... */
+  NC(nc_put_var_double(ncid, tid, &t));
+
+  /* Write sparse data (coordinate list of non-empty grid boxes)... */
+  if (ctl->grid_sparse) {
+    for (ic = 0; ic < nc; ic++) {
+      ix = (int) (cidx[ic] / ((unsigned long) ctl->grid_ny
+			      * (unsigned long) ctl->grid_nz));
+      iy = (int) (cidx[ic] / (unsigned long) ctl->grid_nz
+		  % (unsigned long) ctl->grid_ny);
+      iz = (int) (cidx[ic] % (unsigned long) ctl->grid_nz);
+      z[ic] = ctl->grid_z0 + (ctl->grid_z1 - ctl->grid_z0)
+	/ ctl->grid_nz * (iz + 0.5);
+      lon[ic] = ctl->grid_lon0 + (ctl->grid_lon1 - ctl->grid_lon0)
+	/ ctl->grid_nx * (ix + 0.5);
+      lat[ic] = ctl->grid_lat0 + (ctl->grid_lat1 - ctl->grid_lat0)
+	/ ctl->grid_ny * (iy + 0.5);
+    }
+    if (nc > 0) {
+      NC(nc_put_var_double(ncid, zid, z));
+      NC(nc_put_var_double(ncid, latid, lat));
+      NC(nc_put_var_double(ncid, lonid, lon));
+      NC(nc_put_var_int(ncid, npid, cnp));
+      round_bits(ccd, nc, ctl->nc_quant);
+      NC(nc_put_var_double(ncid, cdid, ccd));
+      round_bits(cvmr, nc, ctl->nc_quant);
+      NC(nc_put_var_double(ncid, vmrid, cvmr));
+    }
+  }
+
+  /* Write dense data... */
+  else {
+
+    /* Write coordinates... */
+    for (iz = 0; iz < ctl->grid_nz; iz++)
+      z[iz] = ctl->grid_z0 + (ctl->grid_z1 - ctl->grid_z0)
+	/ ctl->grid_nz * (iz + 0.5);
+    for (iy = 0; iy < ctl->grid_ny; iy++)
+      lat[iy] = ctl->grid_lat0 + (ctl->grid_lat1 - ctl->grid_lat0)
+	/ ctl->grid_ny * (iy + 0.5);
+    for (ix = 0; ix < ctl->grid_nx; ix++)
+      lon[ix] = ctl->grid_lon0 + (ctl->grid_lon1 - ctl->grid_lon0)
+	/ ctl->grid_nx * (ix + 0.5);
+    NC(nc_put_var_double(ncid, zid, z));
+    NC(nc_put_var_double(ncid, latid, lat));
+    NC(nc_put_var_double(ncid, lonid, lon));
+
+    /* Allocate... */
+    ALLOC(help, double,
+	  ncell);
+    ALLOC(ihelp, int,
+	  ncell);
+
+    /* Scatter non-empty grid boxes to (z, lat, lon) arrays... */
+    for (icell = 0; icell < ncell; icell++) {
+      help[icell] = 0;
+      ihelp[icell] = 0;
+    }
+    for (ic = 0; ic < nc; ic++) {
+      ix = (int) (cidx[ic] / ((unsigned long) ctl->grid_ny
+			      * (unsigned long) ctl->grid_nz));
+      iy = (int) (cidx[ic] / (unsigned long) ctl->grid_nz
+		  % (unsigned long) ctl->grid_ny);
+      iz = (int) (cidx[ic] % (unsigned long) ctl->grid_nz);
+      icell = ((size_t) iz * (size_t) ctl->grid_ny + (size_t) iy)
+	* (size_t) ctl->grid_nx + (size_t) ix;
+      help[icell] = ccd[ic];
+      ihelp[icell] = cnp[ic];
     }
+    round_bits(help, ncell, ctl->nc_quant);
+    NC(nc_put_var_double(ncid, cdid, help));
+    NC(nc_put_var_int(ncid, npid, ihelp));
+
+    /* Write volume mixing ratios... */
+    for (icell = 0; icell < ncell; icell++)
+      help[icell] = (ctl->molmass > 0) ? 0 : GSL_NAN;
+    for (ic = 0; ic < nc; ic++) {
+      ix = (int) (cidx[ic] / ((unsigned long) ctl->grid_ny
+			      * (unsigned long) ctl->grid_nz));
+      iy = (int) (cidx[ic] / (unsigned long) ctl->grid_nz
+		  % (unsigned long) ctl->grid_ny);
+      iz = (int) (cidx[ic] % (unsigned long) ctl->grid_nz);
+      help[((size_t) iz * (size_t) ctl->grid_ny + (size_t) iy)
+	   * (size_t) ctl->grid_nx + (size_t) ix] = cvmr[ic];
+    }
+    round_bits(help, ncell, ctl->nc_quant);
+    NC(nc_put_var_double(ncid, vmrid, help));
+
+    /* Free... */
+    free(help);
+    free(ihelp);
+  }
+
+  /* Close file... */
+  NC(nc_close(ncid));
+  pthread_mutex_unlock(&nc_mutex);
+
+  /* Free... */
+  free(lon);
+  free(lat);
+  free(z);
+}
+
+/*****************************************************************************/
+
+void write_met_cache(
+  ctl_t * ctl,
+  char *filename,
+  met_t * met) {
+
+  FILE *out;
+
+  char cachefile[2 * LEN], tmpfile[3 * LEN];
+
+  float *fields[14] = { met->ps, met->zs, met->pt, met->pc, met->cl,
+    met->z, met->t, met->pv, met->h2o, met->o3, met->lwc, met->iwc,
+    met->pl, met->uvw
+  };
+
+  int dims[8] = { MET_CACHE_VERSION, met->nx, met->ny, met->np,
+    met->ex, met->ey, met->ep, 0
+  };
+
+  unsigned long key;
+
+  /* Get cache file... */
+  key = read_met_cache_file(ctl, filename, cachefile);
+
+  /* Write info... */
+  printf("Write meteorological cache: %s\n", cachefile);
+
+  /* Create temporary file... */
+  sprintf(tmpfile, "%s.%d.tmp", cachefile, (int) getpid());
+  if (!(out = fopen(tmpfile, "w"))) {
+    WARN("Cannot create cache file!");
+    return;
   }
 
+  /* Write header... */
+  FWRITE("MPTRACMC", char,
+	 8,
+	 out);
+  FWRITE(dims, int,
+	 8,
+	 out);
+  FWRITE(&key, unsigned long,
+	 1,
+	 out);
+  FWRITE(&met->time, double,
+	 1,
+	 out);
+  FWRITE(met->lon, double,
+	 EX,
+	 out);
+  FWRITE(met->lat, double,
+	 EY,
+	 out);
+  FWRITE(met->p, double,
+	 EP,
+	 out);
+
+  /* Write data... */
+  for (int i = 0; i < 14; i++)
+    FWRITE(fields[i], float,
+	     (size_t) (i < 5 ? 1 : i < 13 ? met->ep : 3 * met->ep)
+	     * (size_t) met->ex
+	     * (size_t) met->ey,
+	   out);
+
   /* Close file... */
   fclose(out);
+
+  /* Make file visible to other runs... */
+  if (rename(tmpfile, cachefile) != 0)
+    WARN("Cannot rename cache file!");
+}
+
+/*****************************************************************************/
+
+void write_perf(
+  const char *filename,
+  ctl_t * ctl,
+  cache_t * cache,
+  double t) {
+
+  static FILE *out;
+
+  static const char *tname[NPERF] = { "init", "input", "output", "advect",
+    "decay", "diffmeso", "diffturb", "isosurf", "meteo", "position", "sedi",
+    "ohchem", "wetdepo", "sort", "step"
+  }, *cname[NCOUNTER] = {
+  "met_files", "met_bytes", "h2d_bytes", "h2d_time", "d2h_bytes",
+      "d2h_time"};
+
+  static const int tid[NPERF] = { TIMER_INIT, TIMER_INPUT, TIMER_OUTPUT,
+    TIMER_ADVECT, TIMER_DECAY, TIMER_DIFFMESO, TIMER_DIFFTURB,
+    TIMER_ISOSURF, TIMER_METEO, TIMER_POSITION, TIMER_SEDI, TIMER_OHCHEM,
+    TIMER_WETDEPO, TIMER_SORT, TIMER_STEP
+  };
+
+  static double t0, tm0[NPERF], tm1[NPERF], c0[NCOUNTER], c1[NCOUNTER],
+    w0, w1, nsum;
+
+  static int nstep;
+
+  char file[2 * LEN];
+
+  double c[NCOUNTER], tm[NPERF], w = omp_get_wtime();
+
+  /* Get timers and counters... */
+  for (int it = 0; it < NPERF; it++)
+    tm[it] = timer(tname[it], tid[it], 4);
+  for (int ic = 0; ic < NCOUNTER; ic++)
+    c[ic] = counter(ic, 0);
+
+  /* Init (or resume from checkpoint)... */
+  if (t == ctl->t_start || !out) {
+    int resume = (t != ctl->t_start);
+
+    /* Create new file... */
+    sprintf(file, "%s.csv", filename);
+    printf("Write performance data: %s\n", file);
+    write_chk_open(file, CHKW_PERF, resume, &out);
+
+    /* Write header... */
+    if (!resume) {
+      fprintf(out, "time,wall,nact,rate");
+      for (int it = 0; it < NPERF; it++)
+	fprintf(out, ",%s", tname[it]);
+      for (int ic = 0; ic < NCOUNTER; ic++)
+	fprintf(out, ",%s", cname[ic]);
+      fprintf(out, "\n");
+    }
+
+    /* Save initial state... */
+    memcpy(tm0, tm, sizeof(tm));
+    memcpy(tm1, tm, sizeof(tm));
+    memcpy(c0, c, sizeof(c));
+    memcpy(c1, c, sizeof(c));
+    w0 = w1 = w;
+    t0 = t;
+    nsum = 0;
+    nstep = 0;
+
+    /* Restore totals of the run before the checkpoint... */
+    if (resume) {
+      t0 = chk_wr.state.acc[CHKW_PERF][0];
+      nsum = chk_wr.state.acc[CHKW_PERF][1];
+      nstep = (int) chk_wr.state.acc[CHKW_PERF][2];
+      w0 -= chk_wr.state.acc[CHKW_PERF][3];
+    }
+  }
+
+  /* Write data of current time step... */
+  fprintf(out, "%.2f,%g,%d,%g", t, w - w1, cache->nact,
+	  w > w1 ? cache->nact / (w - w1) : 0);
+  for (int it = 0; it < NPERF; it++)
+    fprintf(out, ",%g", tm[it] - tm1[it]);
+  for (int ic = 0; ic < NCOUNTER; ic++)
+    fprintf(out, ",%g", c[ic] - c1[ic]);
+  fprintf(out, "\n");
+
+  /* Save current state... */
+  memcpy(tm1, tm, sizeof(tm));
+  memcpy(c1, c, sizeof(c));
+  w1 = w;
+  nsum += cache->nact;
+  nstep++;
+
+  /* Keep totals for checkpoints... */
+  chk_wr.state.acc[CHKW_PERF][0] = t0;
+  chk_wr.state.acc[CHKW_PERF][1] = nsum;
+  chk_wr.state.acc[CHKW_PERF][2] = nstep;
+  chk_wr.state.acc[CHKW_PERF][3] = w - w0;
+
+  /* Finalize... */
+  if (t == ctl->t_stop) {
+
+    FILE *json;
+
+    /* Close file... */
+    fclose(out);
+    out = NULL;
+
+    /* Write summary... */
+    sprintf(file, "%s.json", filename);
+    printf("Write performance summary: %s\n", file);
+    if (!(json = fopen(file, "w")))
+      ERRMSG("Cannot create file!");
+    fprintf(json, "{\n  \"t0\": %.2f,\n  \"t1\": %.2f,\n  \"steps\": %d,\n"
+	    "  \"threads\": %d,\n  \"wall\": %g,\n  \"parcel_steps\": %g,\n"
+	    "  \"rate\": %g,\n  \"timers\": {", t0, t, nstep,
+	    omp_get_max_threads(), w - w0, nsum,
+	    w > w0 ? nsum / (w - w0) : 0);
+    for (int it = 0; it < NPERF; it++)
+      fprintf(json, "%s\n    \"%s\": %g", it ? "," : "", tname[it],
+	      tm[it] - tm0[it]);
+    fprintf(json, "\n  },\n  \"counters\": {");
+    for (int ic = 0; ic < NCOUNTER; ic++)
+      fprintf(json, "%s\n    \"%s\": %g", ic ? "," : "", cname[ic],
+	      c[ic] - c0[ic]);
+    fprintf(json, "\n  }\n}\n");
+    fclose(json);
+  }
 }
 
 /*****************************************************************************/
@@ -4127,54 +8502,74 @@ void write_prof(
 
   static char line[LEN];
 
-  static double mass[GX][GY][GZ], obsmean[GX][GY], rt, rz, rlon, rlat, robs,
-    t0, t1, area, dz, dlon, dlat, lon, lat, z, press, temp, rho_air, vmr, h2o,
-    o3, cw[3];
+  static double *mass, *obsmean, rt, rz, rlon, rlat, robs, t0, t1, area,
+    dz, dlon, dlat, lon, lat, z, press, temp, rho_air, vmr, h2o, o3, cw[3];
 
-  static int obscount[GX][GY], ip, ix, iy, iz, okay, ci[3];
+  static int *obscount, okay, ci[3], ncell;
 
-  /* Init... */
-  if (t == ctl->t_start) {
+  int rank = 0;
+
+  /* Get MPI rank (only the master writes output)... */
+#ifdef MPI
+  if (ctl->mpi_decomp)
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
+
+  /* Init (or resume from checkpoint)... */
+  if (t == ctl->t_start || !mass) {
 
     /* Check quantity index for mass... */
     if (ctl->qnt_m < 0)
       ERRMSG("Need quantity mass!");
 
-    /* Check dimensions... */
-    if (ctl->prof_nx > GX || ctl->prof_ny > GY || ctl->prof_nz > GZ)
-      ERRMSG("Grid dimensions too large!");
+    /* Allocate... */
+    ncell = ctl->prof_nx * ctl->prof_ny * ctl->prof_nz;
+    ALLOC(mass, double,
+	  ncell);
+    ALLOC(obsmean, double,
+	  ctl->prof_nx * ctl->prof_ny);
+    ALLOC(obscount, int,
+	  ctl->prof_nx * ctl->prof_ny);
 
     /* Check molar mass... */
     if (ctl->molmass <= 0)
       ERRMSG("Specify molar mass!");
 
+    /* Set grid box size... */
+    dz = (ctl->prof_z1 - ctl->prof_z0) / ctl->prof_nz;
+    dlon = (ctl->prof_lon1 - ctl->prof_lon0) / ctl->prof_nx;
+    dlat = (ctl->prof_lat1 - ctl->prof_lat0) / ctl->prof_ny;
+  }
+
+  /* Open files on master... */
+  if (rank == 0 && (t == ctl->t_start || !out)) {
+    int resume = (t != ctl->t_start);
+
     /* Open observation data file... */
     printf("Read profile observation data: %s\n", ctl->prof_obsfile);
     if (!(in = fopen(ctl->prof_obsfile, "r")))
       ERRMSG("Cannot open file!");
+    if (resume)
+      fseek(in, chk_wr.state.inpos[CHKW_PROF], SEEK_SET);
+    chk_wr.in[CHKW_PROF] = &in;
 
     /* Create new output file... */
     printf("Write profile data: %s\n", filename);
-    if (!(out = fopen(filename, "w")))
-      ERRMSG("Cannot create file!");
+    write_chk_open(filename, CHKW_PROF, resume, &out);
 
     /* Write header... */
-    fprintf(out,
-	    "# $1 = time [s]\n"
-	    "# $2 = altitude [km]\n"
-	    "# $3 = longitude [deg]\n"
-	    "# $4 = latitude [deg]\n"
-	    "# $5 = pressure [hPa]\n"
-	    "# $6 = temperature [K]\n"
-	    "# $7 = volume mixing ratio [ppv]\n"
-	    "# $8 = H2O volume mixing ratio [ppv]\n"
-	    "# $9 = O3 volume mixing ratio [ppv]\n"
-	    "# $10 = observed BT index [K]\n");
-
-    /* Set grid box size... */
-    dz = (ctl->prof_z1 - ctl->prof_z0) / ctl->prof_nz;
-    dlon = (ctl->prof_lon1 - ctl->prof_lon0) / ctl->prof_nx;
-    dlat = (ctl->prof_lat1 - ctl->prof_lat0) / ctl->prof_ny;
+    if (!resume)
+      fprintf(out,
+	      "# $1 = time [s]\n"
+	      "# $2 = altitude [km]\n"
+	      "# $3 = longitude [deg]\n"
+	      "# $4 = latitude [deg]\n"
+	      "# $5 = pressure [hPa]\n"
+	      "# $6 = temperature [K]\n"
+	      "# $7 = volume mixing ratio [ppv]\n"
+	      "# $8 = H2O volume mixing ratio [ppv]\n"
+	      "# $9 = O3 volume mixing ratio [ppv]\n"
+	      "# $10 = observed BT index [K]\n");
   }
 
   /* Set time interval... */
@@ -4182,17 +8577,16 @@ void write_prof(
   t1 = t + 0.5 * ctl->dt_mod;
 
   /* Initialize... */
-#pragma omp parallel for default(shared) private(ix,iy,iz)
-  for (ix = 0; ix < ctl->prof_nx; ix++)
-    for (iy = 0; iy < ctl->prof_ny; iy++) {
-      obsmean[ix][iy] = 0;
-      obscount[ix][iy] = 0;
-      for (iz = 0; iz < ctl->prof_nz; iz++)
-	mass[ix][iy][iz] = 0;
-    }
+#pragma omp parallel for default(shared)
+  for (int icell = 0; icell < ncell; icell++)
+    mass[icell] = 0;
+  for (int icell = 0; icell < ctl->prof_nx * ctl->prof_ny; icell++) {
+    obsmean[icell] = 0;
+    obscount[icell] = 0;
+  }
 
   /* Read observation data... */
-  while (fgets(line, LEN, in)) {
+  while (rank == 0 && fgets(line, LEN, in)) {
 
     /* Read data... */
     if (sscanf(line, "%lg %lg %lg %lg %lg", &rt, &rz, &rlon, &rlat, &robs) !=
@@ -4206,30 +8600,33 @@ void write_prof(
       break;
 
     /* Calculate indices... */
-    ix = (int) ((rlon - ctl->prof_lon0) / dlon);
-    iy = (int) ((rlat - ctl->prof_lat0) / dlat);
+    int ix = (int) ((rlon - ctl->prof_lon0) / dlon);
+    int iy = (int) ((rlat - ctl->prof_lat0) / dlat);
 
     /* Check indices... */
     if (ix < 0 || ix >= ctl->prof_nx || iy < 0 || iy >= ctl->prof_ny)
       continue;
 
     /* Get mean observation index... */
-    obsmean[ix][iy] += robs;
-    obscount[ix][iy]++;
+    obsmean[ARRAY_2D(ix, iy, ctl->prof_ny)] += robs;
+    obscount[ARRAY_2D(ix, iy, ctl->prof_ny)]++;
   }
 
-  /* Analyze model data... */
-#pragma omp parallel for default(shared) private(ip,ix,iy,iz)
-  for (ip = 0; ip < atm->np; ip++) {
+  /* Analyze model data (on the device if air parcels are present)... */
+#ifdef _OPENACC
+  int dev = acc_is_present(atm, sizeof(atm_t));
+#pragma acc parallel loop independent gang vector present(ctl,atm) copy(mass[0:ncell]) if(dev)
+#endif
+  for (int ip = 0; ip < atm->np; ip++) {
 
     /* Check time... */
     if (atm->time[ip] < t0 || atm->time[ip] > t1)
       continue;
 
     /* Get indices... */
-    ix = (int) ((atm->lon[ip] - ctl->prof_lon0) / dlon);
-    iy = (int) ((atm->lat[ip] - ctl->prof_lat0) / dlat);
-    iz = (int) ((Z(atm->p[ip]) - ctl->prof_z0) / dz);
+    int ix = (int) ((atm->lon[ip] - ctl->prof_lon0) / dlon);
+    int iy = (int) ((atm->lat[ip] - ctl->prof_lat0) / dlat);
+    int iz = (int) ((Z(atm->p[ip]) - ctl->prof_z0) / dz);
 
     /* Check indices... */
     if (ix < 0 || ix >= ctl->prof_nx ||
@@ -4237,18 +8634,39 @@ void write_prof(
       continue;
 
     /* Get total mass in grid cell... */
-    mass[ix][iy][iz] += atm->q[ctl->qnt_m][ip];
+#ifdef _OPENACC
+#pragma acc atomic update
+#endif
+    mass[ARRAY_3D(ix, iy, ctl->prof_ny, iz, ctl->prof_nz)]
+      += atm->q[ctl->qnt_m][ip];
+  }
+
+#ifdef MPI
+  /* Sum up model data of all MPI tasks on master... */
+  if (ctl->mpi_decomp) {
+    MPI_Reduce(rank == 0 ? MPI_IN_PLACE : mass, mass, ncell, MPI_DOUBLE,
+	       MPI_SUM, 0, MPI_COMM_WORLD);
+    if (rank != 0) {
+      if (t == ctl->t_stop) {
+	free(mass);
+	free(obsmean);
+	free(obscount);
+	mass = NULL;
+      }
+      return;
+    }
   }
+#endif
 
   /* Extract profiles... */
-  for (ix = 0; ix < ctl->prof_nx; ix++)
-    for (iy = 0; iy < ctl->prof_ny; iy++)
-      if (obscount[ix][iy] > 0) {
+  for (int ix = 0; ix < ctl->prof_nx; ix++)
+    for (int iy = 0; iy < ctl->prof_ny; iy++)
+      if (obscount[ARRAY_2D(ix, iy, ctl->prof_ny)] > 0) {
 
 	/* Check profile... */
 	okay = 0;
-	for (iz = 0; iz < ctl->prof_nz; iz++)
-	  if (mass[ix][iy][iz] > 0) {
+	for (int iz = 0; iz < ctl->prof_nz; iz++)
+	  if (mass[ARRAY_3D(ix, iy, ctl->prof_ny, iz, ctl->prof_nz)] > 0) {
 	    okay = 1;
 	    break;
 	  }
@@ -4259,7 +8677,7 @@ void write_prof(
 	fprintf(out, "\n");
 
 	/* Loop over altitudes... */
-	for (iz = 0; iz < ctl->prof_nz; iz++) {
+	for (int iz = 0; iz < ctl->prof_nz; iz++) {
 
 	  /* Set coordinates... */
 	  z = ctl->prof_z0 + dz * (iz + 0.5);
@@ -4281,19 +8699,28 @@ void write_prof(
 
 	  /* Calculate volume mixing ratio... */
 	  rho_air = 100. * press / (RA * temp);
-	  vmr = MA / ctl->molmass * mass[ix][iy][iz]
+	  vmr = MA / ctl->molmass
+	    * mass[ARRAY_3D(ix, iy, ctl->prof_ny, iz, ctl->prof_nz)]
 	    / (rho_air * area * dz * 1e9);
 
 	  /* Write output... */
 	  fprintf(out, "%.2f %g %g %g %g %g %g %g %g %g\n",
 		  t, z, lon, lat, press, temp, vmr, h2o, o3,
-		  obsmean[ix][iy] / obscount[ix][iy]);
+		  obsmean[ARRAY_2D(ix, iy, ctl->prof_ny)]
+		  / obscount[ARRAY_2D(ix, iy, ctl->prof_ny)]);
 	}
       }
 
   /* Close file... */
-  if (t == ctl->t_stop)
+  if (t == ctl->t_stop) {
     fclose(out);
+    fclose(in);
+    out = in = NULL;
+    free(mass);
+    free(obsmean);
+    free(obscount);
+    mass = NULL;
+  }
 }
 
 /*****************************************************************************/
@@ -4306,71 +8733,264 @@ void write_station(
 
   static FILE *out;
 
-  static double rmax2, t0, t1, x0[3], x1[3];
+  static double dlat, rmax2, t0, t1, *slat, *sxyz;
 
-  /* Init... */
-  if (t == ctl->t_start) {
+  static int nstat, *sid;
+
+  int rank = 0;
+
+  /* Get MPI rank (only the master writes output)... */
+#ifdef MPI
+  if (ctl->mpi_decomp)
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
+
+  /* Init (or resume from checkpoint)... */
+  if (t == ctl->t_start || !sid) {
+
+    /* Read station list... */
+    double *lons = NULL, *lats = NULL;
+    if (ctl->stat_file[0] != '-') {
+      FILE *in;
+      char line[LEN];
+      double lon, lat;
+      printf("Read station list: %s\n", ctl->stat_file);
+      if (!(in = fopen(ctl->stat_file, "r")))
+	ERRMSG("Cannot open file!");
+      nstat = 0;
+      while (fgets(line, LEN, in))
+	if (sscanf(line, "%lg %lg", &lon, &lat) == 2) {
+	  REALLOC(lons, double,
+		  nstat + 1);
+	  REALLOC(lats, double,
+		  nstat + 1);
+	  lons[nstat] = lon;
+	  lats[nstat] = lat;
+	  nstat++;
+	}
+      fclose(in);
+      if (nstat <= 0)
+	ERRMSG("Station list is empty!");
+    } else {
+      nstat = 1;
+      ALLOC(lons, double,
+	    1);
+      ALLOC(lats, double,
+	    1);
+      lons[0] = ctl->stat_lon;
+      lats[0] = ctl->stat_lat;
+    }
+
+    /* Build station index sorted by latitude... */
+    size_t *perm;
+    ALLOC(perm, size_t, nstat);
+    ALLOC(sid, int,
+	  nstat);
+    ALLOC(slat, double,
+	  nstat);
+    ALLOC(sxyz, double,
+	  3 * nstat);
+    gsl_sort_index(perm, lats, 1, (size_t) nstat);
+    for (int is = 0; is < nstat; is++) {
+      sid[is] = (int) perm[is];
+      slat[is] = lats[perm[is]];
+      geo2cart(0, lons[perm[is]], lats[perm[is]], &sxyz[3 * is]);
+    }
+    free(perm);
+    free(lons);
+    free(lats);
+
+    /* Set search radius and latitude band width... */
+    rmax2 = SQR(ctl->stat_r);
+    dlat = 2. * asin(GSL_MIN(ctl->stat_r / (2. * RE), 1.)) * 180. / M_PI;
+  }
+
+  /* Open file on master... */
+  if (rank == 0 && (t == ctl->t_start || !out)) {
+    int resume = (t != ctl->t_start);
 
     /* Write info... */
     printf("Write station data: %s\n", filename);
 
     /* Create new file... */
-    if (!(out = fopen(filename, "w")))
-      ERRMSG("Cannot create file!");
+    write_chk_open(filename, CHKW_STAT, resume, &out);
 
     /* Write header... */
-    fprintf(out,
-	    "# $1 = time [s]\n"
-	    "# $2 = altitude [km]\n"
-	    "# $3 = longitude [deg]\n" "# $4 = latitude [deg]\n");
-    for (int iq = 0; iq < ctl->nq; iq++)
-      fprintf(out, "# $%i = %s [%s]\n", (iq + 5),
-	      ctl->qnt_name[iq], ctl->qnt_unit[iq]);
-    fprintf(out, "\n");
-
-    /* Set geolocation and search radius... */
-    geo2cart(0, ctl->stat_lon, ctl->stat_lat, x0);
-    rmax2 = SQR(ctl->stat_r);
+    if (!resume) {
+      fprintf(out,
+	      "# $1 = time [s]\n"
+	      "# $2 = altitude [km]\n"
+	      "# $3 = longitude [deg]\n" "# $4 = latitude [deg]\n");
+      for (int iq = 0; iq < ctl->nq; iq++)
+	fprintf(out, "# $%i = %s [%s]\n", (iq + 5),
+		ctl->qnt_name[iq], ctl->qnt_unit[iq]);
+      if (ctl->stat_file[0] != '-')
+	fprintf(out, "# $%i = station index\n", ctl->nq + 5);
+      fprintf(out, "\n");
+    }
   }
 
   /* Set time interval for output... */
   t0 = t - 0.5 * ctl->dt_mod;
   t1 = t + 0.5 * ctl->dt_mod;
 
-  /* Loop over air parcels... */
-  for (int ip = 0; ip < atm->np; ip++) {
+  /* Get pairs of air parcels and nearby stations... */
+  double *buf, r2 = rmax2, dl = dlat, *sl = slat, *sx = sxyz;
+  long *isel = NULL;
+  int cap = GSL_MAX(atm->np, 1), nsel, ns = nstat, nv = 5 + ctl->nq;
+#ifdef _OPENACC
+  int dev = acc_is_present(atm, sizeof(atm_t));
+#endif
+  do {
+    REALLOC(isel, long,
+	    cap);
+    nsel = 0;
+#ifdef _OPENACC
+#pragma acc data create(isel[0:cap]) copyin(sl[0:ns],sx[0:3*ns]) copy(nsel) if(dev)
+#endif
+    {
+#ifdef _OPENACC
+#pragma acc parallel loop independent gang vector present(ctl,atm,isel,sl,sx) if(dev)
+#endif
+      for (int ip = 0; ip < atm->np; ip++) {
 
-    /* Check time... */
-    if (atm->time[ip] < t0 || atm->time[ip] > t1)
-      continue;
+	/* Check time... */
+	if (atm->time[ip] < t0 || atm->time[ip] > t1)
+	  continue;
 
-    /* Check station flag... */
-    if (ctl->qnt_stat >= 0)
-      if (atm->q[ctl->qnt_stat][ip])
-	continue;
+	/* Check station flag... */
+	if (ctl->qnt_stat >= 0)
+	  if (atm->q[ctl->qnt_stat][ip])
+	    continue;
+
+	/* Get Cartesian coordinates... */
+	double x1[3];
+	geo2cart(0, atm->lon[ip], atm->lat[ip], x1);
+
+	/* Find first station of the latitude band... */
+	int lo = 0, hi = ns;
+	while (lo < hi) {
+	  int mid = (lo + hi) / 2;
+	  if (sl[mid] < atm->lat[ip] - dl)
+	    lo = mid + 1;
+	  else
+	    hi = mid;
+	}
 
-    /* Get Cartesian coordinates... */
-    geo2cart(0, atm->lon[ip], atm->lat[ip], x1);
+	/* Loop over stations of the latitude band... */
+	for (int is = lo; is < ns && sl[is] <= atm->lat[ip] + dl; is++) {
 
-    /* Check horizontal distance... */
-    if (DIST2(x0, x1) > rmax2)
-      continue;
+	  /* Check horizontal distance... */
+	  double x0[3] = { sx[3 * is], sx[3 * is + 1], sx[3 * is + 2] };
+	  if (DIST2(x0, x1) > r2)
+	    continue;
 
-    /* Set station flag... */
-    if (ctl->qnt_stat >= 0)
-      atm->q[ctl->qnt_stat][ip] = 1;
+	  /* Save index... */
+	  int isel2;
+#ifdef _OPENACC
+#pragma acc atomic capture
+#endif
+	  isel2 = nsel++;
+	  if (isel2 < cap)
+	    isel[isel2] = (long) ip * ns + is;
 
-    /* Write data... */
+	  /* Set station flag... */
+	  if (ctl->qnt_stat >= 0) {
+	    atm->q[ctl->qnt_stat][ip] = 1;
+	    break;
+	  }
+	}
+      }
+#ifdef _OPENACC
+#pragma acc update host(nsel) if(dev)
+#pragma acc update host(isel[0:GSL_MIN(nsel, cap)]) if(dev)
+#endif
+    }
+
+    /* Repeat with larger buffer if parcels are close to several
+       stations (the station flag permits only one match per parcel)... */
+    if (nsel <= cap)
+      break;
+    cap = nsel;
+  } while (1);
+
+  /* Restore order of air parcels... */
+  gsl_sort_long(isel, 1, (size_t) nsel);
+
+  /* Copy data of selected air parcels... */
+  ALLOC(buf, double,
+	GSL_MAX(nsel * nv, 1));
+#ifdef _OPENACC
+#pragma acc parallel loop independent gang vector present(ctl,atm) copyin(isel[0:nsel]) copyout(buf[0:nsel*nv]) if(dev)
+#endif
+  for (int is = 0; is < nsel; is++) {
+    int ip = (int) (isel[is] / ns);
+    buf[is * nv] = atm->time[ip];
+    buf[is * nv + 1] = Z(atm->p[ip]);
+    buf[is * nv + 2] = atm->lon[ip];
+    buf[is * nv + 3] = atm->lat[ip];
+    for (int iq = 0; iq < ctl->nq; iq++)
+      buf[is * nv + 4 + iq] = atm->q[iq][ip];
+    buf[is * nv + 4 + ctl->nq] = (double) (isel[is] % ns);
+  }
+
+#ifdef MPI
+  /* Gather selected air parcels of all MPI tasks on master... */
+  if (ctl->mpi_decomp) {
+    int *counts = NULL, *displs = NULL, ntot = 0, size, n = nsel * nv;
+    double *buf_all = NULL;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    if (rank == 0) {
+      ALLOC(counts, int,
+	    size);
+      ALLOC(displs, int,
+	    size);
+    }
+    MPI_Gather(&n, 1, MPI_INT, counts, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    if (rank == 0) {
+      for (int i = 0; i < size; i++) {
+	displs[i] = ntot;
+	ntot += counts[i];
+      }
+      ALLOC(buf_all, double,
+	    GSL_MAX(ntot, 1));
+    }
+    MPI_Gatherv(buf, n, MPI_DOUBLE, buf_all, counts, displs, MPI_DOUBLE, 0,
+		MPI_COMM_WORLD);
+    free(buf);
+    free(counts);
+    free(displs);
+    buf = buf_all;
+    nsel = ntot / nv;
+  }
+#endif
+
+  /* Write data... */
+  for (int is = 0; is < nsel; is++) {
     fprintf(out, "%.2f %g %g %g",
-	    atm->time[ip], Z(atm->p[ip]), atm->lon[ip], atm->lat[ip]);
+	    buf[is * nv], buf[is * nv + 1], buf[is * nv + 2],
+	    buf[is * nv + 3]);
     for (int iq = 0; iq < ctl->nq; iq++) {
       fprintf(out, " ");
-      fprintf(out, ctl->qnt_format[iq], atm->q[iq][ip]);
+      fprintf(out, ctl->qnt_format[iq], buf[is * nv + 4 + iq]);
     }
+    if (ctl->stat_file[0] != '-')
+      fprintf(out, " %d", sid[(int) buf[is * nv + 4 + ctl->nq]]);
     fprintf(out, "\n");
   }
 
+  /* Free... */
+  free(isel);
+  free(buf);
+
   /* Close file... */
-  if (t == ctl->t_stop)
-    fclose(out);
+  if (t == ctl->t_stop) {
+    if (out)
+      fclose(out);
+    out = NULL;
+    free(sid);
+    free(slat);
+    free(sxyz);
+    sid = NULL;
+  }
 }
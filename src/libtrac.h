@@ -33,21 +33,41 @@
 */
 
 #include <ctype.h>
+#include <float.h>
 #include <gsl/gsl_math.h>
 #include <gsl/gsl_randist.h>
 #include <gsl/gsl_rng.h>
 #include <gsl/gsl_sort.h>
 #include <gsl/gsl_spline.h>
 #include <gsl/gsl_statistics.h>
+#include <limits.h>
 #include <math.h>
 #include <netcdf.h>
+#include <netcdf_meta.h>
 #include <omp.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/time.h>
 
+#ifdef MPI
+#include "mpi.h"
+#endif
+
+#ifdef _OPENACC
+#include "openacc.h"
+#endif
+
+#ifdef NVTX
+#include "nvToolsExt.h"
+#endif
+
 /* ------------------------------------------------------------
    Constants...
    ------------------------------------------------------------ */
@@ -92,8 +112,27 @@
 /*! Maximum length of ASCII data lines. */
 #define LEN 5000
 
-/*! Maximum number of atmospheric data points. */
-#define NP 10000000
+/*! Version of the meteo cache file format. */
+#define MET_CACHE_VERSION 3
+
+/*! Magic number of binary atmospheric data files (negative to tell
+  them apart from legacy files, which start with the number of parcels).
+
+  Binary files (ATM_TYPE = 1) are written as four ints (magic, version,
+  number of parcels np, number of quantities nq), nq quantity names of
+  ATM_BIN_NAME chars, and the double arrays time, p, lon, lat, and
+  q[0..nq-1] with np values each. Legacy files from earlier versions
+  consist of one int (np) and the same double arrays for the NQ
+  quantities of the control file. They can still be read, but they are
+  no longer written. Older versions of the code cannot read the new
+  files; convert them with atm_conv to ASCII or netCDF if needed. */
+#define ATM_BIN_MAGIC -20190601
+
+/*! Version of the binary atmospheric data format. */
+#define ATM_BIN_VERSION 1
+
+/*! Length of quantity names in binary atmospheric data files. */
+#define ATM_BIN_NAME 64
 
 /*! Maximum number of quantities per data point. */
 #define NQ 12
@@ -101,26 +140,23 @@
 /*! Maximum number of pressure levels for meteorological data. */
 #define EP 112
 
+/*! Number of bins of the lookup table for pressure levels. */
+#define NPLUT 1024
+
+/*! Maximum number of adaptive advection sub-steps. */
+#define NSUB 64
+
 /*! Maximum number of longitudes for meteorological data. */
 #define EX 1201
 
 /*! Maximum number of latitudes for meteorological data. */
 #define EY 601
 
-/*! Maximum number of longitudes for gridded data. */
-#define GX 720
-
-/*! Maximum number of latitudes for gridded data. */
-#define GY 360
-
 /*! Maximum number of altitudes for gridded data. */
 #define GZ 100
 
-/*! Maximum number of data points for ensemble analysis. */
-#define NENS 2000
-
-/*! Maximum number of OpenMP threads. */
-#define NTHREADS 512
+/*! Maximum number of ensemble members summed up by one thread. */
+#define ENS_PIECE 256
 
 /* ------------------------------------------------------------
    Macros...
@@ -131,6 +167,19 @@
   if((ptr=calloc((size_t)(n), sizeof(type)))==NULL)      \
     ERRMSG("Out of memory!");
 
+/*! Reallocate memory. */
+#define REALLOC(ptr, type, n)						\
+  if((ptr=realloc(ptr, (size_t)(n)*sizeof(type)))==NULL)		\
+    ERRMSG("Out of memory!");
+
+/*! Get index of 2-D array. */
+#define ARRAY_2D(ix, iy, ny)			\
+  ((ix) * (ny) + (iy))
+
+/*! Get index of 3-D array. */
+#define ARRAY_3D(ix, iy, ny, iz, nz)		\
+  (((ix) * (ny) + (iy)) * (nz) + (iz))
+
 /*! Convert degrees to zonal distance. */
 #define DEG2DX(dlon, lat)					\
   ((dlon) * M_PI * RE / 180. * cos((lat) / 180. * M_PI))
@@ -193,12 +242,42 @@
 #define LIN(x0, y0, x1, y1, x)			\
   ((y0)+((y1)-(y0))/((x1)-(x0))*((x)-(x0)))
 
+/*! Get wind component ic (0=u, 1=v, 2=w) of meteorological data. */
+#define MET_UVW(met, ix, iy, ip, ic)					\
+  ((met)->uvwh ? (met)->uvwo[ip][ic] + (met)->uvws[ip][ic]		\
+   * (met)->uvwh[3 * ARRAY_3D(ix, iy, (met)->ey, ip, (met)->ep) + (ic)]	\
+   : (met)->uvw[3 * ARRAY_3D(ix, iy, (met)->ey, ip, (met)->ep) + (ic)])
+
+/*! Set chunking and compression of netCDF-4 variable. */
+#if NC_HAS_NC4
+#define NC_DEFLATE(ncid, varid, chunks, level) {			\
+    if ((level) > 0) {							\
+      if ((chunks) != NULL)						\
+	NC(nc_def_var_chunking(ncid, varid, NC_CHUNKED, chunks));	\
+      NC(nc_def_var_deflate(ncid, varid, 1, 1, level));			\
+    }									\
+  }
+#else
+#define NC_DEFLATE(ncid, varid, chunks, level) {			\
+    (void) (chunks);							\
+    if ((level) > 0)							\
+      ERRMSG("netCDF library has no netCDF-4 support!");		\
+  }
+#endif
+
 /*! Execute netCDF library command and check result. */
 #define NC(cmd) {				     \
     if((cmd)!=NC_NOERR)				     \
       ERRMSG(nc_strerror(cmd));			     \
   }
 
+/*! Define netCDF variable with long name and unit attributes. */
+#define NC_DEF_VAR(ncid, name, type, ndims, dims, varid, lname, unit) { \
+    NC(nc_def_var(ncid, name, type, ndims, dims, &varid));		\
+    NC(nc_put_att_text(ncid, varid, "long_name", strlen(lname), lname)); \
+    NC(nc_put_att_text(ncid, varid, "units", strlen(unit), unit));	\
+  }
+
 /*! Compute norm of a vector. */
 #define NORM(a) sqrt(DOTP(a, a))
 
@@ -300,6 +379,67 @@
 /*! Timer for total runtime. */
 #define TIMER_TOTAL 14
 
+/*! Timer for sorting of air parcels. */
+#define TIMER_SORT 15
+
+/*! Timer for fused transport step. */
+#define TIMER_STEP 16
+
+/* ------------------------------------------------------------
+   Performance counters...
+   ------------------------------------------------------------ */
+
+/*! Number of performance counters. */
+#define NCOUNTER 6
+
+/*! Number of timers in performance data. */
+#define NPERF 15
+
+/*! Counter for meteo files read. */
+#define COUNTER_MET_FILES 0
+
+/*! Counter for bytes of meteo files read. */
+#define COUNTER_MET_BYTES 1
+
+/*! Counter for bytes copied from host to device by update directives
+  (without migration of managed memory). */
+#define COUNTER_H2D_BYTES 2
+
+/*! Counter for time of copies from host to device [s]. */
+#define COUNTER_H2D_TIME 3
+
+/*! Counter for bytes copied from device to host by update directives
+  (without migration of managed memory). */
+#define COUNTER_D2H_BYTES 4
+
+/*! Counter for time of copies from device to host [s]. */
+#define COUNTER_D2H_TIME 5
+
+/* ------------------------------------------------------------
+   Checkpoints...
+   ------------------------------------------------------------ */
+
+/*! Version of checkpoint file format. */
+#define CHK_VERSION 1
+
+/*! Number of output writers with state in checkpoints. */
+#define NCHKW 5
+
+/*! Checkpoint state of CSI data. */
+#define CHKW_CSI 0
+
+/*! Checkpoint state of ensemble data. */
+#define CHKW_ENS 1
+
+/*! Checkpoint state of profile data. */
+#define CHKW_PROF 2
+
+/*! Checkpoint state of station data. */
+#define CHKW_STAT 3
+
+/*! Checkpoint state of performance data. */
+#define CHKW_PERF 4
+
 /* ------------------------------------------------------------
    Structs...
    ------------------------------------------------------------ */
@@ -415,6 +555,26 @@ typedef struct {
   /*! Time step of simulation [s]. */
   double dt_mod;
 
+  /*! Fused transport step for all air parcels (0=no, 1=yes). */
+  int fused_step;
+
+  /*! Maximum Courant number of advection sub-steps (0 to disable). */
+  double advect_cfl;
+
+  /*! Time interval for spatial sorting of air parcels [s] (0 to disable). */
+  double sort_dt;
+
+  /*! Cache interpolation indices of air parcels between modules
+    (0=no, 1=yes). */
+  int intpol_cache;
+
+  /*! MPI parallelization (0=runs of directory list, 1=split air parcels). */
+  int mpi_decomp;
+
+  /*! Number of run directories sharing the meteorological data
+    (1 to disable batching). */
+  int batch;
+
   /*! Time step of meteorological data [s]. */
   double dt_met;
 
@@ -436,6 +596,24 @@ typedef struct {
   /*! Smoothing for pressure levels. */
   int met_sp;
 
+  /*! Western boundary of meteo data subset [deg]. */
+  double met_lon0;
+
+  /*! Eastern boundary of meteo data subset [deg]. */
+  double met_lon1;
+
+  /*! Southern boundary of meteo data subset [deg]. */
+  double met_lat0;
+
+  /*! Northern boundary of meteo data subset [deg]. */
+  double met_lat1;
+
+  /*! Lower boundary of meteo data subset [km]. */
+  double met_z0;
+
+  /*! Upper boundary of meteo data subset [km]. */
+  double met_z1;
+
   /*! Number of target pressure levels. */
   int met_np;
 
@@ -455,6 +633,30 @@ typedef struct {
   /*! Command to stage meteo data. */
   char met_stage[LEN];
 
+  /*! Read next meteo file in the background (0=no, 1=yes). */
+  int met_prefetch;
+
+  /*! Directory for preprocessed meteo cache files (- to disable). */
+  char met_cache[LEN];
+
+  /*! Store winds as 16-bit integers scaled per level (0=no, 1=yes). */
+  int met_uvw16;
+
+  /*! Read water vapor data (0=no, 1=yes). */
+  int met_h2o;
+
+  /*! Read ozone data (0=no, 1=yes). */
+  int met_o3;
+
+  /*! Read cloud water and calculate cloud properties (0=no, 1=yes). */
+  int met_cloud;
+
+  /*! Calculate geopotential heights (0=no, 1=yes). */
+  int met_z;
+
+  /*! Calculate potential vorticity (0=no, 1=yes). */
+  int met_pv;
+
   /*! Isosurface parameter
      (0=none, 1=pressure, 2=density, 3=theta, 4=balloon). */
   int isosurf;
@@ -480,6 +682,9 @@ typedef struct {
   /*! Vertical scaling factor for mesoscale wind fluctuations. */
   double turb_mesoz;
 
+  /*! Seed of random number generator for diffusion. */
+  int turb_seed;
+
   /*! Species. */
   char species[LEN];
 
@@ -504,6 +709,9 @@ typedef struct {
   /*! HNO3 volume mixing ratio for PSC analysis. */
   double psc_hno3;
 
+  /*! Number of output jobs queued for the background writer (0=off). */
+  int out_async;
+
   /*! Basename of atmospheric data files. */
   char atm_basename[LEN];
 
@@ -519,9 +727,19 @@ typedef struct {
   /*! Particle index stride for atmospheric data files. */
   int atm_stride;
 
-  /*! Type of atmospheric data files (0=ASCII, 1=binary, 2=netCDF). */
+  /*! Type of atmospheric data files
+    (0=ASCII, 1=binary, 2=CLaMS netCDF, 3=netCDF). */
   int atm_type;
 
+  /*! Deflate level for netCDF output (0=netCDF classic, 1-9=netCDF-4). */
+  int nc_level;
+
+  /*! Chunk size of air parcel dimension in netCDF-4 files (0=default). */
+  int nc_chunk;
+
+  /*! Number of mantissa bits kept in netCDF output (0=lossless). */
+  int nc_quant;
+
   /*! Basename of CSI data files. */
   char csi_basename[LEN];
 
@@ -576,6 +794,9 @@ typedef struct {
   /*! Sparse output in grid data files (0=no, 1=yes). */
   int grid_sparse;
 
+  /*! Type of grid data files (0=ASCII, 1=netCDF). */
+  int grid_type;
+
   /*! Number of altitudes of gridded data. */
   int grid_nz;
 
@@ -642,6 +863,9 @@ typedef struct {
   /*! Basename of station data file. */
   char stat_basename[LEN];
 
+  /*! Station list file (- to use STAT_LON and STAT_LAT). */
+  char stat_file[LEN];
+
   /*! Longitude of station [deg]. */
   double stat_lon;
 
@@ -651,6 +875,18 @@ typedef struct {
   /*! Search radius around station [km]. */
   double stat_r;
 
+  /*! Basename of performance data file. */
+  char perf_basename[LEN];
+
+  /*! Basename of checkpoint file. */
+  char chk_basename[LEN];
+
+  /*! Time step for checkpoints [s]. */
+  double chk_dt_out;
+
+  /*! Resume from checkpoint file (0=no, 1=yes). */
+  int restart;
+
 } ctl_t;
 
 /*! Atmospheric data. */
@@ -659,58 +895,97 @@ typedef struct {
   /*! Number of air pacels. */
   int np;
 
+  /*! Number of allocated air parcels. */
+  int npmax;
+
   /*! Time [s]. */
-  double time[NP];
+  double *time;
 
   /*! Pressure [hPa]. */
-  double p[NP];
+  double *p;
 
   /*! Longitude [deg]. */
-  double lon[NP];
+  double *lon;
 
   /*! Latitude [deg]. */
-  double lat[NP];
+  double *lat;
 
   /*! Quantity data (for various, user-defined attributes). */
-  double q[NQ][NP];
+  double *q[NQ];
+
+  /*! Memory-mapped binary file (NULL if data are allocated). */
+  void *map;
+
+  /*! Size of memory-mapped binary file [byte]. */
+  size_t mapsize;
 
 } atm_t;
 
 /*! Cache data. */
 typedef struct {
 
+  /*! Number of allocated air parcels. */
+  int np;
+
+  /*! Air parcel identifiers. */
+  int *id;
+
+  /*! Number of active air parcels. */
+  int nact;
+
+  /*! Indices of active air parcels. */
+  int *iact;
+
   /*! Zonal wind perturbation [m/s]. */
-  float up[NP];
+  float *up;
 
   /*! Meridional wind perturbation [m/s]. */
-  float vp[NP];
+  float *vp;
 
   /*! Vertical velocity perturbation [hPa/s]. */
-  float wp[NP];
+  float *wp;
 
   /*! Isosurface variables. */
-  double iso_var[NP];
+  double *iso_var;
 
   /*! Isosurface balloon pressure [hPa]. */
-  double iso_ps[NP];
+  double *iso_ps;
 
   /*! Isosurface balloon time [s]. */
-  double iso_ts[NP];
+  double *iso_ts;
 
   /*! Isosurface balloon number of data points. */
   int iso_n;
 
-  /*! Cache for reference time of wind standard deviations. */
-  double tsig[EX][EY][EP];
+  /*! Cached interpolation indices (NULL if disabled). */
+  int *ci;
 
-  /*! Cache for zonal wind standard deviations. */
-  float usig[EX][EY][EP];
+  /*! Cached interpolation weights. */
+  double *cw;
 
-  /*! Cache for meridional wind standard deviations. */
-  float vsig[EX][EY][EP];
+  /*! Positions of cached interpolation indices and weights. */
+  double *cx;
 
-  /*! Cache for vertical velocity standard deviations. */
-  float wsig[EX][EY][EP];
+  /*! Number of longitudes of wind standard deviations. */
+  int ex;
+
+  /*! Number of latitudes of wind standard deviations. */
+  int ey;
+
+  /*! Number of pressure levels of wind standard deviations. */
+  int ep;
+
+  /*! Time of meteo data of wind standard deviations [s]. */
+  double tsig;
+
+  /*! Zonal wind standard deviations (NULL if not required). */
+  float *usig;
+
+  /*! Meridional wind standard deviations. */
+  float *vsig;
+
+  /*! Vertical velocity standard deviations. */
+  float *wsig;
 
 } cache_t;
 
@@ -729,6 +1004,21 @@ typedef struct {
   /*! Number of pressure levels. */
   int np;
 
+  /*! Allocated number of longitudes. */
+  int ex;
+
+  /*! Allocated number of latitudes (array stride). */
+  int ey;
+
+  /*! Allocated number of pressure levels (array stride). */
+  int ep;
+
+  /*! Start indices of longitude, latitude, and level subset in file. */
+  int sub[3];
+
+  /*! Number of longitudes in file (subsets may wrap around the globe). */
+  int nxf;
+
   /*! Longitude [deg]. */
   double lon[EX];
 
@@ -738,53 +1028,72 @@ typedef struct {
   /*! Pressure [hPa]. */
   double p[EP];
 
+  /*! Lookup table of pressure level indices (bins of log-pressure). */
+  int plut[NPLUT];
+
+  /*! Log-pressure of first bin of lookup table. */
+  double plut0;
+
+  /*! Inverse bin width of lookup table. */
+  double plutd;
+
   /*! Surface pressure [hPa]. */
-  float ps[EX][EY];
+  float *ps;
 
   /*! Geopotential height at the surface [km]. */
-  float zs[EX][EY];
+  float *zs;
 
   /*! Tropopause pressure [hPa]. */
-  float pt[EX][EY];
+  float *pt;
 
   /*! Cloud top pressure [hPa]. */
-  float pc[EX][EY];
+  float *pc;
 
   /*! Total column cloud water [kg/m^2]. */
-  float cl[EX][EY];
+  float *cl;
 
   /*! Geopotential height at model levels [km]. */
-  float z[EX][EY][EP];
+  float *z;
 
   /*! Temperature [K]. */
-  float t[EX][EY][EP];
-
-  /*! Zonal wind [m/s]. */
-  float u[EX][EY][EP];
-
-  /*! Meridional wind [m/s]. */
-  float v[EX][EY][EP];
-
-  /*! Vertical wind [hPa/s]. */
-  float w[EX][EY][EP];
+  float *t;
 
   /*! Potential vorticity [PVU]. */
-  float pv[EX][EY][EP];
+  float *pv;
 
   /*! Water vapor volume mixing ratio [1]. */
-  float h2o[EX][EY][EP];
+  float *h2o;
 
   /*! Ozone volume mixing ratio [1]. */
-  float o3[EX][EY][EP];
+  float *o3;
 
   /*! Cloud liquid water content [kg/kg]. */
-  float lwc[EX][EY][EP];
+  float *lwc;
 
   /*! Cloud ice water content [kg/kg]. */
-  float iwc[EX][EY][EP];
+  float *iwc;
 
   /*! Pressure on model levels [hPa]. */
-  float pl[EX][EY][EP];
+  float *pl;
+
+  /*! Zonal wind [m/s], meridional wind [m/s], and vertical wind [hPa/s]
+    (interleaved, 3 values per grid point, NULL if packed). */
+  float *uvw;
+
+  /*! Wind components as 16-bit integers (NULL if not used). */
+  short *uvwh;
+
+  /*! Offsets of 16-bit wind components of each level. */
+  float uvwo[EP][3];
+
+  /*! Scaling factors of 16-bit wind components of each level. */
+  float uvws[EP][3];
+
+  /*! Memory-mapped cache file (NULL if data are allocated). */
+  void *map;
+
+  /*! Size of memory-mapped cache file [byte]. */
+  size_t mapsize;
 
 } met_t;
 
@@ -792,6 +1101,26 @@ typedef struct {
    Functions...
    ------------------------------------------------------------ */
 
+/*! Allocate atmospheric data. */
+void alloc_atm(
+  ctl_t * ctl,
+  atm_t * atm,
+  int np);
+
+/*! Allocate cache data. */
+void alloc_cache(
+  ctl_t * ctl,
+  cache_t * cache,
+  int np,
+  met_t * met);
+
+/*! Allocate meteorological data. */
+void alloc_met(
+  met_t * met,
+  int nx,
+  int ny,
+  int np);
+
 /*! Convert Cartesian coordinates to geolocation. */
 void cart2geo(
   double *x,
@@ -832,6 +1161,11 @@ double clim_tropo(
   double t,
   double lat);
 
+/*! Add to a performance counter and return its total. */
+double counter(
+  int id,
+  double inc);
+
 /*! Get day of year from date. */
 void day2doy(
   int year,
@@ -846,7 +1180,22 @@ void doy2day(
   int *mon,
   int *day);
 
+/*! Free atmospheric data. */
+void free_atm(
+  atm_t * atm);
+
+/*! Free cache data. */
+void free_cache(
+  cache_t * cache);
+
+/*! Free meteorological data. */
+void free_met(
+  met_t * met);
+
 /*! Convert geolocation to Cartesian coordinates. */
+#ifdef _OPENACC
+#pragma acc routine (geo2cart)
+#endif
 void geo2cart(
   double z,
   double lon,
@@ -869,19 +1218,49 @@ void get_met_help(
   double dt_met,
   char *filename);
 
+/*! Start reading the next meteo file in the background. */
+void get_met_prefetch(
+  ctl_t * ctl,
+  char *metbase,
+  double t,
+  int direct);
+
+/*! Take prefetched meteo data if it matches the requested file. */
+int get_met_prefetch_swap(
+  char *filename,
+  met_t ** met);
+
 /*! Replace template strings in filename. */
 void get_met_replace(
   char *orig,
   char *search,
   char *repl);
 
+/*! Read the initial meteo data at the next call of get_met. */
+void get_met_reset(
+  void);
+
+/*! Get interpolation indices and weights (cached per air parcel). */
+#ifdef _OPENACC
+#pragma acc routine (intpol_met_cache)
+#endif
+void intpol_met_cache(
+  cache_t * cache,
+  met_t * met,
+  int ip,
+  double p,
+  double lon,
+  double lat,
+  int *ci,
+  double *cw);
+
 /*! Spatial interpolation of meteorological data. */
 #ifdef _OPENACC
 #pragma acc routine (intpol_met_space_3d)
 #endif
 void intpol_met_space_3d(
   met_t * met,
-  float array[EX][EY][EP],
+  float *array,
   double p,
   double lon,
   double lat,
@@ -896,7 +1275,7 @@ void intpol_met_space_3d(
 #endif
 void intpol_met_space_2d(
   met_t * met,
-  float array[EX][EY],
+  float *array,
   double lon,
   double lat,
   double *var,
@@ -910,9 +1289,9 @@ void intpol_met_space_2d(
 #endif
 void intpol_met_time_3d(
   met_t * met0,
-  float array0[EX][EY][EP],
+  float *array0,
   met_t * met1,
-  float array1[EX][EY][EP],
+  float *array1,
   double ts,
   double p,
   double lon,
@@ -928,9 +1307,9 @@ void intpol_met_time_3d(
 #endif
 void intpol_met_time_2d(
   met_t * met0,
-  float array0[EX][EY],
+  float *array0,
   met_t * met1,
-  float array1[EX][EY],
+  float *array1,
   double ts,
   double lon,
   double lat,
@@ -939,6 +1318,37 @@ void intpol_met_time_2d(
   double *cw,
   int init);
 
+/*! Spatial interpolation of wind vector. */
+#ifdef _OPENACC
+#pragma acc routine (intpol_met_space_uvw)
+#endif
+void intpol_met_space_uvw(
+  met_t * met,
+  double p,
+  double lon,
+  double lat,
+  double *u,
+  double *v,
+  double *w,
+  int *ci,
+  double *cw,
+  int init);
+
+/*! Spatial and temporal interpolation of wind vector. */
+#ifdef _OPENACC
+#pragma acc routine (intpol_met_time_uvw)
+#endif
+void intpol_met_time_uvw(
+  met_t * met0,
+  met_t * met1,
+  double ts,
+  double p,
+  double lon,
+  double lat,
+  double *u,
+  double *v,
+  double *w);
+
 /*! Convert seconds to date. */
 void jsec2time(
   double jsec,
@@ -959,6 +1369,14 @@ int locate_irr(
   int n,
   double x);
 
+/*! Find array index of pressure level (lookup table). */
+#ifdef _OPENACC
+#pragma acc routine (locate_met_p)
+#endif
+int locate_met_p(
+  met_t * met,
+  double p);
+
 /*! Find array index for regular grid. */
 #ifdef _OPENACC
 #pragma acc routine (locate_reg)
@@ -968,12 +1386,275 @@ int locate_reg(
   int n,
   double x);
 
+/*! Get indices of active air parcels. */
+void module_active(
+  atm_t * atm,
+  cache_t * cache,
+  double *dt);
+
+/*! Calculate advection of air parcels. */
+void module_advection(
+  ctl_t * ctl,
+  met_t * met0,
+  met_t * met1,
+  atm_t * atm,
+  cache_t * cache,
+  double *dt);
+
+/*! Calculate advection of single air parcel. */
+#ifdef _OPENACC
+#pragma acc routine (module_advection_parcel)
+#endif
+void module_advection_parcel(
+  ctl_t * ctl,
+  met_t * met0,
+  met_t * met1,
+  atm_t * atm,
+  double *dt,
+  int ip);
+
+/*! Calculate exponential decay of particle mass. */
+void module_decay(
+  ctl_t * ctl,
+  atm_t * atm,
+  cache_t * cache,
+  double *dt);
+
+/*! Calculate exponential decay of particle mass of single air parcel. */
+#ifdef _OPENACC
+#pragma acc routine (module_decay_parcel)
+#endif
+void module_decay_parcel(
+  ctl_t * ctl,
+  atm_t * atm,
+  double *dt,
+  int ip);
+
+/*! Calculate mesoscale diffusion. */
+void module_diffusion_meso(
+  ctl_t * ctl,
+  met_t * met0,
+  met_t * met1,
+  atm_t * atm,
+  cache_t * cache,
+  double *dt);
+
+/*! Calculate mesoscale diffusion of single air parcel. */
+#ifdef _OPENACC
+#pragma acc routine (module_diffusion_meso_parcel)
+#endif
+void module_diffusion_meso_parcel(
+  ctl_t * ctl,
+  met_t * met0,
+  atm_t * atm,
+  cache_t * cache,
+  double *dt,
+  int ip);
+
+/*! Update local wind standard deviations for mesoscale diffusion. */
+void module_diffusion_meso_sig(
+  met_t * met0,
+  met_t * met1,
+  cache_t * cache);
+
+/*! Calculate turbulent diffusion. */
+void module_diffusion_turb(
+  ctl_t * ctl,
+  atm_t * atm,
+  cache_t * cache,
+  double *dt);
+
+/*! Calculate turbulent diffusion of single air parcel. */
+#ifdef _OPENACC
+#pragma acc routine (module_diffusion_turb_parcel)
+#endif
+void module_diffusion_turb_parcel(
+  ctl_t * ctl,
+  atm_t * atm,
+  cache_t * cache,
+  double *dt,
+  int ip);
+
+/*! Initialize isosurface module. */
+void module_isosurf_init(
+  ctl_t * ctl,
+  met_t * met0,
+  met_t * met1,
+  atm_t * atm,
+  cache_t * cache);
+
+/*! Force air parcels to stay on isosurface. */
+void module_isosurf(
+  ctl_t * ctl,
+  met_t * met0,
+  met_t * met1,
+  atm_t * atm,
+  cache_t * cache);
+
+/*! Force single air parcel to stay on isosurface. */
+#ifdef _OPENACC
+#pragma acc routine (module_isosurf_parcel)
+#endif
+void module_isosurf_parcel(
+  ctl_t * ctl,
+  met_t * met0,
+  met_t * met1,
+  atm_t * atm,
+  cache_t * cache,
+  int ip);
+
+/*! Interpolate meteorological data for air parcel positions. */
+void module_meteo(
+  ctl_t * ctl,
+  met_t * met0,
+  met_t * met1,
+  atm_t * atm,
+  cache_t * cache);
+
+/*! Select meteorological fields required by the model run. */
+void module_meteo_fields(
+  ctl_t * ctl);
+
+/*! Check position of air parcels. */
+void module_position(
+  met_t * met0,
+  met_t * met1,
+  atm_t * atm,
+  cache_t * cache,
+  double *dt);
+
+/*! Check position of single air parcel. */
+#ifdef _OPENACC
+#pragma acc routine (module_position_parcel)
+#endif
+void module_position_parcel(
+  met_t * met0,
+  met_t * met1,
+  atm_t * atm,
+  cache_t * cache,
+  double *dt,
+  int ip);
+
+/*! Calculate sedimentation of air parcels. */
+void module_sedi(
+  ctl_t * ctl,
+  met_t * met0,
+  met_t * met1,
+  atm_t * atm,
+  cache_t * cache,
+  double *dt);
+
+/*! Calculate sedimentation of single air parcel. */
+#ifdef _OPENACC
+#pragma acc routine (module_sedi_parcel)
+#endif
+void module_sedi_parcel(
+  ctl_t * ctl,
+  met_t * met0,
+  met_t * met1,
+  atm_t * atm,
+  cache_t * cache,
+  double *dt,
+  int ip);
+
+/*! Sort air parcels along a space-filling curve (keys and reordering
+  run on the device if the data are present, the index sort on the
+  host). */
+void module_sort(
+  ctl_t * ctl,
+  met_t * met0,
+  atm_t * atm,
+  cache_t * cache);
+
+/*! Calculate position, advection, diffusion, sedimentation, and
+  isosurface modules in a single pass over the air parcels. */
+void module_step(
+  ctl_t * ctl,
+  met_t * met0,
+  met_t * met1,
+  atm_t * atm,
+  cache_t * cache,
+  double *dt);
+
+/*! Calculate OH chemistry. */
+void module_oh_chem(
+  ctl_t * ctl,
+  met_t * met0,
+  met_t * met1,
+  atm_t * atm,
+  cache_t * cache,
+  double *dt);
+
+/*! Calculate OH chemistry of single air parcel. */
+#ifdef _OPENACC
+#pragma acc routine (module_oh_chem_parcel)
+#endif
+void module_oh_chem_parcel(
+  ctl_t * ctl,
+  met_t * met0,
+  met_t * met1,
+  atm_t * atm,
+  cache_t * cache,
+  double *dt,
+  int ip);
+
+/*! Calculate wet deposition. */
+void module_wet_deposition(
+  ctl_t * ctl,
+  met_t * met0,
+  met_t * met1,
+  atm_t * atm,
+  cache_t * cache,
+  double *dt);
+
+/*! Calculate wet deposition of single air parcel. */
+#ifdef _OPENACC
+#pragma acc routine (module_wet_deposition_parcel)
+#endif
+void module_wet_deposition_parcel(
+  ctl_t * ctl,
+  met_t * met0,
+  met_t * met1,
+  atm_t * atm,
+  cache_t * cache,
+  double *dt,
+  int ip);
+
+/*! Generate normally distributed random numbers (Philox4x32-10). */
+#ifdef _OPENACC
+#pragma acc routine (random_normal)
+#endif
+void random_normal(
+  unsigned int key0,
+  unsigned int key1,
+  double ctr0,
+  unsigned int ctr1,
+  double *rs);
+
 /*! Read atmospheric data. */
 int read_atm(
   const char *filename,
   ctl_t * ctl,
   atm_t * atm);
 
+/*! Read list of atmospheric data files in sets of nset files, loading
+  the next set in the background. */
+int read_atm_list(
+  ctl_t * ctl,
+  int nfile,
+  char *files[],
+  int nset,
+  int *ifile,
+  atm_t ** atm);
+
+/*! Read checkpoint file (only the time if atm is NULL). */
+int read_chk(
+  const char *filename,
+  ctl_t * ctl,
+  atm_t * atm,
+  cache_t * cache,
+  double *t);
+
 /*! Read control parameters. */
 void read_ctl(
   const char *filename,
@@ -987,6 +1668,18 @@ int read_met(
   char *filename,
   met_t * met);
 
+/*! Read preprocessed meteorological data from cache file. */
+int read_met_cache(
+  ctl_t * ctl,
+  char *filename,
+  met_t * met);
+
+/*! Get name and key of meteo cache file. */
+unsigned long read_met_cache_file(
+  ctl_t * ctl,
+  char *filename,
+  char *cachefile);
+
 /*! Calculate cloud properties. */
 void read_met_cloud(
   met_t * met);
@@ -999,14 +1692,32 @@ void read_met_extrapolate(
 void read_met_geopot(
   met_t * met);
 
-/*! Read and convert 3D variable from meteorological data file. */
+/*! Read grid of meteorological data file and select subset. */
+void read_met_grid(
+  ctl_t * ctl,
+  int ncid,
+  char *levname,
+  met_t * met);
+
+/*! Find index range of grid intervals overlapping a given range. */
+void read_met_grid_range(
+  double *x,
+  int n,
+  double x0,
+  double x1,
+  int *i0,
+  int *i1);
+
+/*! Read and convert 3D variable from meteorological data file
+  (stride is the distance of grid points in dest). */
 int read_met_help_3d(
   int ncid,
   char *varname,
   char *varname2,
   met_t * met,
-  float dest[EX][EY][EP],
-  float scl);
+  float *dest,
+  float scl,
+  int stride);
 
 /*! Read and convert 2D variable from meteorological data file. */
 int read_met_help_2d(
@@ -1014,19 +1725,33 @@ int read_met_help_2d(
   char *varname,
   char *varname2,
   met_t * met,
-  float dest[EX][EY],
+  float *dest,
   float scl);
 
-/*! Convert meteorological data from model levels to pressure levels. */
+/*! Read list of meteo files, loading the next file in the background. */
+int read_met_list(
+  ctl_t * ctl,
+  int nfile,
+  char *files[],
+  int *ifile,
+  met_t ** met);
+
+/*! Convert meteorological data from model levels to pressure levels
+  (stride is the distance of grid points in var). */
 void read_met_ml2pl(
   ctl_t * ctl,
   met_t * met,
-  float var[EX][EY][EP]);
+  float *var,
+  int stride);
 
 /*! Create meteorological data with periodic boundary conditions. */
 void read_met_periodic(
   met_t * met);
 
+/*! Set up lookup table of pressure levels. */
+void read_met_plut(
+  met_t * met);
+
 /*! Calculate potential vorticity. */
 void read_met_pv(
   met_t * met);
@@ -1046,6 +1771,16 @@ void read_met_tropo(
   ctl_t * ctl,
   met_t * met);
 
+/*! Replace float winds by 16-bit integers scaled per level. */
+void read_met_uvw16(
+  met_t * met);
+
+/*! Round mantissas to given number of bits (for lossy compression). */
+void round_bits(
+  double *x,
+  size_t n,
+  int nbits);
+
 /*! Read a control parameter from file or command line. */
 double scan_ctl(
   const char *filename,
@@ -1065,6 +1800,14 @@ void spline(
   double *y2,
   int n2);
 
+/*! Calculate statistics of data (mean, stddev, min, max, skew, kurt,
+  median, absdev, or mad). */
+double stats(
+  const char *param,
+  double *data,
+  int n,
+  double *work);
+
 /*! Calculate standard deviation. */
 #ifdef _OPENACC
 #pragma acc routine (stddev)
@@ -1085,11 +1828,34 @@ void time2jsec(
   double *jsec);
 
 /*! Measure wall-clock time. */
-void timer(
+double timer(
   const char *name,
   int id,
   int mode);
 
+/*! Write atmospheric data (in the background if OUT_ASYNC > 0). */
+void write_async_atm(
+  const char *filename,
+  ctl_t * ctl,
+  atm_t * atm,
+  double t);
+
+/*! Write gridded data (in the background if OUT_ASYNC > 0), free arrays. */
+void write_async_grid(
+  const char *filename,
+  ctl_t * ctl,
+  double t,
+  size_t nc,
+  unsigned long *cidx,
+  int *cnp,
+  double *cmass,
+  double *ccd,
+  double *cvmr);
+
+/*! Wait until the background writer has finished all output. */
+void write_async_wait(
+  void);
+
 /*! Write atmospheric data. */
 void write_atm(
   const char *filename,
@@ -1097,6 +1863,14 @@ void write_atm(
   atm_t * atm,
   double t);
 
+/*! Write checkpoint file (in the background if possible). */
+void write_chk(
+  const char *filename,
+  ctl_t * ctl,
+  atm_t * atm,
+  cache_t * cache,
+  double t);
+
 /*! Write CSI data. */
 void write_csi(
   const char *filename,
@@ -1120,6 +1894,42 @@ void write_grid(
   atm_t * atm,
   double t);
 
+/*! Write gridded data to ASCII file. */
+void write_grid_asc(
+  const char *filename,
+  ctl_t * ctl,
+  double t,
+  size_t nc,
+  unsigned long *cidx,
+  int *cnp,
+  double *cmass,
+  double *ccd,
+  double *cvmr);
+
+/*! Write gridded data to netCDF file. */
+void write_grid_nc(
+  const char *filename,
+  ctl_t * ctl,
+  double t,
+  size_t nc,
+  unsigned long *cidx,
+  int *cnp,
+  double *ccd,
+  double *cvmr);
+
+/*! Write preprocessed meteorological data to cache file. */
+void write_met_cache(
+  ctl_t * ctl,
+  char *filename,
+  met_t * met);
+
+/*! Write performance data of each time step. */
+void write_perf(
+  const char *filename,
+  ctl_t * ctl,
+  cache_t * cache,
+  double t);
+
 /*! Write profile data. */
 void write_prof(
   const char *filename,
@@ -24,6 +24,10 @@
 
 #include "libtrac.h"
 
+#ifdef MPI
+#include "mpi.h"
+#endif
+
 /* ------------------------------------------------------------
    Dimensions...
    ------------------------------------------------------------ */
@@ -48,23 +52,37 @@ int main(
 
   FILE *out;
 
-  static double timem[NX][NY], p0, ps, psm[NX][NY], pt, ptm[NX][NY], t,
-    tm[NX][NY], u, um[NX][NY], v, vm[NX][NY], w, wm[NX][NY], h2o,
-    h2om[NX][NY], h2ot, h2otm[NX][NY], o3, o3m[NX][NY],
-    lwc, lwcm[NX][NY], iwc, iwcm[NX][NY], z, zm[NX][NY], pv,
-    pvm[NX][NY], zt, ztm[NX][NY], tt, ttm[NX][NY],
-    pc, pcm[NX][NY], cl, clm[NX][NY], lon, lon0, lon1, lons[NX],
-    dlon, lat, lat0, lat1, lats[NY], dlat, cw[3];
+  static double timem[NX][NY], p0, psm[NX][NY], ptm[NX][NY], tm[NX][NY],
+    um[NX][NY], vm[NX][NY], wm[NX][NY], h2om[NX][NY], h2otm[NX][NY],
+    o3m[NX][NY], lwcm[NX][NY], iwcm[NX][NY], zm[NX][NY], pvm[NX][NY],
+    ztm[NX][NY], ttm[NX][NY], pcm[NX][NY], clm[NX][NY], lon, lon0, lon1,
+    lons[NX], dlon, lat, lat0, lat1, lats[NY], dlat;
+
+  static int i, ifile, ix, iy, nfile, np[NX][NY], nx, ny;
 
-  static int i, ix, iy, np[NX][NY], nx, ny, ci[3];
+  char **files;
 
-  /* Allocate... */
-  ALLOC(met, met_t, 1);
+#ifdef MPI
+  /* Initialize MPI... */
+  int rank, size;
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+#endif
 
   /* Check arguments... */
   if (argc < 4)
     ERRMSG("Give parameters: <ctl> <map.tab> <met0> [ <met1> ... ]");
 
+  /* Distribute files over MPI tasks... */
+  ALLOC(files, char *,
+	argc);
+  for (i = 3; i < argc; i++)
+#ifdef MPI
+    if ((i - 3) % size == rank)
+#endif
+      files[nfile++] = argv[i];
+
   /* Read control parameters... */
   read_ctl(argv[1], argc, argv, &ctl);
   p0 = P(scan_ctl(argv[1], argc, argv, "MAP_Z0", -1, "10", NULL));
@@ -75,12 +93,8 @@ int main(
   lat1 = scan_ctl(argv[1], argc, argv, "MAP_LAT1", -1, "90", NULL);
   dlat = scan_ctl(argv[1], argc, argv, "MAP_DLAT", -1, "-999", NULL);
 
-  /* Loop over files... */
-  for (i = 3; i < argc; i++) {
-
-    /* Read meteorological data... */
-    if (!read_met(&ctl, argv[i], met))
-      continue;
+  /* Loop over files (next file is read in the background)... */
+  for (ifile = -1; read_met_list(&ctl, nfile, files, &ifile, &met);) {
 
     /* Set horizontal grid... */
     if (dlon <= 0)
@@ -108,20 +122,22 @@ int main(
     }
 
     /* Average... */
+#pragma omp parallel for default(shared) private(iy)
     for (ix = 0; ix < nx; ix++)
       for (iy = 0; iy < ny; iy++) {
 
+	double cl, cw[3], h2o, h2ot, iwc, lwc, o3, pc, ps, pt, pv, t, tt, u,
+	  v, w, z, zt;
+
+	int ci[3];
+
 	/* Interpolate meteo data... */
 	intpol_met_space_3d(met, met->z, p0, lons[ix], lats[iy], &z, ci, cw,
 			    1);
 	intpol_met_space_3d(met, met->t, p0, lons[ix], lats[iy], &t, ci, cw,
 			    0);
-	intpol_met_space_3d(met, met->u, p0, lons[ix], lats[iy], &u, ci, cw,
-			    0);
-	intpol_met_space_3d(met, met->v, p0, lons[ix], lats[iy], &v, ci, cw,
-			    0);
-	intpol_met_space_3d(met, met->w, p0, lons[ix], lats[iy], &w, ci, cw,
-			    0);
+	intpol_met_space_uvw(met, p0, lons[ix], lats[iy], &u, &v, &w, ci, cw,
+			     0);
 	intpol_met_space_3d(met, met->pv, p0, lons[ix], lats[iy], &pv, ci,
 			    cw, 0);
 	intpol_met_space_3d(met, met->h2o, p0, lons[ix], lats[iy], &h2o, ci,
@@ -168,6 +184,24 @@ int main(
       }
   }
 
+#ifdef MPI
+  /* Reduce grids on the first task... */
+  double *sums[18] = { &timem[0][0], &zm[0][0], &tm[0][0], &um[0][0],
+    &vm[0][0], &wm[0][0], &pvm[0][0], &h2om[0][0], &o3m[0][0], &lwcm[0][0],
+    &iwcm[0][0], &psm[0][0], &ptm[0][0], &pcm[0][0], &clm[0][0],
+    &ztm[0][0], &ttm[0][0], &h2otm[0][0]
+  };
+  for (i = 0; i < 18; i++)
+    MPI_Reduce(rank == 0 ? MPI_IN_PLACE : sums[i], sums[i], NX * NY,
+	       MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce(rank == 0 ? MPI_IN_PLACE : &np[0][0], &np[0][0], NX * NY,
+	     MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+  if (rank > 0) {
+    MPI_Finalize();
+    return EXIT_SUCCESS;
+  }
+#endif
+
   /* Create output file... */
   printf("Write meteorological data file: %s\n", argv[2]);
   if (!(out = fopen(argv[2], "w")))
@@ -222,7 +256,12 @@ int main(
   fclose(out);
 
   /* Free... */
-  free(met);
+  free(files);
+
+#ifdef MPI
+  /* Finalize MPI... */
+  MPI_Finalize();
+#endif
 
   return EXIT_SUCCESS;
 }
@@ -24,6 +24,10 @@
 
 #include "libtrac.h"
 
+#ifdef MPI
+#include "mpi.h"
+#endif
+
 /* ------------------------------------------------------------
    Dimensions...
    ------------------------------------------------------------ */
@@ -45,21 +49,36 @@ int main(
 
   FILE *out;
 
-  static double timem[NZ], z, z0, z1, dz, lon, lon0, lon1, dlon, lonm[NZ],
-    lat, lat0, lat1, dlat, latm[NZ], t, tm[NZ], u, um[NZ], v, vm[NZ], w,
-    wm[NZ], h2o, h2om[NZ], h2ot, h2otm[NZ], o3, o3m[NZ], lwc, lwcm[NZ],
-    iwc, iwcm[NZ], ps, psm[NZ], pt, ptm[NZ], pc, pcm[NZ], cl, clm[NZ],
-    tt, ttm[NZ], zm[NZ], zt, ztm[NZ], pv, pvm[NZ], plev[NZ], cw[3];
+  static double timem[NZ], z, z0, z1, dz, lon0, lon1, dlon, lonm[NZ], lat0,
+    lat1, dlat, latm[NZ], tm[NZ], um[NZ], vm[NZ], wm[NZ], h2om[NZ],
+    h2otm[NZ], o3m[NZ], lwcm[NZ], iwcm[NZ], psm[NZ], ptm[NZ], pcm[NZ],
+    clm[NZ], ttm[NZ], zm[NZ], ztm[NZ], pvm[NZ], plev[NZ];
+
+  static int i, ifile, iz, nfile, np[NZ], npt[NZ], nz;
 
-  static int i, iz, np[NZ], npt[NZ], nz, ci[3];
+  char **files;
 
-  /* Allocate... */
-  ALLOC(met, met_t, 1);
+#ifdef MPI
+  /* Initialize MPI... */
+  int rank, size;
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+#endif
 
   /* Check arguments... */
   if (argc < 4)
     ERRMSG("Give parameters: <ctl> <prof.tab> <met0> [ <met1> ... ]");
 
+  /* Distribute files over MPI tasks... */
+  ALLOC(files, char *,
+	argc);
+  for (i = 3; i < argc; i++)
+#ifdef MPI
+    if ((i - 3) % size == rank)
+#endif
+      files[nfile++] = argv[i];
+
   /* Read control parameters... */
   read_ctl(argv[1], argc, argv, &ctl);
   z0 = scan_ctl(argv[1], argc, argv, "PROF_Z0", -1, "-999", NULL);
@@ -72,12 +91,8 @@ int main(
   lat1 = scan_ctl(argv[1], argc, argv, "PROF_LAT1", -1, "0", NULL);
   dlat = scan_ctl(argv[1], argc, argv, "PROF_DLAT", -1, "-999", NULL);
 
-  /* Loop over input files... */
-  for (i = 3; i < argc; i++) {
-
-    /* Read meteorological data... */
-    if (!read_met(&ctl, argv[i], met))
-      continue;
+  /* Loop over input files (next file is read in the background)... */
+  for (ifile = -1; read_met_list(&ctl, nfile, files, &ifile, &met);) {
 
     /* Set vertical grid... */
     if (z0 < 0)
@@ -106,16 +121,22 @@ int main(
       dlat = fabs(met->lat[1] - met->lat[0]);
 
     /* Average... */
+#pragma omp parallel for default(shared)
     for (iz = 0; iz < nz; iz++)
-      for (lon = lon0; lon <= lon1; lon += dlon)
-	for (lat = lat0; lat <= lat1; lat += dlat) {
+      for (double lon = lon0; lon <= lon1; lon += dlon)
+	for (double lat = lat0; lat <= lat1; lat += dlat) {
+
+	  double cl, cw[3], h2o, h2ot, iwc, lwc, o3, pc, ps, pt, pv, t, tt, u,
+	    v, w, zz, zt;
+
+	  int ci[3];
 
 	  /* Interpolate meteo data... */
-	  intpol_met_space_3d(met, met->z, plev[iz], lon, lat, &z, ci, cw, 1);
+	  intpol_met_space_3d(met, met->z, plev[iz], lon, lat, &zz, ci, cw,
+			      1);
 	  intpol_met_space_3d(met, met->t, plev[iz], lon, lat, &t, ci, cw, 0);
-	  intpol_met_space_3d(met, met->u, plev[iz], lon, lat, &u, ci, cw, 0);
-	  intpol_met_space_3d(met, met->v, plev[iz], lon, lat, &v, ci, cw, 0);
-	  intpol_met_space_3d(met, met->w, plev[iz], lon, lat, &w, ci, cw, 0);
+	  intpol_met_space_uvw(met, plev[iz], lon, lat, &u, &v, &w, ci, cw,
+			       0);
 	  intpol_met_space_3d(met, met->pv, plev[iz], lon, lat, &pv, ci, cw,
 			      0);
 	  intpol_met_space_3d(met, met->h2o, plev[iz], lon, lat, &h2o, ci, cw,
@@ -142,7 +163,7 @@ int main(
 	    timem[iz] += met->time;
 	    lonm[iz] += lon;
 	    latm[iz] += lat;
-	    zm[iz] += z;
+	    zm[iz] += zz;
 	    tm[iz] += t;
 	    um[iz] += u;
 	    vm[iz] += v;
@@ -167,6 +188,25 @@ int main(
 	}
   }
 
+#ifdef MPI
+  /* Reduce grids on the first task... */
+  double *sums[20] = {
+    timem, lonm, latm, zm, tm, um, vm, wm, pvm, h2om, o3m, psm, pcm, clm,
+    lwcm, iwcm, ptm, ztm, ttm, h2otm
+  };
+  for (i = 0; i < 20; i++)
+    MPI_Reduce(rank == 0 ? MPI_IN_PLACE : sums[i], sums[i], NZ,
+	       MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce(rank == 0 ? MPI_IN_PLACE : np, np, NZ, MPI_INT, MPI_SUM,
+	     0, MPI_COMM_WORLD);
+  MPI_Reduce(rank == 0 ? MPI_IN_PLACE : npt, npt, NZ, MPI_INT, MPI_SUM,
+	     0, MPI_COMM_WORLD);
+  if (rank > 0) {
+    MPI_Finalize();
+    return EXIT_SUCCESS;
+  }
+#endif
+
   /* Create output file... */
   printf("Write meteorological data file: %s\n", argv[2]);
   if (!(out = fopen(argv[2], "w")))
@@ -215,7 +255,12 @@ int main(
   fclose(out);
 
   /* Free... */
-  free(met);
+  free(files);
+
+#ifdef MPI
+  /* Finalize MPI... */
+  MPI_Finalize();
+#endif
 
   return EXIT_SUCCESS;
 }
@@ -124,12 +124,8 @@ int main(
 		       atm->lon[ip], atm->lat[ip], &z, ci, cw, 1);
     intpol_met_time_3d(met0, met0->t, met1, met1->t, atm->time[ip], pref,
 		       atm->lon[ip], atm->lat[ip], &t, ci, cw, 0);
-    intpol_met_time_3d(met0, met0->u, met1, met1->u, atm->time[ip], pref,
-		       atm->lon[ip], atm->lat[ip], &u, ci, cw, 0);
-    intpol_met_time_3d(met0, met0->v, met1, met1->v, atm->time[ip], pref,
-		       atm->lon[ip], atm->lat[ip], &v, ci, cw, 0);
-    intpol_met_time_3d(met0, met0->w, met1, met1->w, atm->time[ip], pref,
-		       atm->lon[ip], atm->lat[ip], &w, ci, cw, 0);
+    intpol_met_time_uvw(met0, met1, atm->time[ip], pref, atm->lon[ip],
+			atm->lat[ip], &u, &v, &w);
     intpol_met_time_3d(met0, met0->pv, met1, met1->pv, atm->time[ip], pref,
 		       atm->lon[ip], atm->lat[ip], &pv, ci, cw, 0);
     intpol_met_time_3d(met0, met0->h2o, met1, met1->h2o, atm->time[ip], pref,
@@ -169,7 +165,10 @@ int main(
   fclose(out);
 
   /* Free... */
+  free_atm(atm);
   free(atm);
+  free_met(met0);
+  free_met(met1);
   free(met0);
   free(met1);
 
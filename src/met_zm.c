@@ -24,6 +24,10 @@
 
 #include "libtrac.h"
 
+#ifdef MPI
+#include "mpi.h"
+#endif
+
 /* ------------------------------------------------------------
    Dimensions...
    ------------------------------------------------------------ */
@@ -51,19 +55,34 @@ int main(
   static double timem[NZ][NY], psm[NZ][NY], ptm[NZ][NY], pcm[NZ][NY],
     clm[NZ][NY], ttm[NZ][NY], ztm[NZ][NY], tm[NZ][NY], um[NZ][NY], vm[NZ][NY],
     wm[NZ][NY], h2om[NZ][NY], h2otm[NZ][NY], pvm[NZ][NY], o3m[NZ][NY],
-    lwcm[NZ][NY], iwcm[NZ][NY], zm[NZ][NY], z, z0, z1, dz, zt, tt, plev[NZ],
-    ps, pt, pc, cl, t, u, v, w, pv, h2o, h2ot, o3, lwc, iwc, lat, lat0, lat1,
-    dlat, lats[NY], cw[3];
+    lwcm[NZ][NY], iwcm[NZ][NY], zm[NZ][NY], z, z0, z1, dz, plev[NZ], lat,
+    lat0, lat1, dlat, lats[NY];
+
+  static int i, ifile, ix, iy, iz, nfile, np[NZ][NY], npt[NZ][NY], ny, nz;
 
-  static int i, ix, iy, iz, np[NZ][NY], npt[NZ][NY], ny, nz, ci[3];
+  char **files;
 
-  /* Allocate... */
-  ALLOC(met, met_t, 1);
+#ifdef MPI
+  /* Initialize MPI... */
+  int rank, size;
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+#endif
 
   /* Check arguments... */
   if (argc < 4)
     ERRMSG("Give parameters: <ctl> <zm.tab> <met0> [ <met1> ... ]");
 
+  /* Distribute files over MPI tasks... */
+  ALLOC(files, char *,
+	argc);
+  for (i = 3; i < argc; i++)
+#ifdef MPI
+    if ((i - 3) % size == rank)
+#endif
+      files[nfile++] = argv[i];
+
   /* Read control parameters... */
   read_ctl(argv[1], argc, argv, &ctl);
   z0 = scan_ctl(argv[1], argc, argv, "ZM_Z0", -1, "-999", NULL);
@@ -73,12 +92,8 @@ int main(
   lat1 = scan_ctl(argv[1], argc, argv, "ZM_LAT1", -1, "90", NULL);
   dlat = scan_ctl(argv[1], argc, argv, "ZM_DLAT", -1, "-999", NULL);
 
-  /* Loop over files... */
-  for (i = 3; i < argc; i++) {
-
-    /* Read meteorological data... */
-    if (!read_met(&ctl, argv[i], met))
-      continue;
+  /* Loop over files (next file is read in the background)... */
+  for (ifile = -1; read_met_list(&ctl, nfile, files, &ifile, &met);) {
 
     /* Set vertical grid... */
     if (z0 < 0)
@@ -115,21 +130,23 @@ int main(
     }
 
     /* Average... */
-    for (ix = 0; ix < met->nx; ix++)
+#pragma omp parallel for default(shared) private(iy, ix)
+    for (iz = 0; iz < nz; iz++)
       for (iy = 0; iy < ny; iy++)
-	for (iz = 0; iz < nz; iz++) {
+	for (ix = 0; ix < met->nx; ix++) {
+
+	  double cl, cw[3], h2o, h2ot, iwc, lwc, o3, pc, ps, pt, pv, t, tt, u,
+	    v, w, zz, zt;
+
+	  int ci[3];
 
 	  /* Interpolate meteo data... */
 	  intpol_met_space_3d(met, met->z, plev[iz], met->lon[ix],
-			      met->lat[iy], &z, ci, cw, 1);
+			      met->lat[iy], &zz, ci, cw, 1);
 	  intpol_met_space_3d(met, met->t, plev[iz], met->lon[ix],
 			      met->lat[iy], &t, ci, cw, 0);
-	  intpol_met_space_3d(met, met->u, plev[iz], met->lon[ix],
-			      met->lat[iy], &u, ci, cw, 0);
-	  intpol_met_space_3d(met, met->v, plev[iz], met->lon[ix],
-			      met->lat[iy], &v, ci, cw, 0);
-	  intpol_met_space_3d(met, met->w, plev[iz], met->lon[ix],
-			      met->lat[iy], &w, ci, cw, 0);
+	  intpol_met_space_uvw(met, plev[iz], met->lon[ix], met->lat[iy],
+			       &u, &v, &w, ci, cw, 0);
 	  intpol_met_space_3d(met, met->pv, plev[iz], met->lon[ix],
 			      met->lat[iy], &pv, ci, cw, 0);
 	  intpol_met_space_3d(met, met->h2o, plev[iz], met->lon[ix],
@@ -159,7 +176,7 @@ int main(
 
 	  /* Averaging... */
 	  timem[iz][iy] += met->time;
-	  zm[iz][iy] += z;
+	  zm[iz][iy] += zz;
 	  tm[iz][iy] += t;
 	  um[iz][iy] += u;
 	  vm[iz][iy] += v;
@@ -183,6 +200,27 @@ int main(
 	}
   }
 
+#ifdef MPI
+  /* Reduce grids on the first task... */
+  double *sums[18] = {
+    &timem[0][0], &zm[0][0], &tm[0][0], &um[0][0], &vm[0][0], &wm[0][0],
+    &pvm[0][0], &h2om[0][0], &o3m[0][0], &lwcm[0][0], &iwcm[0][0],
+    &psm[0][0], &pcm[0][0], &clm[0][0], &ptm[0][0], &ztm[0][0], &ttm[0][0],
+    &h2otm[0][0]
+  };
+  for (i = 0; i < 18; i++)
+    MPI_Reduce(rank == 0 ? MPI_IN_PLACE : sums[i], sums[i], NZ * NY,
+	       MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce(rank == 0 ? MPI_IN_PLACE : &np[0][0], &np[0][0], NZ * NY,
+	     MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce(rank == 0 ? MPI_IN_PLACE : &npt[0][0], &npt[0][0], NZ * NY,
+	     MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+  if (rank > 0) {
+    MPI_Finalize();
+    return EXIT_SUCCESS;
+  }
+#endif
+
   /* Create output file... */
   printf("Write meteorological data file: %s\n", argv[2]);
   if (!(out = fopen(argv[2], "w")))
@@ -236,7 +274,12 @@ int main(
   fclose(out);
 
   /* Free... */
-  free(met);
+  free(files);
+
+#ifdef MPI
+  /* Finalize MPI... */
+  MPI_Finalize();
+#endif
 
   return EXIT_SUCCESS;
 }
@@ -24,124 +24,93 @@
 
 #include "libtrac.h"
 
-#ifdef MPI
-#include "mpi.h"
-#endif
-
 #ifdef _OPENACC
 #include "openacc.h"
-#include "curand.h"
 #endif
 
 /* ------------------------------------------------------------
-   Global variables...
+   Structs...
    ------------------------------------------------------------ */
 
-#ifdef _OPENACC
-curandGenerator_t rng;
-#else
-static gsl_rng *rng[NTHREADS];
-#endif
+/*! Model run of a batch sharing the meteorological data. */
+typedef struct {
 
-/* ------------------------------------------------------------
-   Functions...
-   ------------------------------------------------------------ */
+  /*! Run directory. */
+  char dirname[LEN];
 
-/*! Calculate advection of air parcels. */
-void module_advection(
-  met_t * met0,
-  met_t * met1,
-  atm_t * atm,
-  double *dt);
+  /*! Control parameters. */
+  ctl_t ctl;
 
-/*! Calculate exponential decay of particle mass. */
-void module_decay(
-  ctl_t * ctl,
-  atm_t * atm,
-  double *dt);
+  /*! Atmospheric data. */
+  atm_t *atm;
 
-/*! Initialize random number generator... */
-void module_diffusion_init(
-  void);
+  /*! Cache data. */
+  cache_t *cache;
 
-/*! Calculate mesoscale diffusion. */
-void module_diffusion_meso(
-  ctl_t * ctl,
-  met_t * met0,
-  met_t * met1,
-  atm_t * atm,
-  cache_t * cache,
-  double *dt,
-  double *rs);
+  /*! Time steps of air parcels [s]. */
+  double *dt;
 
-/*! Generate random numbers. */
-void module_diffusion_rng(
-  double *rs,
-  size_t n);
+  /*! Global index of first air parcel (MPI decomposition). */
+  int ip0;
 
-/*! Calculate turbulent diffusion. */
-void module_diffusion_turb(
-  ctl_t * ctl,
-  atm_t * atm,
-  double *dt,
-  double *rs);
+} member_t;
 
-/*! Initialize isosurface module. */
-void module_isosurf_init(
-  ctl_t * ctl,
-  met_t * met0,
-  met_t * met1,
-  atm_t * atm,
-  cache_t * cache);
+/* ------------------------------------------------------------
+   Functions...
+   ------------------------------------------------------------ */
 
-/*! Force air parcels to stay on isosurface. */
-void module_isosurf(
-  ctl_t * ctl,
-  met_t * met0,
-  met_t * met1,
-  atm_t * atm,
-  cache_t * cache);
+/*! Check whether a model run can join the current batch. */
+int batch_check(
+  member_t * mem,
+  int nmem);
+
+/*! Run a batch of model runs with shared meteorological data. */
+void batch_run(
+  member_t * mem,
+  int nmem,
+  char *metbase,
+  int size);
 
-/*! Interpolate meteorological data for air parcel positions. */
-void module_meteo(
+/*! Get name of checkpoint file of a model run. */
+void get_chk_filename(
+  const char *dirname,
   ctl_t * ctl,
-  met_t * met0,
-  met_t * met1,
-  atm_t * atm);
+  char *filename);
 
-/*! Check position of air parcels. */
-void module_position(
-  met_t * met0,
-  met_t * met1,
-  atm_t * atm,
-  double *dt);
+/*! Get size of atmospheric data and simulated time span of a model run. */
+void get_cost(
+  const char *dirname,
+  int argc,
+  char *argv[],
+  double *size,
+  double *span);
 
-/*! Calculate sedimentation of air parcels. */
-void module_sedi(
+/*! Distribute air parcels among MPI tasks (returns first parcel index). */
+int mpi_split_atm(
   ctl_t * ctl,
-  met_t * met0,
-  met_t * met1,
   atm_t * atm,
-  double *dt);
+  int rank,
+  int size);
 
-/*! Calculate OH chemistry. */
-void module_oh_chem(
+#ifdef MPI
+/*! Gather air parcels of all MPI tasks on master. */
+void mpi_gather_atm(
   ctl_t * ctl,
-  met_t * met0,
-  met_t * met1,
   atm_t * atm,
-  double *dt);
+  atm_t * atm_all);
+#endif
 
-/*! Calculate wet deposition. */
-void module_wet_deposition(
+/*! Write simulation output. */
+void write_output(
+  const char *dirname,
   ctl_t * ctl,
   met_t * met0,
   met_t * met1,
   atm_t * atm,
-  double *dt);
+  double t);
 
-/*! Write simulation output. */
-void write_output(
+/*! Write output files. */
+void write_output_files(
   const char *dirname,
   ctl_t * ctl,
   met_t * met0,
@@ -157,21 +126,18 @@ int main(
   int argc,
   char *argv[]) {
 
-  ctl_t ctl;
-
-  atm_t *atm;
-
-  cache_t *cache;
-
-  met_t *met0, *met1;
+  member_t *mem = NULL, *m;
 
   FILE *dirlist;
 
-  char dirname[LEN], filename[2 * LEN];
+  char (*dirs)[LEN] = NULL, dirname[LEN], filename[2 * LEN];
+
+  double *cost, *span, task[6] = { 0, 0, 0, 0, 0, 0 }, *tasks, t0;
 
-  double *dt, *rs, t;
+  int id, nalloc = 0, ndir = 0, next = -1, nmem = 0, ntask = -1, rank = 0,
+    size = 1;
 
-  int ntask = -1, rank = 0, size = 1;
+  size_t *perm;
 
 #ifdef MPI
   /* Initialize MPI... */
@@ -193,259 +159,182 @@ int main(
   if (argc < 5)
     ERRMSG("Give parameters: <dirlist> <ctl> <atm_in> <metbase>");
 
-  /* Open directory list... */
+  /* Read directory list... */
   if (!(dirlist = fopen(argv[1], "r")))
     ERRMSG("Cannot open directory list!");
+  while (fscanf(dirlist, "%s", dirname) != EOF) {
+    REALLOC(dirs, char[LEN], ndir + 1);
+    strcpy(dirs[ndir++], dirname);
+  }
+  fclose(dirlist);
+
+  /* Hand out expensive runs first (cost hint is the size of <atm_in>
+     times the simulated time span, or the size only if the time span
+     is not known for all runs)... */
+  ALLOC(cost, double,
+	GSL_MAX(ndir, 1));
+  ALLOC(span, double,
+	GSL_MAX(ndir, 1));
+  ALLOC(perm, size_t, GSL_MAX(ndir, 1));
+  int known = 1;
+  for (id = 0; id < ndir; id++)
+    if (size > 1) {
+      get_cost(dirs[id], argc, argv, &cost[id], &span[id]);
+      known = known && span[id] > 0;
+    }
+  for (id = 0; id < ndir; id++)
+    cost[id] = 1e-6 * id - cost[id] * (known ? span[id] : 1);
+  gsl_sort_index(perm, cost, 1, (size_t) ndir);
+
+#ifdef MPI
+  /* Create shared task counter on master... */
+  MPI_Win win;
+  int *tasknext, one = 1;
+  MPI_Win_allocate(rank == 0 ? (MPI_Aint) sizeof(int) : 0, sizeof(int),
+		   MPI_INFO_NULL, MPI_COMM_WORLD, &tasknext, &win);
+  if (rank == 0)
+    *tasknext = 0;
+  MPI_Barrier(MPI_COMM_WORLD);
+  MPI_Win_lock_all(0, win);
+#endif
 
   /* Loop over directories... */
-  while (fscanf(dirlist, "%s", dirname) != EOF) {
+  t0 = omp_get_wtime();
+  for (id = 0; id < ndir; id++) {
+    strcpy(dirname, dirs[perm[id]]);
 
-    /* MPI parallelization... */
-    if ((++ntask) % size != rank)
-      continue;
+    /* Allocate... */
+    if (nmem >= nalloc) {
+      nalloc = 2 * nalloc + 1;
+      REALLOC(mem, member_t, nalloc);
+    }
+    m = &mem[nmem];
+    memset(m, 0, sizeof(member_t));
+    strcpy(m->dirname, dirname);
+
+    /* Read control parameters... */
+    sprintf(filename, "%s/%s", dirname, argv[2]);
+    read_ctl(filename, argc, argv, &m->ctl);
+    module_meteo_fields(&m->ctl);
+
+    /* MPI parallelization (take next task from shared counter)... */
+    if (!m->ctl.mpi_decomp) {
+      if (next < (++ntask)) {
+#ifdef MPI
+	MPI_Fetch_and_op(&one, &next, MPI_INT, 0, 0, MPI_SUM, win);
+	MPI_Win_flush(0, win);
+#else
+	next = ntask;
+#endif
+      }
+      if (next != ntask)
+	continue;
+    }
 
     /* ------------------------------------------------------------
        Initialize model run...
        ------------------------------------------------------------ */
 
     /* Set timers... */
-    START_TIMER(TIMER_ZERO);
-    START_TIMER(TIMER_TOTAL);
+    if (nmem == 0) {
+      START_TIMER(TIMER_ZERO);
+      START_TIMER(TIMER_TOTAL);
+    }
     START_TIMER(TIMER_INIT);
 
     /* Allocate... */
-    ALLOC(atm, atm_t, 1);
-    ALLOC(cache, cache_t, 1);
-    ALLOC(met0, met_t, 1);
-    ALLOC(met1, met_t, 1);
-    ALLOC(dt, double,
-	  NP);
-    ALLOC(rs, double,
-	  3 * NP);
-
-    /* Read control parameters... */
-    sprintf(filename, "%s/%s", dirname, argv[2]);
-    read_ctl(filename, argc, argv, &ctl);
+    ALLOC(m->atm, atm_t, 1);
 
     /* Read atmospheric data... */
     sprintf(filename, "%s/%s", dirname, argv[3]);
-    if (!read_atm(filename, &ctl, atm))
+    if (!read_atm(filename, &m->ctl, m->atm))
       ERRMSG("Cannot open file!");
 
-    /* Copy to GPU... */
-#ifdef _OPENACC
-#pragma acc enter data copyin(ctl)
-#pragma acc enter data create(atm[:1],cache[:1],met0[:1],met1[:1],dt[:NP],rs[:3*NP])
-#pragma acc update device(atm[:1],cache[:1])
-#endif
-
     /* Set start time... */
-    if (ctl.direction == 1) {
-      ctl.t_start = gsl_stats_min(atm->time, 1, (size_t) atm->np);
-      if (ctl.t_stop > 1e99)
-	ctl.t_stop = gsl_stats_max(atm->time, 1, (size_t) atm->np);
+    if (m->ctl.direction == 1) {
+      m->ctl.t_start = gsl_stats_min(m->atm->time, 1, (size_t) m->atm->np);
+      if (m->ctl.t_stop > 1e99)
+	m->ctl.t_stop = gsl_stats_max(m->atm->time, 1, (size_t) m->atm->np);
     } else {
-      ctl.t_start = gsl_stats_max(atm->time, 1, (size_t) atm->np);
-      if (ctl.t_stop > 1e99)
-	ctl.t_stop = gsl_stats_min(atm->time, 1, (size_t) atm->np);
+      m->ctl.t_start = gsl_stats_max(m->atm->time, 1, (size_t) m->atm->np);
+      if (m->ctl.t_stop > 1e99)
+	m->ctl.t_stop = gsl_stats_min(m->atm->time, 1, (size_t) m->atm->np);
     }
 
     /* Check time interval... */
-    if (ctl.direction * (ctl.t_stop - ctl.t_start) <= 0)
+    if (m->ctl.direction * (m->ctl.t_stop - m->ctl.t_start) <= 0)
       ERRMSG("Nothing to do!");
 
     /* Round start time... */
-    if (ctl.direction == 1)
-      ctl.t_start = floor(ctl.t_start / ctl.dt_mod) * ctl.dt_mod;
+    if (m->ctl.direction == 1)
+      m->ctl.t_start = floor(m->ctl.t_start / m->ctl.dt_mod) * m->ctl.dt_mod;
     else
-      ctl.t_start = ceil(ctl.t_start / ctl.dt_mod) * ctl.dt_mod;
+      m->ctl.t_start = ceil(m->ctl.t_start / m->ctl.dt_mod) * m->ctl.dt_mod;
 
-    /* Initialize random number generator... */
-    module_diffusion_init();
+    /* Distribute air parcels among MPI tasks... */
+    if (m->ctl.mpi_decomp)
+      m->ip0 = mpi_split_atm(&m->ctl, m->atm, rank, size);
 
     /* Set timers... */
     STOP_TIMER(TIMER_INIT);
 
-    /* Initialize meteorological data... */
-    START_TIMER(TIMER_INPUT);
-    get_met(&ctl, argv[4], ctl.t_start, &met0, &met1);
-    if (ctl.dt_mod > fabs(met0->lon[1] - met0->lon[0]) * 111132. / 150.)
-      WARN("Violation of CFL criterion! Check DT_MOD!");
-    STOP_TIMER(TIMER_INPUT);
-
-    /* Initialize isosurface... */
-    START_TIMER(TIMER_ISOSURF);
-    if (ctl.isosurf >= 1 && ctl.isosurf <= 4)
-      module_isosurf_init(&ctl, met0, met1, atm, cache);
-    STOP_TIMER(TIMER_ISOSURF);
-
-    /* ------------------------------------------------------------
-       Loop over timesteps...
-       ------------------------------------------------------------ */
-
-    /* Loop over timesteps... */
-    for (t = ctl.t_start; ctl.direction * (t - ctl.t_stop) < ctl.dt_mod;
-	 t += ctl.direction * ctl.dt_mod) {
-
-      /* Adjust length of final time step... */
-      if (ctl.direction * (t - ctl.t_stop) > 0)
-	t = ctl.t_stop;
+    /* Count work of this task... */
+    task[0]++;
+    task[1] += m->atm->np;
+
+    /* Run current batch if the new run cannot join it... */
+    if (nmem > 0 && (nmem >= mem[0].ctl.batch || !batch_check(mem, nmem))) {
+      batch_run(mem, nmem, argv[4], size);
+      memcpy(&mem[0], &mem[nmem], sizeof(member_t));
+      nmem = 0;
+      START_TIMER(TIMER_ZERO);
+      START_TIMER(TIMER_TOTAL);
+    }
+    nmem++;
+  }
 
-      /* Set time steps for air parcels... */
-#ifdef _OPENACC
-#pragma acc parallel loop independent gang vector present(ctl,atm,atm->time,dt)
+  /* Run final batch... */
+  if (nmem > 0)
+    batch_run(mem, nmem, argv[4], size);
+  task[2] = omp_get_wtime() - t0;
+  task[3] = counter(COUNTER_MET_BYTES, 0);
+  task[4] = counter(COUNTER_H2D_BYTES, 0);
+  task[5] = counter(COUNTER_D2H_BYTES, 0);
+
+  /* Collect timing of all tasks... */
+  ALLOC(tasks, double,
+	6 * size);
+#ifdef MPI
+  MPI_Win_unlock_all(win);
+  MPI_Win_free(&win);
+  MPI_Gather(task, 6, MPI_DOUBLE, tasks, 6, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+#else
+  memcpy(tasks, task, sizeof(task));
 #endif
-      for (int ip = 0; ip < atm->np; ip++) {
-	double atmtime = atm->time[ip];
-	double tstart = ctl.t_start;
-	double tstop = ctl.t_stop;
-	int dir = ctl.direction;
-	if ((dir * (atmtime - tstart) >= 0 && dir * (atmtime - tstop) <= 0
-	     && dir * (atmtime - t) < 0))
-	  dt[ip] = t - atmtime;
-	else
-	  dt[ip] = 0;
-      }
-
-      /* Get meteorological data... */
-      START_TIMER(TIMER_INPUT);
-      if (t != ctl.t_start)
-	get_met(&ctl, argv[4], t, &met0, &met1);
-      STOP_TIMER(TIMER_INPUT);
-
-      /* Check initial position... */
-      START_TIMER(TIMER_POSITION);
-      module_position(met0, met1, atm, dt);
-      STOP_TIMER(TIMER_POSITION);
-
-      /* Advection... */
-      START_TIMER(TIMER_ADVECT);
-      module_advection(met0, met1, atm, dt);
-      STOP_TIMER(TIMER_ADVECT);
-
-      /* Turbulent diffusion... */
-      START_TIMER(TIMER_DIFFTURB);
-      if (ctl.turb_dx_trop > 0 || ctl.turb_dz_trop > 0
-	  || ctl.turb_dx_strat > 0 || ctl.turb_dz_strat > 0) {
-	module_diffusion_rng(rs, 3 * (size_t) atm->np);
-	module_diffusion_turb(&ctl, atm, dt, rs);
-      }
-      STOP_TIMER(TIMER_DIFFTURB);
-
-      /* Mesoscale diffusion... */
-      START_TIMER(TIMER_DIFFMESO);
-      if (ctl.turb_mesox > 0 || ctl.turb_mesoz > 0) {
-	module_diffusion_rng(rs, 3 * (size_t) atm->np);
-	module_diffusion_meso(&ctl, met0, met1, atm, cache, dt, rs);
-      }
-      STOP_TIMER(TIMER_DIFFMESO);
-
-      /* Sedimentation... */
-      START_TIMER(TIMER_SEDI);
-      if (ctl.qnt_r >= 0 && ctl.qnt_rho >= 0)
-	module_sedi(&ctl, met0, met1, atm, dt);
-      STOP_TIMER(TIMER_SEDI);
-
-      /* Isosurface... */
-      START_TIMER(TIMER_ISOSURF);
-      if (ctl.isosurf >= 1 && ctl.isosurf <= 4)
-	module_isosurf(&ctl, met0, met1, atm, cache);
-      STOP_TIMER(TIMER_ISOSURF);
-
-      /* Check final position... */
-      START_TIMER(TIMER_POSITION);
-      module_position(met0, met1, atm, dt);
-      STOP_TIMER(TIMER_POSITION);
-
-      /* Interpolate meteorological data... */
-      START_TIMER(TIMER_METEO);
-      if (ctl.met_dt_out > 0
-	  && (ctl.met_dt_out < ctl.dt_mod || fmod(t, ctl.met_dt_out) == 0))
-	module_meteo(&ctl, met0, met1, atm);
-      STOP_TIMER(TIMER_METEO);
 
-      /* Decay of particle mass... */
-      START_TIMER(TIMER_DECAY);
-      if (ctl.tdec_trop > 0 && ctl.tdec_strat > 0)
-	module_decay(&ctl, atm, dt);
-      STOP_TIMER(TIMER_DECAY);
-
-      /* OH chemistry... */
-      START_TIMER(TIMER_OHCHEM);
-      if (ctl.oh_chem[0] > 0 && ctl.oh_chem[2] > 0)
-	module_oh_chem(&ctl, met0, met1, atm, dt);
-      STOP_TIMER(TIMER_OHCHEM);
-
-      /* Wet deposition... */
-      START_TIMER(TIMER_WETDEPO);
-      if (ctl.wet_depo[0] > 0 && ctl.wet_depo[1] > 0
-	  && ctl.wet_depo[2] > 0 && ctl.wet_depo[3] > 0)
-	module_wet_deposition(&ctl, met0, met1, atm, dt);
-      STOP_TIMER(TIMER_WETDEPO);
-
-      /* Write output... */
-      START_TIMER(TIMER_OUTPUT);
-      write_output(dirname, &ctl, met0, met1, atm, t);
-      STOP_TIMER(TIMER_OUTPUT);
+  /* Report timing summary of tasks... */
+  if (rank == 0) {
+    double tmax = 0, tsum = 0;
+    for (int i = 0; i < size; i++) {
+      printf("TASK_SUMMARY = %d %g %g %.3f\n", i, tasks[6 * i],
+	     tasks[6 * i + 1], tasks[6 * i + 2]);
+      printf("TASK_IO = %d %g %g %g\n", i, tasks[6 * i + 3],
+	     tasks[6 * i + 4], tasks[6 * i + 5]);
+      tmax = GSL_MAX(tmax, tasks[6 * i + 2]);
+      tsum += tasks[6 * i + 2];
     }
-
-    /* ------------------------------------------------------------
-       Finalize model run...
-       ------------------------------------------------------------ */
-
-    /* Report problem size... */
-    printf("SIZE_NP = %d\n", atm->np);
-    printf("SIZE_TASKS = %d\n", size);
-    printf("SIZE_THREADS = %d\n", omp_get_max_threads());
-
-    /* Report memory usage... */
-    printf("MEMORY_ATM = %g MByte\n", sizeof(atm_t) / 1024. / 1024.);
-    printf("MEMORY_CACHE = %g MByte\n", sizeof(cache_t) / 1024. / 1024.);
-    printf("MEMORY_METEO = %g MByte\n", 2 * sizeof(met_t) / 1024. / 1024.);
-    printf("MEMORY_DYNAMIC = %g MByte\n", (sizeof(met_t)
-					   + 4 * NP * sizeof(double)
-					   +
-					   EX * EY * EP * sizeof(float)) /
-	   1024. / 1024.);
-    printf("MEMORY_STATIC = %g MByte\n", (EX * EY * sizeof(double)
-					  + EX * EY * EP * sizeof(float)
-					  + 4 * GX * GY * GZ * sizeof(double)
-					  + 2 * GX * GY * GZ * sizeof(int)
-					  + 2 * GX * GY * sizeof(double)
-					  +
-					  GX * GY * sizeof(int)) / 1024. /
-	   1024.);
-
-    /* Report timers... */
-    STOP_TIMER(TIMER_ZERO);
-    PRINT_TIMER(TIMER_INIT);
-    PRINT_TIMER(TIMER_INPUT);
-    PRINT_TIMER(TIMER_OUTPUT);
-    PRINT_TIMER(TIMER_ADVECT);
-    PRINT_TIMER(TIMER_DECAY);
-    PRINT_TIMER(TIMER_DIFFMESO);
-    PRINT_TIMER(TIMER_DIFFTURB);
-    PRINT_TIMER(TIMER_ISOSURF);
-    PRINT_TIMER(TIMER_METEO);
-    PRINT_TIMER(TIMER_POSITION);
-    PRINT_TIMER(TIMER_SEDI);
-    PRINT_TIMER(TIMER_OHCHEM);
-    PRINT_TIMER(TIMER_WETDEPO);
-    STOP_TIMER(TIMER_TOTAL);
-    PRINT_TIMER(TIMER_TOTAL);
-
-    /* Free... */
-    free(atm);
-    free(cache);
-    free(met0);
-    free(met1);
-    free(dt);
-    free(rs);
-#ifdef _OPENACC
-#pragma acc exit data delete(ctl,atm,cache,met0,met1,dt,rs)
-#endif
+    printf("TASK_UTILIZATION = %.1f %%\n",
+	   tmax > 0 ? 100. * tsum / (size * tmax) : 100.);
   }
 
+  /* Free... */
+  free(dirs);
+  free(cost);
+  free(span);
+  free(perm);
+  free(mem);
+  free(tasks);
+
 #ifdef MPI
   /* Finalize MPI... */
   MPI_Finalize();
@@ -456,864 +345,622 @@ int main(
 
 /*****************************************************************************/
 
-void module_advection(
-  met_t * met0,
-  met_t * met1,
-  atm_t * atm,
-  double *dt) {
-
-#ifdef _OPENACC
-#pragma acc data present(met0,met1,atm,dt)
-#pragma acc parallel loop independent gang vector
-#else
-#pragma omp parallel for default(shared)
-#endif
-  for (int ip = 0; ip < atm->np; ip++)
-    if (dt[ip] != 0) {
-
-      int ci[3];
-
-      double dtm, v[3], xm[3], cw[3];
+int batch_check(
+  member_t * mem,
+  int nmem) {
+
+  ctl_t *c0 = &mem[0].ctl, *c = &mem[nmem].ctl;
+
+  /* Check time window... */
+  if (c->direction != c0->direction || c->t_start != c0->t_start
+      || c->t_stop != c0->t_stop || c->dt_mod != c0->dt_mod)
+    return 0;
+
+  /* Check preprocessing of meteorological data... */
+  if (c->dt_met != c0->dt_met || c->met_dx != c0->met_dx
+      || c->met_dy != c0->met_dy || c->met_dp != c0->met_dp
+      || c->met_sx != c0->met_sx || c->met_sy != c0->met_sy
+      || c->met_sp != c0->met_sp || c->met_tropo != c0->met_tropo
+      || c->met_np != c0->met_np || c->met_uvw16 != c0->met_uvw16
+      || c->met_lon0 != c0->met_lon0 || c->met_lon1 != c0->met_lon1
+      || c->met_lat0 != c0->met_lat0 || c->met_lat1 != c0->met_lat1
+      || c->met_z0 != c0->met_z0 || c->met_z1 != c0->met_z1
+      || memcmp(c->met_p, c0->met_p, (size_t) c->met_np * sizeof(double)))
+    return 0;
+
+  /* Check checkpoints... */
+  if (c->restart != c0->restart || c->chk_dt_out != c0->chk_dt_out
+      || (c->chk_basename[0] == '-') != (c0->chk_basename[0] == '-'))
+    return 0;
+
+  /* Check output that keeps its state between calls... */
+  for (int im = 0; im < nmem; im++) {
+    ctl_t *ci = &mem[im].ctl;
+    if ((c->csi_basename[0] != '-' && ci->csi_basename[0] != '-')
+	|| (c->ens_basename[0] != '-' && ci->ens_basename[0] != '-')
+	|| (c->prof_basename[0] != '-' && ci->prof_basename[0] != '-')
+	|| (c->stat_basename[0] != '-' && ci->stat_basename[0] != '-')
+	|| (c->perf_basename[0] != '-' && ci->perf_basename[0] != '-'))
+      return 0;
+  }
 
-      /* Interpolate meteorological data... */
-      intpol_met_time_3d(met0, met0->u, met1, met1->u, atm->time[ip],
-			 atm->p[ip], atm->lon[ip], atm->lat[ip], &v[0], ci,
-			 cw, 1);
-      intpol_met_time_3d(met0, met0->v, met1, met1->v, atm->time[ip],
-			 atm->p[ip], atm->lon[ip], atm->lat[ip], &v[1], ci,
-			 cw, 0);
-      intpol_met_time_3d(met0, met0->w, met1, met1->w, atm->time[ip],
-			 atm->p[ip], atm->lon[ip], atm->lat[ip], &v[2], ci,
-			 cw, 0);
-
-      /* Get position of the mid point... */
-      dtm = atm->time[ip] + 0.5 * dt[ip];
-      xm[0] =
-	atm->lon[ip] + DX2DEG(0.5 * dt[ip] * v[0] / 1000., atm->lat[ip]);
-      xm[1] = atm->lat[ip] + DY2DEG(0.5 * dt[ip] * v[1] / 1000.);
-      xm[2] = atm->p[ip] + 0.5 * dt[ip] * v[2];
-
-      /* Interpolate meteorological data for mid point... */
-      intpol_met_time_3d(met0, met0->u, met1, met1->u, dtm, xm[2], xm[0],
-			 xm[1], &v[0], ci, cw, 1);
-      intpol_met_time_3d(met0, met0->v, met1, met1->v, dtm, xm[2], xm[0],
-			 xm[1], &v[1], ci, cw, 0);
-      intpol_met_time_3d(met0, met0->w, met1, met1->w, dtm, xm[2], xm[0],
-			 xm[1], &v[2], ci, cw, 0);
-
-      /* Save new position... */
-      atm->time[ip] += dt[ip];
-      atm->lon[ip] += DX2DEG(dt[ip] * v[0] / 1000., xm[1]);
-      atm->lat[ip] += DY2DEG(dt[ip] * v[1] / 1000.);
-      atm->p[ip] += dt[ip] * v[2];
-    }
+  return 1;
 }
 
 /*****************************************************************************/
 
-void module_decay(
-  ctl_t * ctl,
-  atm_t * atm,
-  double *dt) {
+void batch_run(
+  member_t * mem,
+  int nmem,
+  char *metbase,
+  int size) {
 
-  /* Check quantity flags... */
-  if (ctl->qnt_m < 0)
-    ERRMSG("Module needs quantity mass!");
+  ctl_t *ctl0 = &mem[0].ctl;
 
-#ifdef _OPENACC
-#pragma acc data present(ctl,atm,dt)
-#pragma acc parallel loop independent gang vector
-#else
-#pragma omp parallel for default(shared)
-#endif
-  for (int ip = 0; ip < atm->np; ip++)
-    if (dt[ip] != 0) {
-
-      double p0, p1, pt, tdec, w;
-
-      /* Get tropopause pressure... */
-      pt = clim_tropo(atm->time[ip], atm->lat[ip]);
+  met_t *met0, *met1;
 
-      /* Get weighting factor... */
-      p1 = pt * 0.866877899;
-      p0 = pt / 0.866877899;
-      if (atm->p[ip] > p0)
-	w = 1;
-      else if (atm->p[ip] < p1)
-	w = 0;
-      else
-	w = LIN(p0, 1.0, p1, 0.0, atm->p[ip]);
+  char chkfile[2 * LEN];
 
-      /* Set lifetime... */
-      tdec = w * ctl->tdec_trop + (1 - w) * ctl->tdec_strat;
+  double t, tbeg = ctl0->t_start;
 
-      /* Calculate exponential decay... */
-      atm->q[ctl->qnt_m][ip] *= exp(-dt[ip] / tdec);
-    }
-}
+  int im, restart = 0;
 
-/*****************************************************************************/
+  /* Set timers... */
+  START_TIMER(TIMER_INIT);
 
-void module_diffusion_init(
-  void) {
+  /* Read meteorological fields required by any of the runs... */
+  for (im = 1; im < nmem; im++) {
+    ctl0->met_h2o |= mem[im].ctl.met_h2o;
+    ctl0->met_o3 |= mem[im].ctl.met_o3;
+    ctl0->met_cloud |= mem[im].ctl.met_cloud;
+    ctl0->met_z |= mem[im].ctl.met_z;
+    ctl0->met_pv |= mem[im].ctl.met_pv;
+  }
+  if (nmem > 1)
+    printf("Run batch of %d directories: %s ... %s\n", nmem,
+	   mem[0].dirname, mem[nmem - 1].dirname);
+
+  /* Allocate... */
+  ALLOC(met0, met_t, 1);
+  ALLOC(met1, met_t, 1);
+  for (im = 0; im < nmem; im++) {
+    ALLOC(mem[im].cache, cache_t, 1);
+    ALLOC(mem[im].dt, double,
+	  mem[im].atm->np);
+  }
 
-  /* Initialize random number generator... */
+  /* Copy to GPU... */
 #ifdef _OPENACC
-
-  if (curandCreateGenerator(&rng, CURAND_RNG_PSEUDO_DEFAULT)
-      != CURAND_STATUS_SUCCESS)
-    ERRMSG("Cannot create random number generator!");
-  if (curandSetStream(rng, (cudaStream_t) acc_get_cuda_stream(acc_async_sync))
-      != CURAND_STATUS_SUCCESS)
-    ERRMSG("Cannot set stream for random number generator!");
-
-#else
-
-  gsl_rng_env_setup();
-  if (omp_get_max_threads() > NTHREADS)
-    ERRMSG("Too many threads!");
-  for (int i = 0; i < NTHREADS; i++) {
-    rng[i] = gsl_rng_alloc(gsl_rng_default);
-    gsl_rng_set(rng[i], gsl_rng_default_seed + (long unsigned) i);
+#pragma acc enter data create(met0[:1],met1[:1])
+  for (im = 0; im < nmem; im++) {
+    ctl_t *ctl = &mem[im].ctl;
+    atm_t *atm = mem[im].atm;
+    cache_t *cache = mem[im].cache;
+    double *dt = mem[im].dt;
+#pragma acc enter data copyin(ctl[:1])
+#pragma acc enter data create(atm[:1],cache[:1],dt[:atm->np])
+#pragma acc update device(atm[:1],cache[:1])
   }
-
 #endif
-}
 
-/*****************************************************************************/
+  /* Get time of checkpoint... */
+  if (ctl0->restart) {
+    if (ctl0->chk_basename[0] == '-')
+      ERRMSG("Set CHK_BASENAME to restart from checkpoint!");
+    get_chk_filename(mem[0].dirname, ctl0, chkfile);
+    restart = read_chk(chkfile, ctl0, NULL, NULL, &tbeg);
+    if (!restart)
+      WARN("No checkpoint found, starting from the beginning!");
+  }
 
-void module_diffusion_meso(
-  ctl_t * ctl,
-  met_t * met0,
-  met_t * met1,
-  atm_t * atm,
-  cache_t * cache,
-  double *dt,
-  double *rs) {
+  /* Check whether time steps are left (checkpoint at end of run)... */
+  double tfirst =
+    restart ? tbeg + ctl0->direction * ctl0->dt_mod : ctl0->t_start;
+  int steps = ctl0->direction * (tfirst - ctl0->t_stop) < ctl0->dt_mod;
+  if (!steps)
+    printf("Checkpoint at end of run, nothing to do!\n");
+
+  /* Set timers... */
+  STOP_TIMER(TIMER_INIT);
+
+  /* Initialize meteorological data (new batch, new meteo stream)... */
+  START_TIMER(TIMER_INPUT);
+  get_met_reset();
+  if (steps) {
+    get_met(ctl0, metbase, tbeg, &met0, &met1);
+    if (ctl0->advect_cfl <= 0
+	&& ctl0->dt_mod > fabs(met0->lon[1] - met0->lon[0]) * 111132. / 150.)
+      WARN("Violation of CFL criterion! Check DT_MOD!");
+  }
+  STOP_TIMER(TIMER_INPUT);
+
+  /* Initialize air parcels (only if time steps are left)... */
+  for (im = 0; steps && im < nmem; im++) {
+    ctl_t *ctl = &mem[im].ctl;
+    atm_t *atm = mem[im].atm;
+    cache_t *cache = mem[im].cache;
 
+    /* Allocate cache... */
+    alloc_cache(ctl, cache, atm->np, met0);
+    for (int ip = 0; ip < atm->np; ip++)
+      cache->id[ip] = mem[im].ip0 + ip;
+
+    /* Restore air parcels, cache, and isosurface from checkpoint... */
+    if (restart) {
+      double tchk;
+      get_chk_filename(mem[im].dirname, ctl, chkfile);
+      if (!read_chk(chkfile, ctl, atm, cache, &tchk) || tchk != tbeg)
+	ERRMSG("Checkpoints of the batch do not match!");
 #ifdef _OPENACC
-#pragma acc data present(ctl,met0,met1,atm,cache,dt,rs)
-#pragma acc parallel loop independent gang vector
-#else
-#pragma omp parallel for default(shared)
+#pragma acc update device(atm[:1])
 #endif
-  for (int ip = 0; ip < atm->np; ip++)
-    if (dt[ip] != 0) {
-
-      double u[16], v[16], w[16];
-
-      /* Get indices... */
-      int ix = locate_reg(met0->lon, met0->nx, atm->lon[ip]);
-      int iy = locate_reg(met0->lat, met0->ny, atm->lat[ip]);
-      int iz = locate_irr(met0->p, met0->np, atm->p[ip]);
-
-      /* Caching of wind standard deviations... */
-      if (cache->tsig[ix][iy][iz] != met0->time) {
-
-	/* Collect local wind data... */
-	u[0] = met0->u[ix][iy][iz];
-	u[1] = met0->u[ix + 1][iy][iz];
-	u[2] = met0->u[ix][iy + 1][iz];
-	u[3] = met0->u[ix + 1][iy + 1][iz];
-	u[4] = met0->u[ix][iy][iz + 1];
-	u[5] = met0->u[ix + 1][iy][iz + 1];
-	u[6] = met0->u[ix][iy + 1][iz + 1];
-	u[7] = met0->u[ix + 1][iy + 1][iz + 1];
-
-	v[0] = met0->v[ix][iy][iz];
-	v[1] = met0->v[ix + 1][iy][iz];
-	v[2] = met0->v[ix][iy + 1][iz];
-	v[3] = met0->v[ix + 1][iy + 1][iz];
-	v[4] = met0->v[ix][iy][iz + 1];
-	v[5] = met0->v[ix + 1][iy][iz + 1];
-	v[6] = met0->v[ix][iy + 1][iz + 1];
-	v[7] = met0->v[ix + 1][iy + 1][iz + 1];
-
-	w[0] = met0->w[ix][iy][iz];
-	w[1] = met0->w[ix + 1][iy][iz];
-	w[2] = met0->w[ix][iy + 1][iz];
-	w[3] = met0->w[ix + 1][iy + 1][iz];
-	w[4] = met0->w[ix][iy][iz + 1];
-	w[5] = met0->w[ix + 1][iy][iz + 1];
-	w[6] = met0->w[ix][iy + 1][iz + 1];
-	w[7] = met0->w[ix + 1][iy + 1][iz + 1];
-
-	/* Collect local wind data... */
-	u[8] = met1->u[ix][iy][iz];
-	u[9] = met1->u[ix + 1][iy][iz];
-	u[10] = met1->u[ix][iy + 1][iz];
-	u[11] = met1->u[ix + 1][iy + 1][iz];
-	u[12] = met1->u[ix][iy][iz + 1];
-	u[13] = met1->u[ix + 1][iy][iz + 1];
-	u[14] = met1->u[ix][iy + 1][iz + 1];
-	u[15] = met1->u[ix + 1][iy + 1][iz + 1];
-
-	v[8] = met1->v[ix][iy][iz];
-	v[9] = met1->v[ix + 1][iy][iz];
-	v[10] = met1->v[ix][iy + 1][iz];
-	v[11] = met1->v[ix + 1][iy + 1][iz];
-	v[12] = met1->v[ix][iy][iz + 1];
-	v[13] = met1->v[ix + 1][iy][iz + 1];
-	v[14] = met1->v[ix][iy + 1][iz + 1];
-	v[15] = met1->v[ix + 1][iy + 1][iz + 1];
-
-	w[8] = met1->w[ix][iy][iz];
-	w[9] = met1->w[ix + 1][iy][iz];
-	w[10] = met1->w[ix][iy + 1][iz];
-	w[11] = met1->w[ix + 1][iy + 1][iz];
-	w[12] = met1->w[ix][iy][iz + 1];
-	w[13] = met1->w[ix + 1][iy][iz + 1];
-	w[14] = met1->w[ix][iy + 1][iz + 1];
-	w[15] = met1->w[ix + 1][iy + 1][iz + 1];
-
-	/* Get standard deviations of local wind data... */
-	cache->usig[ix][iy][iz] = (float) stddev(u, 16);
-	cache->vsig[ix][iy][iz] = (float) stddev(v, 16);
-	cache->wsig[ix][iy][iz] = (float) stddev(w, 16);
-	cache->tsig[ix][iy][iz] = met0->time;
-      }
-
-      /* Set temporal correlations for mesoscale fluctuations... */
-      double r = 1 - 2 * fabs(dt[ip]) / ctl->dt_met;
-      double r2 = sqrt(1 - r * r);
-
-      /* Calculate horizontal mesoscale wind fluctuations... */
-      if (ctl->turb_mesox > 0) {
-	cache->up[ip] = (float)
-	  (r * cache->up[ip]
-	   + r2 * rs[3 * ip] * ctl->turb_mesox * cache->usig[ix][iy][iz]);
-	atm->lon[ip] += DX2DEG(cache->up[ip] * dt[ip] / 1000., atm->lat[ip]);
-
-	cache->vp[ip] = (float)
-	  (r * cache->vp[ip]
-	   + r2 * rs[3 * ip + 1] * ctl->turb_mesox * cache->vsig[ix][iy][iz]);
-	atm->lat[ip] += DY2DEG(cache->vp[ip] * dt[ip] / 1000.);
-      }
-
-      /* Calculate vertical mesoscale wind fluctuations... */
-      if (ctl->turb_mesoz > 0) {
-	cache->wp[ip] = (float)
-	  (r * cache->wp[ip]
-	   + r2 * rs[3 * ip + 2] * ctl->turb_mesoz * cache->wsig[ix][iy][iz]);
-	atm->p[ip] += cache->wp[ip] * dt[ip];
-      }
     }
-}
-
-/*****************************************************************************/
-
-void module_diffusion_rng(
-  double *rs,
-  size_t n) {
-
 #ifdef _OPENACC
+#pragma acc update device(cache[:1])
+#endif
 
-#pragma acc host_data use_device(rs)
-  {
-    if (curandGenerateNormalDouble(rng, rs, n, 0.0, 1.0)
-	!= CURAND_STATUS_SUCCESS)
-      ERRMSG("Cannot create random numbers!");
+    /* Initialize isosurface... */
+    START_TIMER(TIMER_ISOSURF);
+    if (ctl->isosurf >= 1 && ctl->isosurf <= 4 && !restart)
+      module_isosurf_init(ctl, met0, met1, atm, cache);
+    STOP_TIMER(TIMER_ISOSURF);
   }
 
-#else
+  /* ------------------------------------------------------------
+     Loop over timesteps...
+     ------------------------------------------------------------ */
 
-#pragma omp parallel for default(shared)
-  for (size_t i = 0; i < n; ++i)
-    rs[i] = gsl_ran_gaussian_ziggurat(rng[omp_get_thread_num()], 1.0);
+  /* Loop over timesteps (after the checkpoint time)... */
+  for (t = tfirst; ctl0->direction * (t - ctl0->t_stop) < ctl0->dt_mod;
+       t += ctl0->direction * ctl0->dt_mod) {
 
-#endif
+    /* Adjust length of final time step... */
+    if (ctl0->direction * (t - ctl0->t_stop) > 0)
+      t = ctl0->t_stop;
 
-}
+    for (im = 0; im < nmem; im++) {
+      ctl_t *ctl = &mem[im].ctl;
+      atm_t *atm = mem[im].atm;
+      cache_t *cache = mem[im].cache;
+      double *dt = mem[im].dt;
 
-/*****************************************************************************/
-
-void module_diffusion_turb(
-  ctl_t * ctl,
-  atm_t * atm,
-  double *dt,
-  double *rs) {
+      /* Sort air parcels... */
+      START_TIMER(TIMER_SORT);
+      if (ctl->sort_dt > 0 && fmod(t, ctl->sort_dt) == 0)
+	module_sort(ctl, met0, atm, cache);
+      STOP_TIMER(TIMER_SORT);
 
+      /* Set time steps for air parcels... */
 #ifdef _OPENACC
-#pragma acc data present(ctl,atm,dt,rs)
-#pragma acc parallel loop independent gang vector
-#else
-#pragma omp parallel for default(shared)
+#pragma acc parallel loop independent gang vector present(ctl,atm,atm->time,dt)
 #endif
-  for (int ip = 0; ip < atm->np; ip++)
-    if (dt[ip] != 0) {
-
-      double w;
-
-      /* Get tropopause pressure... */
-      double pt = clim_tropo(atm->time[ip], atm->lat[ip]);
-
-      /* Get weighting factor... */
-      double p1 = pt * 0.866877899;
-      double p0 = pt / 0.866877899;
-      if (atm->p[ip] > p0)
-	w = 1;
-      else if (atm->p[ip] < p1)
-	w = 0;
-      else
-	w = LIN(p0, 1.0, p1, 0.0, atm->p[ip]);
-
-      /* Set diffusivity... */
-      double dx = w * ctl->turb_dx_trop + (1 - w) * ctl->turb_dx_strat;
-      double dz = w * ctl->turb_dz_trop + (1 - w) * ctl->turb_dz_strat;
-
-      /* Horizontal turbulent diffusion... */
-      if (dx > 0) {
-	double sigma = sqrt(2.0 * dx * fabs(dt[ip]));
-	atm->lon[ip] += DX2DEG(rs[3 * ip] * sigma / 1000., atm->lat[ip]);
-	atm->lat[ip] += DY2DEG(rs[3 * ip + 1] * sigma / 1000.);
+      for (int ip = 0; ip < atm->np; ip++) {
+	double atmtime = atm->time[ip];
+	double tstart = ctl->t_start;
+	double tstop = ctl->t_stop;
+	int dir = ctl->direction;
+	if ((dir * (atmtime - tstart) >= 0 && dir * (atmtime - tstop) <= 0
+	     && dir * (atmtime - t) < 0))
+	  dt[ip] = t - atmtime;
+	else
+	  dt[ip] = 0;
       }
 
-      /* Vertical turbulent diffusion... */
-      if (dz > 0) {
-	double sigma = sqrt(2.0 * dz * fabs(dt[ip]));
-	atm->p[ip]
-	  += DZ2DP(rs[3 * ip + 2] * sigma / 1000., atm->p[ip]);
-      }
+      /* Get active air parcels... */
+      module_active(atm, cache, dt);
     }
-}
 
-/*****************************************************************************/
-
-void module_isosurf_init(
-  ctl_t * ctl,
-  met_t * met0,
-  met_t * met1,
-  atm_t * atm,
-  cache_t * cache) {
-
-  FILE *in;
-
-  char line[LEN];
-
-  double t, cw[3];
-
-  int ci[3];
+    /* Get meteorological data... */
+    START_TIMER(TIMER_INPUT);
+    if (t != tbeg)
+      get_met(ctl0, metbase, t, &met0, &met1);
+    STOP_TIMER(TIMER_INPUT);
 
-  /* Save pressure... */
-  if (ctl->isosurf == 1)
-    for (int ip = 0; ip < atm->np; ip++)
-      cache->iso_var[ip] = atm->p[ip];
-
-  /* Save density... */
-  else if (ctl->isosurf == 2)
-    for (int ip = 0; ip < atm->np; ip++) {
-      intpol_met_time_3d(met0, met0->t, met1, met1->t, atm->time[ip],
-			 atm->p[ip], atm->lon[ip], atm->lat[ip], &t, ci, cw,
-			 1);
-      cache->iso_var[ip] = atm->p[ip] / t;
-    }
+    for (im = 0; im < nmem; im++) {
+      ctl_t *ctl = &mem[im].ctl;
+      atm_t *atm = mem[im].atm;
+      cache_t *cache = mem[im].cache;
+      double *dt = mem[im].dt;
+      /* Fused transport step... */
+      if (ctl->fused_step) {
+	START_TIMER(TIMER_STEP);
+	module_step(ctl, met0, met1, atm, cache, dt);
+	STOP_TIMER(TIMER_STEP);
+      }
 
-  /* Save potential temperature... */
-  else if (ctl->isosurf == 3)
-    for (int ip = 0; ip < atm->np; ip++) {
-      intpol_met_time_3d(met0, met0->t, met1, met1->t, atm->time[ip],
-			 atm->p[ip], atm->lon[ip], atm->lat[ip], &t, ci, cw,
-			 1);
-      cache->iso_var[ip] = THETA(atm->p[ip], t);
-    }
+      /* Separate transport modules... */
+      else {
 
-  /* Read balloon pressure data... */
-  else if (ctl->isosurf == 4) {
+	/* Check initial position... */
+	START_TIMER(TIMER_POSITION);
+	module_position(met0, met1, atm, cache, dt);
+	STOP_TIMER(TIMER_POSITION);
+
+	/* Advection... */
+	START_TIMER(TIMER_ADVECT);
+	module_advection(ctl, met0, met1, atm, cache, dt);
+	STOP_TIMER(TIMER_ADVECT);
+
+	/* Turbulent diffusion... */
+	START_TIMER(TIMER_DIFFTURB);
+	if (ctl->turb_dx_trop > 0 || ctl->turb_dz_trop > 0
+	    || ctl->turb_dx_strat > 0 || ctl->turb_dz_strat > 0) {
+	  module_diffusion_turb(ctl, atm, cache, dt);
+	}
+	STOP_TIMER(TIMER_DIFFTURB);
 
-    /* Write info... */
-    printf("Read balloon pressure data: %s\n", ctl->balloon);
+	/* Mesoscale diffusion... */
+	START_TIMER(TIMER_DIFFMESO);
+	if (ctl->turb_mesox > 0 || ctl->turb_mesoz > 0) {
+	  module_diffusion_meso(ctl, met0, met1, atm, cache, dt);
+	}
+	STOP_TIMER(TIMER_DIFFMESO);
+
+	/* Sedimentation... */
+	START_TIMER(TIMER_SEDI);
+	if (ctl->qnt_r >= 0 && ctl->qnt_rho >= 0)
+	  module_sedi(ctl, met0, met1, atm, cache, dt);
+	STOP_TIMER(TIMER_SEDI);
+
+	/* Isosurface... */
+	START_TIMER(TIMER_ISOSURF);
+	if (ctl->isosurf >= 1 && ctl->isosurf <= 4)
+	  module_isosurf(ctl, met0, met1, atm, cache);
+	STOP_TIMER(TIMER_ISOSURF);
+
+	/* Check final position... */
+	START_TIMER(TIMER_POSITION);
+	module_position(met0, met1, atm, cache, dt);
+	STOP_TIMER(TIMER_POSITION);
+      }
 
-    /* Open file... */
-    if (!(in = fopen(ctl->balloon, "r")))
-      ERRMSG("Cannot open file!");
+      /* Interpolate meteorological data... */
+      START_TIMER(TIMER_METEO);
+      if (ctl->met_dt_out > 0
+	  && (ctl->met_dt_out < ctl->dt_mod || fmod(t, ctl->met_dt_out) == 0))
+	module_meteo(ctl, met0, met1, atm, cache);
+      STOP_TIMER(TIMER_METEO);
 
-    /* Read pressure time series... */
-    while (fgets(line, LEN, in))
-      if (sscanf(line, "%lg %lg", &(cache->iso_ts[cache->iso_n]),
-		 &(cache->iso_ps[cache->iso_n])) == 2)
-	if ((++cache->iso_n) > NP)
-	  ERRMSG("Too many data points!");
+      /* Decay of particle mass... */
+      START_TIMER(TIMER_DECAY);
+      if (ctl->tdec_trop > 0 && ctl->tdec_strat > 0)
+	module_decay(ctl, atm, cache, dt);
+      STOP_TIMER(TIMER_DECAY);
 
-    /* Check number of points... */
-    if (cache->iso_n < 1)
-      ERRMSG("Could not read any data!");
+      /* OH chemistry... */
+      START_TIMER(TIMER_OHCHEM);
+      if (ctl->oh_chem[0] > 0 && ctl->oh_chem[2] > 0)
+	module_oh_chem(ctl, met0, met1, atm, cache, dt);
+      STOP_TIMER(TIMER_OHCHEM);
 
-    /* Close file... */
-    fclose(in);
-  }
-}
+      /* Wet deposition... */
+      START_TIMER(TIMER_WETDEPO);
+      if (ctl->wet_depo[0] > 0 && ctl->wet_depo[1] > 0
+	  && ctl->wet_depo[2] > 0 && ctl->wet_depo[3] > 0)
+	module_wet_deposition(ctl, met0, met1, atm, cache, dt);
+      STOP_TIMER(TIMER_WETDEPO);
 
-/*****************************************************************************/
+      /* Write output... */
+      START_TIMER(TIMER_OUTPUT);
+      write_output(mem[im].dirname, ctl, met0, met1, atm, t);
+      STOP_TIMER(TIMER_OUTPUT);
 
-void module_isosurf(
-  ctl_t * ctl,
-  met_t * met0,
-  met_t * met1,
-  atm_t * atm,
-  cache_t * cache) {
+      /* Write performance data... */
+      if (ctl->perf_basename[0] != '-') {
+	char filename[2 * LEN];
+	sprintf(filename, "%s/%s", mem[im].dirname, ctl->perf_basename);
+#ifdef MPI
+	if (ctl->mpi_decomp) {
+	  int rank;
+	  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	  sprintf(filename + strlen(filename), "_%d", rank);
+	}
+#endif
+	write_perf(filename, ctl, cache, t);
+      }
 
+      /* Write checkpoint... */
+      if (ctl->chk_basename[0] != '-' && fmod(t, ctl->chk_dt_out) == 0) {
 #ifdef _OPENACC
-#pragma acc data present(ctl,met0,met1,atm,cache)
-#pragma acc parallel loop independent gang vector
-#else
-#pragma omp parallel for default(shared)
+#pragma acc update host(atm[:1],cache[:1])
 #endif
-  for (int ip = 0; ip < atm->np; ip++) {
-
-    double t, cw[3];
-
-    int ci[3];
-
-    /* Restore pressure... */
-    if (ctl->isosurf == 1)
-      atm->p[ip] = cache->iso_var[ip];
-
-    /* Restore density... */
-    else if (ctl->isosurf == 2) {
-      intpol_met_time_3d(met0, met0->t, met1, met1->t, atm->time[ip],
-			 atm->p[ip], atm->lon[ip], atm->lat[ip], &t, ci, cw,
-			 1);
-      atm->p[ip] = cache->iso_var[ip] * t;
-    }
-
-    /* Restore potential temperature... */
-    else if (ctl->isosurf == 3) {
-      intpol_met_time_3d(met0, met0->t, met1, met1->t, atm->time[ip],
-			 atm->p[ip], atm->lon[ip], atm->lat[ip], &t, ci, cw,
-			 1);
-      atm->p[ip] = 1000. * pow(cache->iso_var[ip] / t, -1. / 0.286);
-    }
-
-    /* Interpolate pressure... */
-    else if (ctl->isosurf == 4) {
-      if (atm->time[ip] <= cache->iso_ts[0])
-	atm->p[ip] = cache->iso_ps[0];
-      else if (atm->time[ip] >= cache->iso_ts[cache->iso_n - 1])
-	atm->p[ip] = cache->iso_ps[cache->iso_n - 1];
-      else {
-	int idx = locate_irr(cache->iso_ts, cache->iso_n, atm->time[ip]);
-	atm->p[ip] = LIN(cache->iso_ts[idx], cache->iso_ps[idx],
-			 cache->iso_ts[idx + 1], cache->iso_ps[idx + 1],
-			 atm->time[ip]);
+	get_chk_filename(mem[im].dirname, ctl, chkfile);
+	write_chk(chkfile, ctl, atm, cache, t);
       }
     }
   }
-}
-
-/*****************************************************************************/
-
-void module_meteo(
-  ctl_t * ctl,
-  met_t * met0,
-  met_t * met1,
-  atm_t * atm) {
-
-  /* Check quantity flags... */
-  if (ctl->qnt_tsts >= 0)
-    if (ctl->qnt_tice < 0 || ctl->qnt_tnat < 0)
-      ERRMSG("Need T_ice and T_NAT to calculate T_STS!");
 
+  /* ------------------------------------------------------------
+     Finalize model runs...
+     ------------------------------------------------------------ */
+
+  /* Wait for background output... */
+  START_TIMER(TIMER_OUTPUT);
+  write_async_wait();
+  STOP_TIMER(TIMER_OUTPUT);
+
+  /* Report problem size... */
+  int np = 0;
+  double mem_atm = 0, mem_cache = 0, mem_met = 0;
+  for (im = 0; im < nmem; im++) {
+    atm_t *atm = mem[im].atm;
+    cache_t *cache = mem[im].cache;
+    np += atm->np;
+    mem_atm += (4. + ctl0->nq) * atm->npmax * sizeof(double);
+    mem_cache += cache->np * (2. * sizeof(int) + 3. * sizeof(float)
+			      + sizeof(double))
+      + 2. * cache->iso_n * sizeof(double);
+    if (cache->ci)
+      mem_cache += 3. * cache->np * (sizeof(int) + 2. * sizeof(double));
+    mem_cache += 3. * cache->ex * cache->ey * cache->ep * sizeof(float);
+  }
+  met_t *met[2] = { met0, met1 };
+  for (int i = 0; i < 2; i++)
+    mem_met += 1. * met[i]->ex * met[i]->ey
+      * (5. * sizeof(float) + met[i]->ep
+	 * (8. * sizeof(float) + (met[i]->uvw ? 3. * sizeof(float) : 0)
+	    + (met[i]->uvwh ? 3. * sizeof(short) : 0)));
+  printf("SIZE_NP = %d\n", np);
+  printf("SIZE_BATCH = %d\n", nmem);
+  printf("SIZE_TASKS = %d\n", size);
+  printf("SIZE_THREADS = %d\n", omp_get_max_threads());
+
+  /* Report memory usage... */
+  printf("MEMORY_ATM = %g MByte\n", mem_atm / 1024. / 1024.);
+  printf("MEMORY_CACHE = %g MByte\n", mem_cache / 1024. / 1024.);
+  printf("MEMORY_METEO = %g MByte\n", mem_met / 1024. / 1024.);
+  printf("MEMORY_DYNAMIC = %g MByte\n",
+	 (mem_atm + mem_cache + mem_met) / 1024. / 1024.);
+
+  /* Report timers... */
+  STOP_TIMER(TIMER_ZERO);
+  PRINT_TIMER(TIMER_INIT);
+  PRINT_TIMER(TIMER_INPUT);
+  PRINT_TIMER(TIMER_OUTPUT);
+  PRINT_TIMER(TIMER_ADVECT);
+  PRINT_TIMER(TIMER_DECAY);
+  PRINT_TIMER(TIMER_DIFFMESO);
+  PRINT_TIMER(TIMER_DIFFTURB);
+  PRINT_TIMER(TIMER_ISOSURF);
+  PRINT_TIMER(TIMER_METEO);
+  PRINT_TIMER(TIMER_POSITION);
+  PRINT_TIMER(TIMER_SEDI);
+  PRINT_TIMER(TIMER_SORT);
+  PRINT_TIMER(TIMER_STEP);
+  PRINT_TIMER(TIMER_OHCHEM);
+  PRINT_TIMER(TIMER_WETDEPO);
+  STOP_TIMER(TIMER_TOTAL);
+  PRINT_TIMER(TIMER_TOTAL);
+
+  /* Discard pending prefetch of meteo data... */
+  get_met_prefetch_swap(NULL, NULL);
+
+  /* Free... */
+  for (im = 0; im < nmem; im++) {
 #ifdef _OPENACC
-#pragma acc data present(ctl,met0,met1,atm)
-#pragma acc parallel loop independent gang vector
-#else
-#pragma omp parallel for default(shared)
+    ctl_t *ctl = &mem[im].ctl;
+    atm_t *atm = mem[im].atm;
+    cache_t *cache = mem[im].cache;
+    double *dt = mem[im].dt;
+#pragma acc exit data delete(ctl,atm,cache,dt)
 #endif
-  for (int ip = 0; ip < atm->np; ip++) {
-
-    double ps, pt, pc, pv, t, u, v, w, h2o, o3, lwc, iwc, z, cw[3];
-
-    int ci[3];
-
-    /* Interpolate meteorological data... */
-    intpol_met_time_3d(met0, met0->z, met1, met1->z, atm->time[ip],
-		       atm->p[ip], atm->lon[ip], atm->lat[ip], &z, ci, cw, 1);
-    intpol_met_time_3d(met0, met0->t, met1, met1->t, atm->time[ip],
-		       atm->p[ip], atm->lon[ip], atm->lat[ip], &t, ci, cw, 0);
-    intpol_met_time_3d(met0, met0->u, met1, met1->u, atm->time[ip],
-		       atm->p[ip], atm->lon[ip], atm->lat[ip], &u, ci, cw, 0);
-    intpol_met_time_3d(met0, met0->v, met1, met1->v, atm->time[ip],
-		       atm->p[ip], atm->lon[ip], atm->lat[ip], &v, ci, cw, 0);
-    intpol_met_time_3d(met0, met0->w, met1, met1->w, atm->time[ip],
-		       atm->p[ip], atm->lon[ip], atm->lat[ip], &w, ci, cw, 0);
-    intpol_met_time_3d(met0, met0->pv, met1, met1->pv, atm->time[ip],
-		       atm->p[ip], atm->lon[ip], atm->lat[ip], &pv, ci, cw,
-		       0);
-    intpol_met_time_3d(met0, met0->h2o, met1, met1->h2o, atm->time[ip],
-		       atm->p[ip], atm->lon[ip], atm->lat[ip], &h2o, ci, cw,
-		       0);
-    intpol_met_time_3d(met0, met0->o3, met1, met1->o3, atm->time[ip],
-		       atm->p[ip], atm->lon[ip], atm->lat[ip], &o3, ci, cw,
-		       0);
-    intpol_met_time_3d(met0, met0->lwc, met1, met1->lwc, atm->time[ip],
-		       atm->p[ip], atm->lon[ip], atm->lat[ip], &lwc, ci, cw,
-		       0);
-    intpol_met_time_3d(met0, met0->iwc, met1, met1->iwc, atm->time[ip],
-		       atm->p[ip], atm->lon[ip], atm->lat[ip], &iwc, ci, cw,
-		       0);
-    intpol_met_time_2d(met0, met0->ps, met1, met1->ps, atm->time[ip],
-		       atm->lon[ip], atm->lat[ip], &ps, ci, cw, 0);
-    intpol_met_time_2d(met0, met0->pt, met1, met1->pt, atm->time[ip],
-		       atm->lon[ip], atm->lat[ip], &pt, ci, cw, 0);
-    intpol_met_time_2d(met0, met0->pc, met1, met1->pc, atm->time[ip],
-		       atm->lon[ip], atm->lat[ip], &pc, ci, cw, 0);
-
-    /* Set surface pressure... */
-    if (ctl->qnt_ps >= 0)
-      atm->q[ctl->qnt_ps][ip] = ps;
-
-    /* Set tropopause pressure... */
-    if (ctl->qnt_pt >= 0)
-      atm->q[ctl->qnt_pt][ip] = pt;
-
-    /* Set pressure... */
-    if (ctl->qnt_p >= 0)
-      atm->q[ctl->qnt_p][ip] = atm->p[ip];
-
-    /* Set geopotential height... */
-    if (ctl->qnt_z >= 0)
-      atm->q[ctl->qnt_z][ip] = z;
-
-    /* Set temperature... */
-    if (ctl->qnt_t >= 0)
-      atm->q[ctl->qnt_t][ip] = t;
-
-    /* Set zonal wind... */
-    if (ctl->qnt_u >= 0)
-      atm->q[ctl->qnt_u][ip] = u;
-
-    /* Set meridional wind... */
-    if (ctl->qnt_v >= 0)
-      atm->q[ctl->qnt_v][ip] = v;
-
-    /* Set vertical velocity... */
-    if (ctl->qnt_w >= 0)
-      atm->q[ctl->qnt_w][ip] = w;
-
-    /* Set water vapor vmr... */
-    if (ctl->qnt_h2o >= 0)
-      atm->q[ctl->qnt_h2o][ip] = h2o;
-
-    /* Set ozone vmr... */
-    if (ctl->qnt_o3 >= 0)
-      atm->q[ctl->qnt_o3][ip] = o3;
-
-    /* Set cloud liquid water content... */
-    if (ctl->qnt_lwc >= 0)
-      atm->q[ctl->qnt_lwc][ip] = lwc;
-
-    /* Set cloud ice water content... */
-    if (ctl->qnt_iwc >= 0)
-      atm->q[ctl->qnt_iwc][ip] = iwc;
-
-    /* Set cloud top pressure... */
-    if (ctl->qnt_pc >= 0)
-      atm->q[ctl->qnt_pc][ip] = pc;
-
-    /* Set nitric acid vmr... */
-    if (ctl->qnt_hno3 >= 0)
-      atm->q[ctl->qnt_hno3][ip] =
-	clim_hno3(atm->time[ip], atm->lat[ip], atm->p[ip]);
-
-    /* Set hydroxyl number concentration... */
-    if (ctl->qnt_oh >= 0)
-      atm->q[ctl->qnt_oh][ip] =
-	clim_oh(atm->time[ip], atm->lat[ip], atm->p[ip]);
-
-    /* Calculate horizontal wind... */
-    if (ctl->qnt_vh >= 0)
-      atm->q[ctl->qnt_vh][ip] = sqrt(u * u + v * v);
-
-    /* Calculate vertical velocity... */
-    if (ctl->qnt_vz >= 0)
-      atm->q[ctl->qnt_vz][ip] = -1e3 * H0 / atm->p[ip] * w;
-
-    /* Calculate relative humidty... */
-    if (ctl->qnt_rh >= 0)
-      atm->q[ctl->qnt_rh][ip] = RH(atm->p[ip], t, h2o);
-
-    /* Calculate potential temperature... */
-    if (ctl->qnt_theta >= 0)
-      atm->q[ctl->qnt_theta][ip] = THETA(atm->p[ip], t);
-
-    /* Set potential vorticity... */
-    if (ctl->qnt_pv >= 0)
-      atm->q[ctl->qnt_pv][ip] = pv;
-
-    /* Calculate T_ice (Marti and Mauersberger, 1993)... */
-    if (ctl->qnt_tice >= 0)
-      atm->q[ctl->qnt_tice][ip] =
-	-2663.5 /
-	(log10((ctl->psc_h2o > 0 ? ctl->psc_h2o : h2o) * atm->p[ip] * 100.) -
-	 12.537);
-
-    /* Calculate T_NAT (Hanson and Mauersberger, 1988)... */
-    if (ctl->qnt_tnat >= 0) {
-      double p_hno3;
-      if (ctl->psc_hno3 > 0)
-	p_hno3 = ctl->psc_hno3 * atm->p[ip] / 1.333224;
-      else
-	p_hno3 = clim_hno3(atm->time[ip], atm->lat[ip], atm->p[ip])
-	  * 1e-9 * atm->p[ip] / 1.333224;
-      double p_h2o =
-	(ctl->psc_h2o > 0 ? ctl->psc_h2o : h2o) * atm->p[ip] / 1.333224;
-      double a = 0.009179 - 0.00088 * log10(p_h2o);
-      double b = (38.9855 - log10(p_hno3) - 2.7836 * log10(p_h2o)) / a;
-      double c = -11397.0 / a;
-      double x1 = (-b + sqrt(b * b - 4. * c)) / 2.;
-      double x2 = (-b - sqrt(b * b - 4. * c)) / 2.;
-      if (x1 > 0)
-	atm->q[ctl->qnt_tnat][ip] = x1;
-      if (x2 > 0)
-	atm->q[ctl->qnt_tnat][ip] = x2;
-    }
-
-    /* Calculate T_STS (mean of T_ice and T_NAT)... */
-    if (ctl->qnt_tsts >= 0)
-      atm->q[ctl->qnt_tsts][ip] = 0.5 * (atm->q[ctl->qnt_tice][ip]
-					 + atm->q[ctl->qnt_tnat][ip]);
+    free_atm(mem[im].atm);
+    free_cache(mem[im].cache);
+    free(mem[im].atm);
+    free(mem[im].cache);
+    free(mem[im].dt);
   }
-}
-
-/*****************************************************************************/
-
-void module_position(
-  met_t * met0,
-  met_t * met1,
-  atm_t * atm,
-  double *dt) {
-
+  free_met(met0);
+  free_met(met1);
+  free(met0);
+  free(met1);
 #ifdef _OPENACC
-#pragma acc data present(met0,met1,atm,dt)
-#pragma acc parallel loop independent gang vector
-#else
-#pragma omp parallel for default(shared)
+#pragma acc exit data delete(met0,met1)
 #endif
-  for (int ip = 0; ip < atm->np; ip++)
-    if (dt[ip] != 0) {
-
-      double ps, cw[3];
-
-      int ci[3];
-
-      /* Calculate modulo... */
-      atm->lon[ip] = FMOD(atm->lon[ip], 360.);
-      atm->lat[ip] = FMOD(atm->lat[ip], 360.);
-
-      /* Check latitude... */
-      while (atm->lat[ip] < -90 || atm->lat[ip] > 90) {
-	if (atm->lat[ip] > 90) {
-	  atm->lat[ip] = 180 - atm->lat[ip];
-	  atm->lon[ip] += 180;
-	}
-	if (atm->lat[ip] < -90) {
-	  atm->lat[ip] = -180 - atm->lat[ip];
-	  atm->lon[ip] += 180;
-	}
-      }
-
-      /* Check longitude... */
-      while (atm->lon[ip] < -180)
-	atm->lon[ip] += 360;
-      while (atm->lon[ip] >= 180)
-	atm->lon[ip] -= 360;
-
-      /* Check pressure... */
-      if (atm->p[ip] < met0->p[met0->np - 1])
-	atm->p[ip] = met0->p[met0->np - 1];
-      else if (atm->p[ip] > 300.) {
-	intpol_met_time_2d(met0, met0->ps, met1, met1->ps, atm->time[ip],
-			   atm->lon[ip], atm->lat[ip], &ps, ci, cw, 1);
-	if (atm->p[ip] > ps)
-	  atm->p[ip] = ps;
-      }
-    }
 }
 
 /*****************************************************************************/
 
-void module_sedi(
+void get_chk_filename(
+  const char *dirname,
   ctl_t * ctl,
-  met_t * met0,
-  met_t * met1,
-  atm_t * atm,
-  double *dt) {
+  char *filename) {
 
-#ifdef _OPENACC
-#pragma acc data present(ctl,met0,met1,atm,dt)
-#pragma acc parallel loop independent gang vector
-#else
-#pragma omp parallel for default(shared)
+  /* Set filename (one file per task with MPI decomposition)... */
+  sprintf(filename, "%s/%s", dirname, ctl->chk_basename);
+#ifdef MPI
+  if (ctl->mpi_decomp) {
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    sprintf(filename + strlen(filename), "_%d", rank);
+  }
 #endif
-  for (int ip = 0; ip < atm->np; ip++)
-    if (dt[ip] != 0) {
-
-      double G, K, eta, lambda, p, r_p, rho, rho_p, T, v, v_p, cw[3];
+}
 
-      int ci[3];
+/*****************************************************************************/
 
-      /* Convert units... */
-      p = 100. * atm->p[ip];
-      r_p = 1e-6 * atm->q[ctl->qnt_r][ip];
-      rho_p = atm->q[ctl->qnt_rho][ip];
+void get_cost(
+  const char *dirname,
+  int argc,
+  char *argv[],
+  double *size,
+  double *span) {
 
-      /* Get temperature... */
-      intpol_met_time_3d(met0, met0->t, met1, met1->t, atm->time[ip],
-			 atm->p[ip], atm->lon[ip], atm->lat[ip], &T, ci, cw,
-			 1);
+  FILE *in;
 
-      /* Density of dry air... */
-      rho = p / (RA * T);
+  char dummy[LEN], filename[2 * LEN], line[LEN], rvarname[LEN], rval[LEN];
 
-      /* Dynamic viscosity of air... */
-      eta = 1.8325e-5 * (416.16 / (T + 120.)) * pow(T / 296.16, 1.5);
+  double t0 = GSL_NAN, t1 = GSL_NAN;
 
-      /* Thermal velocity of an air molecule... */
-      v = sqrt(8. * KB * T / (M_PI * 4.8096e-26));
+  int found[2] = { 0, 0 }, hdr[4], type = 0;
 
-      /* Mean free path of an air molecule... */
-      lambda = 2. * eta / (rho * v);
+  struct stat st;
 
-      /* Knudsen number for air... */
-      K = lambda / r_p;
+  /* Get size of atmospheric data file... */
+  *size = *span = 0;
+  sprintf(filename, "%s/%s", dirname, argv[3]);
+  if (stat(filename, &st) != 0)
+    return;
+  *size = (double) st.st_size;
 
-      /* Cunningham slip-flow correction... */
-      G = 1. + K * (1.249 + 0.42 * exp(-0.87 / K));
+  /* Get stop time and file type (command line overrides control file,
+     no log output as with scan_ctl)... */
+  for (int i = 1; i < argc - 1; i++)
+    if (strcasecmp(argv[i], "T_STOP") == 0 && !found[0]++)
+      t1 = atof(argv[i + 1]);
+    else if (strcasecmp(argv[i], "ATM_TYPE") == 0 && !found[1]++)
+      type = atoi(argv[i + 1]);
+  sprintf(filename, "%s/%s", dirname, argv[2]);
+  if ((in = fopen(filename, "r"))) {
+    while (fgets(line, LEN, in))
+      if (sscanf(line, "%s %s %s", rvarname, dummy, rval) == 3) {
+	if (strcasecmp(rvarname, "T_STOP") == 0 && !found[0]++)
+	  t1 = atof(rval);
+	else if (strcasecmp(rvarname, "ATM_TYPE") == 0 && !found[1]++)
+	  type = atoi(rval);
+      }
+    fclose(in);
+  }
+  if (!found[0])
+    return;
 
-      /* Sedimentation (fall) velocity... */
-      v_p = 2. * SQR(r_p) * (rho_p - rho) * G0 / (9. * eta) * G;
+  /* Get time of first air parcel (ASCII and binary data only)... */
+  sprintf(filename, "%s/%s", dirname, argv[3]);
+  if (type == 0 && (in = fopen(filename, "r"))) {
+    while (fgets(line, LEN, in))
+      if (sscanf(line, "%lg", &t0) == 1)
+	break;
+    fclose(in);
+  } else if (type == 1 && (in = fopen(filename, "r"))) {
+    if (fread(hdr, sizeof(int), 1, in) == 1 && hdr[0] < 0)
+      if (fread(hdr + 1, sizeof(int), 3, in) != 3
+	  || fseek(in, (long) hdr[3] * ATM_BIN_NAME, SEEK_CUR) != 0)
+	hdr[0] = 0;
+    if (hdr[0] != 0 && fread(&t0, sizeof(double), 1, in) != 1)
+      t0 = GSL_NAN;
+    fclose(in);
+  }
 
-      /* Calculate pressure change... */
-      atm->p[ip] += DZ2DP(v_p * dt[ip] / 1000., atm->p[ip]);
-    }
+  /* Get time span... */
+  if (gsl_finite(t0) && gsl_finite(t1))
+    *span = fabs(t1 - t0);
 }
 
 /*****************************************************************************/
 
-void module_oh_chem(
+int mpi_split_atm(
   ctl_t * ctl,
-  met_t * met0,
-  met_t * met1,
   atm_t * atm,
-  double *dt) {
-
-  /* Check quantity flags... */
-  if (ctl->qnt_m < 0)
-    ERRMSG("Module needs quantity mass!");
-
-#ifdef _OPENACC
-#pragma acc data present(ctl,atm,dt)
-#pragma acc parallel loop independent gang vector
-#else
-#pragma omp parallel for default(shared)
-#endif
-  for (int ip = 0; ip < atm->np; ip++)
-    if (dt[ip] != 0) {
+  int rank,
+  int size) {
+
+  atm_t loc;
+
+  /* Get range of air parcels... */
+  int ip0 = (int) ((long) atm->np * rank / size);
+  int ip1 = (int) ((long) atm->np * (rank + 1) / size);
+  size_t n = (size_t) (ip1 - ip0) * sizeof(double);
+
+  /* Copy local air parcels... */
+  memset(&loc, 0, sizeof(atm_t));
+  alloc_atm(ctl, &loc, GSL_MAX(ip1 - ip0, 1));
+  memcpy(loc.time, atm->time + ip0, n);
+  memcpy(loc.p, atm->p + ip0, n);
+  memcpy(loc.lon, atm->lon + ip0, n);
+  memcpy(loc.lat, atm->lat + ip0, n);
+  for (int iq = 0; iq < ctl->nq; iq++)
+    memcpy(loc.q[iq], atm->q[iq] + ip0, n);
+  loc.np = ip1 - ip0;
+
+  /* Release data of all air parcels... */
+  free_atm(atm);
+  memcpy(atm, &loc, sizeof(atm_t));
+
+  return ip0;
+}
 
-      double c, k, k0, ki, M, T, cw[3];
+/*****************************************************************************/
 
-      int ci[3];
+#ifdef MPI
+void mpi_gather_atm(
+  ctl_t * ctl,
+  atm_t * atm,
+  atm_t * atm_all) {
 
-      /* Get temperature... */
-      intpol_met_time_3d(met0, met0->t, met1, met1->t, atm->time[ip],
-			 atm->p[ip], atm->lon[ip], atm->lat[ip], &T, ci, cw,
-			 1);
+  int *counts, *displs, ntot = 0, rank, size;
 
-      /* Calculate molecular density... */
-      M = 7.243e21 * (atm->p[ip] / P0) / T;
+  /* Get number of air parcels of each task... */
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+  ALLOC(counts, int,
+	size);
+  ALLOC(displs, int,
+	size);
+  MPI_Allgather(&atm->np, 1, MPI_INT, counts, 1, MPI_INT, MPI_COMM_WORLD);
+  for (int i = 0; i < size; i++) {
+    displs[i] = ntot;
+    ntot += counts[i];
+  }
 
-      /* Calculate rate coefficient for X + OH + M -> XOH + M
-         (JPL Publication 15-10) ... */
-      k0 = ctl->oh_chem[0] *
-	(ctl->oh_chem[1] > 0 ? pow(T / 300., -ctl->oh_chem[1]) : 1.);
-      ki = ctl->oh_chem[2] *
-	(ctl->oh_chem[3] > 0 ? pow(T / 300., -ctl->oh_chem[3]) : 1.);
-      c = log10(k0 * M / ki);
-      k = k0 * M / (1. + k0 * M / ki) * pow(0.6, 1. / (1. + c * c));
+  /* Allocate... */
+  if (rank == 0) {
+    alloc_atm(ctl, atm_all, ntot);
+    atm_all->np = ntot;
+  }
 
-      /* Calculate exponential decay... */
-      atm->q[ctl->qnt_m][ip] *=
-	exp(-dt[ip] * k * clim_oh(atm->time[ip], atm->lat[ip], atm->p[ip]));
-    }
+  /* Gather data... */
+  MPI_Gatherv(atm->time, atm->np, MPI_DOUBLE, atm_all->time, counts, displs,
+	      MPI_DOUBLE, 0, MPI_COMM_WORLD);
+  MPI_Gatherv(atm->p, atm->np, MPI_DOUBLE, atm_all->p, counts, displs,
+	      MPI_DOUBLE, 0, MPI_COMM_WORLD);
+  MPI_Gatherv(atm->lon, atm->np, MPI_DOUBLE, atm_all->lon, counts, displs,
+	      MPI_DOUBLE, 0, MPI_COMM_WORLD);
+  MPI_Gatherv(atm->lat, atm->np, MPI_DOUBLE, atm_all->lat, counts, displs,
+	      MPI_DOUBLE, 0, MPI_COMM_WORLD);
+  for (int iq = 0; iq < ctl->nq; iq++)
+    MPI_Gatherv(atm->q[iq], atm->np, MPI_DOUBLE, atm_all->q[iq], counts,
+		displs, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+
+  /* Free... */
+  free(counts);
+  free(displs);
 }
+#endif
 
 /*****************************************************************************/
 
-void module_wet_deposition(
+void write_output(
+  const char *dirname,
   ctl_t * ctl,
   met_t * met0,
   met_t * met1,
   atm_t * atm,
-  double *dt) {
+  double t) {
 
-  /* Check quantity flags... */
-  if (ctl->qnt_m < 0)
-    ERRMSG("Module needs quantity mass!");
+  /* Check for output... */
+  if (!((ctl->atm_basename[0] != '-' && fmod(t, ctl->atm_dt_out) == 0)
+	|| (ctl->grid_basename[0] != '-' && fmod(t, ctl->grid_dt_out) == 0)
+	|| ctl->csi_basename[0] != '-' || ctl->ens_basename[0] != '-'
+	|| ctl->prof_basename[0] != '-' || ctl->stat_basename[0] != '-'))
+    return;
 
+  /* Update host (other output is reduced on the device)... */
 #ifdef _OPENACC
-#pragma acc data present(ctl,atm,dt)
-#pragma acc parallel loop independent gang vector
-#else
-#pragma omp parallel for default(shared)
+  if (ctl->atm_basename[0] != '-' && fmod(t, ctl->atm_dt_out) == 0) {
+    double tacc = omp_get_wtime();
+#pragma acc update host(atm[:1])
+    counter(COUNTER_D2H_BYTES, (double) sizeof(atm_t));
+    counter(COUNTER_D2H_TIME, omp_get_wtime() - tacc);
+  }
 #endif
-  for (int ip = 0; ip < atm->np; ip++)
-    if (dt[ip] != 0) {
-
-      double H, Is, Si, T, cl, lambda, iwc, lwc, pc, cw[3];
-
-      int inside, ci[3];
-
-      /* Check whether particle is below cloud top... */
-      intpol_met_time_2d(met0, met0->pc, met1, met1->pc, atm->time[ip],
-			 atm->lon[ip], atm->lat[ip], &pc, ci, cw, 1);
-      if (!check_finite(pc) || atm->p[ip] <= pc)
-	continue;
 
-      /* Check whether particle is inside or below cloud... */
-      intpol_met_time_3d(met0, met0->lwc, met1, met1->lwc, atm->time[ip],
-			 atm->p[ip], atm->lon[ip], atm->lat[ip], &lwc, ci, cw,
-			 1);
-      intpol_met_time_3d(met0, met0->iwc, met1, met1->iwc, atm->time[ip],
-			 atm->p[ip], atm->lon[ip], atm->lat[ip], &iwc, ci, cw,
-			 0);
-      inside = (iwc > 0 || lwc > 0);
-
-      /* Estimate precipitation rate (Pisso et al., 2019)... */
-      intpol_met_time_2d(met0, met0->cl, met1, met1->cl, atm->time[ip],
-			 atm->lon[ip], atm->lat[ip], &cl, ci, cw, 0);
-      Is = pow(2. * cl, 1. / 0.36);
-      if (Is < 0.01)
-	continue;
-
-      /* Calculate in-cloud scavenging for gases... */
-      if (inside) {
-
-	/* Get temperature... */
-	intpol_met_time_3d(met0, met0->t, met1, met1->t, atm->time[ip],
-			   atm->p[ip], atm->lon[ip], atm->lat[ip], &T, ci, cw,
-			   0);
-
-	/* Get Henry's constant (Sander, 2015)... */
-	H = ctl->wet_depo[2] * 101.325
-	  * exp(ctl->wet_depo[3] * (1. / T - 1. / 298.15));
-
-	/* Get scavenging coefficient (Hertel et al., 1995)... */
-	Si = 1. / ((1. - cl) / (H * RI / P0 * T) + cl);
-	lambda = 6.2 * Si * Is / 3.6e6;
-      }
-
-      /* Calculate below-cloud scavenging for gases (Pisso et al., 2019)... */
-      else
-	lambda = ctl->wet_depo[0] * pow(Is, ctl->wet_depo[1]);
-
-      /* Calculate exponential decay... */
-      atm->q[ctl->qnt_m][ip] *= exp(-dt[ip] * lambda);
-    }
+  /* Write output files... */
+  write_output_files(dirname, ctl, met0, met1, atm, t);
 }
 
 /*****************************************************************************/
 
-void write_output(
+void write_output_files(
   const char *dirname,
   ctl_t * ctl,
   met_t * met0,
@@ -1325,81 +972,60 @@ void write_output(
 
   double r;
 
-  int year, mon, day, hour, min, sec, updated = 0;
+  int year, mon, day, hour, min, sec;
 
   /* Get time... */
   jsec2time(t, &year, &mon, &day, &hour, &min, &sec, &r);
 
   /* Write atmospheric data... */
   if (ctl->atm_basename[0] != '-' && fmod(t, ctl->atm_dt_out) == 0) {
-    if (!updated) {
-#ifdef _OPENACC
-#pragma acc update host(atm[:1])
-#endif
-      updated = 1;
-    }
     sprintf(filename, "%s/%s_%04d_%02d_%02d_%02d_%02d.tab",
 	    dirname, ctl->atm_basename, year, mon, day, hour, min);
-    write_atm(filename, ctl, atm, t);
+#ifdef MPI
+    /* Gather air parcels of all MPI tasks on master... */
+    if (ctl->mpi_decomp) {
+      atm_t *atm_all;
+      int rank;
+      ALLOC(atm_all, atm_t, 1);
+      MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+      mpi_gather_atm(ctl, atm, atm_all);
+      if (rank == 0)
+	write_async_atm(filename, ctl, atm_all, t);
+      free_atm(atm_all);
+      free(atm_all);
+    } else
+#endif
+      write_async_atm(filename, ctl, atm, t);
   }
 
   /* Write gridded data... */
   if (ctl->grid_basename[0] != '-' && fmod(t, ctl->grid_dt_out) == 0) {
-    if (!updated) {
-#ifdef _OPENACC
-#pragma acc update host(atm[:1])
-#endif
-      updated = 1;
-    }
-    sprintf(filename, "%s/%s_%04d_%02d_%02d_%02d_%02d.tab",
-	    dirname, ctl->grid_basename, year, mon, day, hour, min);
+    sprintf(filename, "%s/%s_%04d_%02d_%02d_%02d_%02d.%s",
+	    dirname, ctl->grid_basename, year, mon, day, hour, min,
+	    ctl->grid_type == 1 ? "nc" : "tab");
     write_grid(filename, ctl, met0, met1, atm, t);
   }
 
   /* Write CSI data... */
   if (ctl->csi_basename[0] != '-') {
-    if (!updated) {
-#ifdef _OPENACC
-#pragma acc update host(atm[:1])
-#endif
-      updated = 1;
-    }
     sprintf(filename, "%s/%s.tab", dirname, ctl->csi_basename);
     write_csi(filename, ctl, atm, t);
   }
 
   /* Write ensemble data... */
   if (ctl->ens_basename[0] != '-') {
-    if (!updated) {
-#ifdef _OPENACC
-#pragma acc update host(atm[:1])
-#endif
-      updated = 1;
-    }
     sprintf(filename, "%s/%s.tab", dirname, ctl->ens_basename);
     write_ens(filename, ctl, atm, t);
   }
 
   /* Write profile data... */
   if (ctl->prof_basename[0] != '-') {
-    if (!updated) {
-#ifdef _OPENACC
-#pragma acc update host(atm[:1])
-#endif
-      updated = 1;
-    }
     sprintf(filename, "%s/%s.tab", dirname, ctl->prof_basename);
     write_prof(filename, ctl, met0, met1, atm, t);
   }
 
   /* Write station data... */
   if (ctl->stat_basename[0] != '-') {
-    if (!updated) {
-#ifdef _OPENACC
-#pragma acc update host(atm[:1])
-#endif
-      updated = 1;
-    }
     sprintf(filename, "%s/%s.tab", dirname, ctl->stat_basename);
     write_station(filename, ctl, atm, t);
   }
@@ -327,6 +327,7 @@ int main(
   NC(nc_close(ncid));
 
   /* Free... */
+  free_met(met);
   free(met);
 
   return EXIT_SUCCESS;
@@ -259,6 +259,7 @@ int main(
   NC(nc_close(ncid));
 
   /* Free... */
+  free_atm(atm);
   free(atm);
 
   return EXIT_SUCCESS;